@@ -4,6 +4,8 @@
 #include "sqg_concepts.h"
 #include "sqg_traits.h"
 #include "sqg_struct.h"
+#include "sqg_simd.h"
+#include "sqg_wide.h"
 
 // vector
 #include "sqg_vec2.h"
@@ -22,5 +24,19 @@
 #include "sqg_mat.h"
 #include "sqg_mat_view.h"
 #include "sqg_mat_vec.h"
+#include "sqg_quat_mat.h"
+#include "sqg_mat34.h"
+#include "sqg_dualquat.h"
 
-#include "sqg_coordinates.h"
\ No newline at end of file
+#include "sqg_coordinates.h"
+
+// batch
+#include "sqg_dispatch.h"
+#include "sqg_soa.h"
+#include "sqg_block.h"
+#include "sqg_strided.h"
+#include "sqg_span.h"
+#include "sqg_batch.h"
+
+// sqg_parallel.h, sqg_hierarchy.h and sqg_skin.h start threads, include them on their own
+// and link the squiggle_parallel target
@@ -0,0 +1,616 @@
+#pragma once
+#include "sqg_block.h"
+#include "sqg_concepts.h"
+#include "sqg_dispatch.h"
+#include "sqg_dualquat.h"
+#include "sqg_mat33.h"
+#include "sqg_mat44.h"
+#include "sqg_mat34.h"
+#include "sqg_mat_vec.h"
+#include "sqg_quat.h"
+#include "sqg_quat_mat.h"
+#include "sqg_soa.h"
+#include "sqg_vec.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+// Batch versions of the per element functions over spans, soa and block containers. Arrays of plain float and
+// double vectors and quaternions and the containers go through the runtime dispatched kernels in sqg_dispatch.h,
+// everything else loops over the per element function.
+
+namespace sqg::detail
+{
+    // Arrays of these are plain float or double arrays of n_dims components each,
+    // so they can be handed straight to the dispatch kernels
+    template<typename V>
+    concept packed_vec = ( std::same_as<vec_scalar<V>,float> || std::same_as<vec_scalar<V>,double> ) && (
+        std::same_as<V, vec3<vec_scalar<V>>> ||
+        std::same_as<V, vec4<vec_scalar<V>>> ||
+        std::same_as<V, quat<vec_scalar<V>>> ||
+        ( concepts::simd_vec_type<V> && vec_traits<V>::n_dims == 4 )
+    ) && sizeof(V) == vec_traits<V>::n_dims * sizeof(vec_scalar<V>);
+
+    template<typename M>
+    concept vec3_transform = concepts::read_mat33_type<M> || concepts::read_affine_type<M> || concepts::read_quat_type<M> || concepts::read_dualquat_type<M>;
+
+    // scalar of a matrix, quaternion or dual quaternion transform and the size of its matrix
+    template<typename M>
+    struct transform_traits
+    {
+        using scalar_type = mat_scalar<M>;
+        static constexpr int n_dims = mat_traits<M>::n_dims;
+    };
+
+    template<concepts::read_quat_type M>
+    struct transform_traits<M>
+    {
+        using scalar_type = vec_scalar<M>;
+        static constexpr int n_dims = 3;
+    };
+
+    // 3x4 matrices are expanded into a 4x4 matrix
+    template<concepts::read_mat34_type M>
+    struct transform_traits<M>
+    {
+        using scalar_type = mat34_scalar<M>;
+        static constexpr int n_dims = 4;
+    };
+
+    // Dual quaternions are expanded into their 4x4 rigid transform
+    template<concepts::read_dualquat_type M>
+    struct transform_traits<M>
+    {
+        using scalar_type = dualquat_scalar<M>;
+        static constexpr int n_dims = 4;
+    };
+
+    template<typename M>
+    using transform_scalar = transform_traits<M>::scalar_type;
+
+    // Copies the transform into a squiggle matrix with scalar S, S is a wide to broadcast it across lanes.
+    // Quaternions are expanded once into their rotation matrix.
+    template<typename S, vec3_transform M>
+    SQUIGGLE_INLINE constexpr auto transform_value( const M& transform )
+    {
+        constexpr int n = transform_traits<M>::n_dims;
+        using value = std::conditional_t<n == 3, mat33<transform_scalar<M>>, mat44<transform_scalar<M>>>;
+        value copy;
+        assign(copy, transform);
+
+        std::conditional_t<n == 3, mat33<S>, mat44<S>> m;
+        for ( int row = 0; row < n; row++ )
+        {
+            for ( int col = 0; col < n; col++ )
+                m.a[row][col] = S(copy.a[row][col]);
+        }
+        return m;
+    }
+
+    // A point or direction through one transform value, 3x3 matrices have no translation so both are the same
+    template<bool point, typename M, concepts::read_vec3_type V>
+    SQUIGGLE_INLINE constexpr vec_value<V> transform_one( const M& transform, const V& vector )
+    {
+        if constexpr ( concepts::read_affine_type<M> && point )
+            return transform_point(transform, vector);
+        else if constexpr ( concepts::read_affine_type<M> )
+            return transform_dir(transform, vector);
+        else
+            return transform * vector;
+    }
+
+    // The transform as the top three rows of an affine matrix
+    template<bool point, vec3_transform M>
+    SQUIGGLE_INLINE constexpr mat44<transform_scalar<M>> affine_rows( const M& transform )
+    {
+        const auto t = transform_value<transform_scalar<M>>(transform);
+        constexpr int n = mat_traits<std::remove_cvref_t<decltype(t)>>::n_dims;
+
+        mat44<transform_scalar<M>> m;
+        for ( int row = 0; row < 3; row++ )
+        {
+            for ( int col = 0; col < 3; col++ )
+                m.a[row][col] = t.a[row][col];
+            if constexpr ( n == 4 && point )
+                m.a[row][3] = t.a[row][3];
+        }
+        return m;
+    }
+
+    template<bool point, vec3_transform M, concepts::vec3_type V>
+    SQUIGGLE_INLINE void transform_span( std::span<const V> in, const M& transform, std::span<V> out )
+    {
+        static_assert( std::same_as<transform_scalar<M>,vec_scalar<V>>, "Scalar type must match for this operation" );
+        assert(out.size() >= in.size());
+
+        using scalar = vec_scalar<V>;
+        if constexpr ( packed_vec<V> )
+        {
+            const scalar* src = reinterpret_cast<const scalar*>(in.data());
+            scalar* dst = reinterpret_cast<scalar*>(out.data());
+            const mat44<scalar> m = affine_rows<point>(transform);
+            if constexpr ( point && transform_traits<M>::n_dims == 4 )
+                dispatch::transform_points(src, dst, in.size(), &m.a[0][0]);
+            else
+                dispatch::transform_dirs(src, dst, in.size(), &m.a[0][0]);
+        }
+        else
+        {
+            const auto t = transform_value<scalar>(transform);
+            for ( std::size_t i = 0; i < in.size(); i++ )
+                out[i] = transform_one<point>(t, in[i]);
+        }
+    }
+
+    // float and double arrays of 2, 3 or 4 components, the layout the sum kernels read
+    template<typename V>
+    concept packed_components = packed_vec<V> || (
+        ( std::same_as<vec_scalar<V>,float> || std::same_as<vec_scalar<V>,double> ) &&
+        std::same_as<V, vec2<vec_scalar<V>>> && sizeof(V) == 2 * sizeof(vec_scalar<V>)
+    );
+
+    // float and double quaternions stored w,x,y,z, the layout the compose kernels read
+    template<typename Q>
+    concept packed_quat = ( std::same_as<vec_scalar<Q>,float> || std::same_as<vec_scalar<Q>,double> ) &&
+        ( std::same_as<Q, quat<vec_scalar<Q>>> || std::same_as<Q, quata<vec_scalar<Q>>> ) && sizeof(Q) == 4 * sizeof(vec_scalar<Q>);
+
+    // float and double row major matrices with no padding, the layout the rotation kernels read
+    template<typename M>
+    concept packed_mat = ( std::same_as<mat_scalar<M>,float> || std::same_as<mat_scalar<M>,double> ) &&
+        ( std::same_as<M, mat33<mat_scalar<M>>> || std::same_as<M, mat44<mat_scalar<M>>> || std::same_as<M, mat44a<mat_scalar<M>>> ) &&
+        sizeof(M) == mat_traits<M>::n_dims * mat_traits<M>::n_dims * sizeof(mat_scalar<M>);
+
+    // float and double dual quaternions of two packed w,x,y,z quaternions, the layout the dual quaternion kernels read
+    template<typename D>
+    concept packed_dualquat = ( std::same_as<dualquat_scalar<D>,float> || std::same_as<dualquat_scalar<D>,double> ) &&
+        std::same_as<D, dualquat<dualquat_scalar<D>>> && sizeof(D) == 8 * sizeof(dualquat_scalar<D>);
+
+    // float and double row major 3x4 and 4x4 matrices with no padding, the layout the dual quaternion kernels write
+    template<typename M>
+    concept packed_affine = ( std::same_as<mat34<typename affine_traits<M>::scalar_type>, M> ||
+        std::same_as<mat44<typename affine_traits<M>::scalar_type>, M> ) &&
+        ( std::same_as<typename affine_traits<M>::scalar_type,float> || std::same_as<typename affine_traits<M>::scalar_type,double> ) &&
+        sizeof(M) == ( concepts::mat34_type<M> ? 12 : 16 ) * sizeof(typename affine_traits<M>::scalar_type);
+
+    template<typename M>
+    concept rotation_mat = concepts::mat33_type<M> || concepts::mat44_type<M>;
+
+    template<typename M>
+    concept read_rotation_mat = concepts::read_mat33_type<M> || concepts::read_mat44_type<M>;
+
+    // w, x, y and z arrays of a quaternion soa
+    template<typename C>
+    SQUIGGLE_INLINE auto quat_components( C& quaternions )
+    {
+        using pointer = decltype(quaternions.w().data());
+        return std::array<pointer,4>{ quaternions.w().data(), quaternions.x().data(), quaternions.y().data(), quaternions.z().data() };
+    }
+
+    // First scalar of a quaternion block container, blocks are W w lanes then W x, y and z lanes
+    template<typename B>
+    SQUIGGLE_INLINE auto block_data( B& quaternions )
+    {
+        static_assert( sizeof(typename B::wide_type) == 4 * B::width * sizeof(typename B::scalar_type), "Blocks must be packed" );
+        return quaternions.empty() ? nullptr : &quaternions.blocks()[0].w.lane[0];
+    }
+
+    template<bool point, vec3_transform M, typename T>
+    SQUIGGLE_INLINE void transform_soa( const vec3_soa<T>& in, const M& transform, vec3_soa<T>& out )
+    {
+        static_assert( std::same_as<transform_scalar<M>,T>, "Scalar type must match for this operation" );
+        assert(out.size() >= in.size());
+
+        if constexpr ( std::same_as<T,float> || std::same_as<T,double> )
+        {
+            const mat44<T> m = affine_rows<point>(transform);
+            dispatch::transform_soa(in.x().data(), in.y().data(), in.z().data(), out.x().data(), out.y().data(), out.z().data(), in.size(), &m.a[0][0]);
+        }
+        else
+        {
+            const auto t = transform_value<T>(transform);
+            for ( std::size_t i = 0; i < in.size(); i++ )
+                out[i] = transform_one<point>(t, in[i]);
+        }
+    }
+}
+
+namespace sqg
+{
+    // out[i] = transform_point(matrix, points[i]) for mat44, mat34 and dual quaternions, matrix * points[i] for mat33
+    // and quaternion * points[i] for quaternions. out must be at least as long as points and may be the same span.
+    // Quaternions and dual quaternions are expanded into a matrix once, which is cheaper for more than a couple of vectors.
+    template<detail::vec3_transform M, concepts::vec3_type V>
+    SQUIGGLE_INLINE void transform_points( std::span<const V> points, const M& transform, std::span<V> out )
+    {
+        detail::transform_span<true>(points, transform, out);
+    }
+
+    // As transform_points but the translation of mat44, mat34 and dual quaternions is ignored
+    template<detail::vec3_transform M, concepts::vec3_type V>
+    SQUIGGLE_INLINE void transform_dirs( std::span<const V> directions, const M& transform, std::span<V> out )
+    {
+        detail::transform_span<false>(directions, transform, out);
+    }
+
+    template<detail::vec3_transform M, typename T>
+    SQUIGGLE_INLINE void transform_points( const vec3_soa<T>& points, const M& transform, vec3_soa<T>& out )
+    {
+        detail::transform_soa<true>(points, transform, out);
+    }
+
+    template<detail::vec3_transform M, typename T>
+    SQUIGGLE_INLINE void transform_dirs( const vec3_soa<T>& directions, const M& transform, vec3_soa<T>& out )
+    {
+        detail::transform_soa<false>(directions, transform, out);
+    }
+
+    // Summation order of the batch reductions
+    enum class reduction
+    {
+        deterministic,  // a running sum in element order, the same on every dispatch level and build
+        fast            // reassociated into partial sums per SIMD lane, the rounding depends on the dispatch level
+    };
+
+    // normalize(vector) for every vector, zero length vectors are not allowed
+    template<concepts::vec_type V>
+    SQUIGGLE_INLINE void normalize_all( std::span<V> vectors )
+    {
+        if constexpr ( detail::packed_vec<V> && vec_traits<V>::n_dims == 3 )
+        {
+            using scalar = vec_scalar<V>;
+            scalar* data = reinterpret_cast<scalar*>(vectors.data());
+            dispatch::normalize(data, data, vectors.size());
+        }
+        else
+        {
+            for ( V& v : vectors )
+                normalize(v);
+        }
+    }
+
+    // normalize_fast(vector) for every vector, three and four component arrays of float or double run through the dispatch kernels
+    template<int refinements = 1, concepts::vec_type T>
+    SQUIGGLE_INLINE void normalize_fast( std::span<T> vectors )
+    {
+        if constexpr ( detail::packed_vec<T> )
+        {
+            using scalar = vec_scalar<T>;
+            scalar* data = reinterpret_cast<scalar*>(vectors.data());
+            if constexpr ( vec_traits<T>::n_dims == 3 )
+                dispatch::normalize_fast<refinements>(data, data, vectors.size());
+            else
+                dispatch::normalize4_fast<refinements>(data, data, vectors.size());
+        }
+        else
+        {
+            for ( T& v : vectors )
+                normalize_fast<refinements>(v);
+        }
+    }
+
+    // out[i] = mag2(vectors[i]), out must be at least as long as vectors
+    template<concepts::vec_type V>
+    SQUIGGLE_INLINE void mag2_all( std::span<const V> vectors, std::span<vec_scalar<V>> out )
+    {
+        assert(out.size() >= vectors.size());
+        if constexpr ( detail::packed_vec<V> && vec_traits<V>::n_dims == 3 )
+        {
+            dispatch::mag2(reinterpret_cast<const vec_scalar<V>*>(vectors.data()), out.data(), vectors.size());
+        }
+        else
+        {
+            for ( std::size_t i = 0; i < vectors.size(); i++ )
+                out[i] = mag2(vectors[i]);
+        }
+    }
+
+    // out[i] = mag(vectors[i]), out must be at least as long as vectors
+    template<concepts::vec_type V>
+    SQUIGGLE_INLINE void mag_all( std::span<const V> vectors, std::span<vec_scalar<V>> out )
+    {
+        assert(out.size() >= vectors.size());
+        if constexpr ( detail::packed_vec<V> && vec_traits<V>::n_dims == 3 )
+        {
+            dispatch::mag(reinterpret_cast<const vec_scalar<V>*>(vectors.data()), out.data(), vectors.size());
+        }
+        else
+        {
+            for ( std::size_t i = 0; i < vectors.size(); i++ )
+                out[i] = mag(vectors[i]);
+        }
+    }
+
+    // out[i] = dot(a[i], b[i]), a and b must be the same length and out at least as long
+    template<concepts::vec_type V>
+    SQUIGGLE_INLINE void dot_all( std::span<const V> a, std::span<const V> b, std::span<vec_scalar<V>> out )
+    {
+        assert(a.size() == b.size() && out.size() >= a.size());
+        if constexpr ( detail::packed_vec<V> && vec_traits<V>::n_dims == 3 )
+        {
+            using scalar = vec_scalar<V>;
+            dispatch::dot(reinterpret_cast<const scalar*>(a.data()), reinterpret_cast<const scalar*>(b.data()), out.data(), a.size());
+        }
+        else
+        {
+            for ( std::size_t i = 0; i < a.size(); i++ )
+                out[i] = dot(a[i], b[i]);
+        }
+    }
+
+    // Sum of every vector, zero for an empty span. Only fast reassociates, and only for
+    // float and double arrays the dispatch kernels can read.
+    template<reduction mode = reduction::deterministic, concepts::vec_type V>
+    [[nodiscard]] SQUIGGLE_INLINE vec_value<V> sum( std::span<const V> vectors )
+    {
+        vec_value<V> total;
+        if constexpr ( mode == reduction::fast && detail::packed_components<V> )
+        {
+            constexpr int n = vec_traits<V>::n_dims;
+            using scalar = vec_scalar<V>;
+
+            dispatch::sum<n>(reinterpret_cast<const scalar*>(vectors.data()), vectors.size(), reinterpret_cast<scalar*>(&total));
+        }
+        else
+        {
+            set_zero(total);
+            for ( const V& v : vectors )
+                total += v;
+        }
+        return total;
+    }
+
+    // Mean of the vectors, which must not be empty
+    template<reduction mode = reduction::deterministic, concepts::vec_type V>
+    [[nodiscard]] SQUIGGLE_INLINE vec_value<V> centroid( std::span<const V> vectors )
+    {
+        assert(!vectors.empty());
+        return sum<mode>(vectors) / static_cast<vec_scalar<V>>(vectors.size());
+    }
+
+    // out[i] = a[i] * b[i], a and b must be the same length and out at least as long. out may be a or b.
+    template<concepts::quat_type Q>
+    SQUIGGLE_INLINE void compose_all( std::span<const Q> a, std::span<const Q> b, std::span<Q> out )
+    {
+        assert(a.size() == b.size() && out.size() >= a.size());
+        if constexpr ( detail::packed_quat<Q> )
+        {
+            using scalar = vec_scalar<Q>;
+            dispatch::compose(reinterpret_cast<const scalar*>(a.data()), reinterpret_cast<const scalar*>(b.data()), reinterpret_cast<scalar*>(out.data()), a.size());
+        }
+        else
+        {
+            for ( std::size_t i = 0; i < a.size(); i++ )
+                out[i] = a[i] * b[i];
+        }
+    }
+
+    // quaternions[i] = quaternion * quaternions[i], applying the same rotation after each of them
+    template<concepts::read_quat_type R, concepts::quat_type Q>
+    SQUIGGLE_INLINE void premultiply_all( const R& quaternion, std::span<Q> quaternions )
+    {
+        static_assert( std::same_as<vec_scalar<R>,vec_scalar<Q>>, "Scalar type must match for this operation" );
+        if constexpr ( detail::packed_quat<Q> )
+        {
+            using scalar = vec_scalar<Q>;
+            const scalar q[4] = { W(quaternion), X(quaternion), Y(quaternion), Z(quaternion) };
+            scalar* data = reinterpret_cast<scalar*>(quaternions.data());
+            dispatch::premultiply(q, data, data, quaternions.size());
+        }
+        else
+        {
+            const quat<vec_scalar<Q>> q = quaternion;
+            for ( Q& r : quaternions )
+                r = q * r;
+        }
+    }
+
+    template<typename T>
+    SQUIGGLE_INLINE void compose_all( const quat_soa<T>& a, const quat_soa<T>& b, quat_soa<T>& out )
+    {
+        assert(a.size() == b.size() && out.size() >= a.size());
+        if constexpr ( std::same_as<T,float> || std::same_as<T,double> )
+        {
+            const auto pa = detail::quat_components(a);
+            const auto pb = detail::quat_components(b);
+            const auto po = detail::quat_components(out);
+            dispatch::compose_soa(pa.data(), pb.data(), po.data(), a.size());
+        }
+        else
+        {
+            for ( std::size_t i = 0; i < a.size(); i++ )
+                out[i] = a[i] * b[i];
+        }
+    }
+
+    template<concepts::read_quat_type R, typename T>
+    SQUIGGLE_INLINE void premultiply_all( const R& quaternion, quat_soa<T>& quaternions )
+    {
+        static_assert( std::same_as<vec_scalar<R>,T>, "Scalar type must match for this operation" );
+        if constexpr ( std::same_as<T,float> || std::same_as<T,double> )
+        {
+            const T q[4] = { W(quaternion), X(quaternion), Y(quaternion), Z(quaternion) };
+            const auto p = detail::quat_components(quaternions);
+            const std::array<const T*,4> in{ p[0], p[1], p[2], p[3] };
+            dispatch::premultiply_soa(q, in.data(), p.data(), quaternions.size());
+        }
+        else
+        {
+            const quat<T> q = quaternion;
+            for ( auto r : quaternions )
+                r = q * r;
+        }
+    }
+
+    template<typename T, int W>
+    SQUIGGLE_INLINE void compose_all( const quat_block<T,W>& a, const quat_block<T,W>& b, quat_block<T,W>& out )
+    {
+        assert(a.size() == b.size() && out.size() >= a.size());
+        if constexpr ( std::same_as<T,float> || std::same_as<T,double> )
+        {
+            if ( !a.empty() )
+                dispatch::compose_blocks(detail::block_data(a), detail::block_data(b), detail::block_data(out), a.size(), W);
+        }
+        else
+        {
+            for ( std::size_t i = 0; i < a.size(); i++ )
+                out[i] = a[i] * b[i];
+        }
+    }
+
+    template<concepts::read_quat_type R, typename T, int W>
+    SQUIGGLE_INLINE void premultiply_all( const R& quaternion, quat_block<T,W>& quaternions )
+    {
+        static_assert( std::same_as<vec_scalar<R>,T>, "Scalar type must match for this operation" );
+        if constexpr ( std::same_as<T,float> || std::same_as<T,double> )
+        {
+            const T q[4] = { sqg::W(quaternion), X(quaternion), Y(quaternion), Z(quaternion) };
+            if ( !quaternions.empty() )
+                dispatch::premultiply_blocks(q, detail::block_data(quaternions), detail::block_data(quaternions), quaternions.size(), W);
+        }
+        else
+        {
+            const quat<T> q = quaternion;
+            for ( auto r : quaternions )
+                r = q * r;
+        }
+    }
+
+    // Rotation matrix of every quaternion, quaternions are expected to be normalised.
+    // 4x4 matrices only have their orientation written, their translation and last row are kept.
+    template<concepts::read_quat_type Q, detail::rotation_mat M>
+    SQUIGGLE_INLINE void convert_all( std::span<const Q> quaternions, std::span<M> matrices )
+    {
+        static_assert( std::same_as<vec_scalar<Q>,mat_scalar<M>>, "Scalar type must match for this operation" );
+        assert(matrices.size() >= quaternions.size());
+
+        if constexpr ( detail::packed_quat<Q> && detail::packed_mat<M> )
+        {
+            using scalar = vec_scalar<Q>;
+            dispatch::quat_to_mat<mat_traits<M>::n_dims>(reinterpret_cast<const scalar*>(quaternions.data()), reinterpret_cast<scalar*>(matrices.data()), quaternions.size());
+        }
+        else
+        {
+            for ( std::size_t i = 0; i < quaternions.size(); i++ )
+            {
+                if constexpr ( concepts::mat44_type<M> )
+                    assign(orientation(matrices[i]), quaternions[i]);
+                else
+                    assign(matrices[i], quaternions[i]);
+            }
+        }
+    }
+
+    // Quaternion of every rotation matrix, or of the orientation of every 4x4 matrix, see assign in sqg_quat_mat.h
+    template<detail::read_rotation_mat M, concepts::quat_type Q>
+    SQUIGGLE_INLINE void convert_all( std::span<const M> matrices, std::span<Q> quaternions )
+    {
+        static_assert( std::same_as<vec_scalar<Q>,mat_scalar<M>>, "Scalar type must match for this operation" );
+        assert(quaternions.size() >= matrices.size());
+
+        if constexpr ( detail::packed_quat<Q> && detail::packed_mat<M> )
+        {
+            using scalar = vec_scalar<Q>;
+            dispatch::mat_to_quat<mat_traits<M>::n_dims>(reinterpret_cast<const scalar*>(matrices.data()), reinterpret_cast<scalar*>(quaternions.data()), matrices.size());
+        }
+        else
+        {
+            for ( std::size_t i = 0; i < matrices.size(); i++ )
+            {
+                if constexpr ( concepts::read_mat44_type<M> )
+                    assign(quaternions[i], orientation(matrices[i]));
+                else
+                    assign(quaternions[i], matrices[i]);
+            }
+        }
+    }
+
+    // vector = quaternion * vector for every vector, the quaternion is expanded into a rotation matrix
+    // once rather than per vector. quaternion is expected to be normalised.
+    template<concepts::read_quat_type Q, concepts::vec3_type V>
+    SQUIGGLE_INLINE void rotate_many( const Q& quaternion, std::span<V> vectors )
+    {
+        detail::transform_span<false>(std::span<const V>{ vectors }, quaternion, vectors);
+    }
+
+    template<concepts::read_quat_type Q, typename T>
+    SQUIGGLE_INLINE void rotate_many( const Q& quaternion, vec3_soa<T>& vectors )
+    {
+        detail::transform_soa<false>(vectors, quaternion, vectors);
+    }
+
+    // out[i] = a[i] * b[i], a and b must be the same length and out at least as long. out may be a or b.
+    template<concepts::dualquat_type D>
+    SQUIGGLE_INLINE void compose_all( std::span<const D> a, std::span<const D> b, std::span<D> out )
+    {
+        assert(a.size() == b.size() && out.size() >= a.size());
+        if constexpr ( detail::packed_dualquat<D> )
+        {
+            using scalar = dualquat_scalar<D>;
+            dispatch::compose_dualquats(reinterpret_cast<const scalar*>(a.data()), reinterpret_cast<const scalar*>(b.data()), reinterpret_cast<scalar*>(out.data()), a.size());
+        }
+        else
+        {
+            for ( std::size_t i = 0; i < a.size(); i++ )
+                out[i] = a[i] * b[i];
+        }
+    }
+
+    // normalize(dq) for every dual quaternion, see normalize in sqg_dualquat.h
+    template<concepts::dualquat_type D>
+    SQUIGGLE_INLINE void normalize_all( std::span<D> dualquats )
+    {
+        if constexpr ( detail::packed_dualquat<D> )
+        {
+            using scalar = dualquat_scalar<D>;
+            scalar* data = reinterpret_cast<scalar*>(dualquats.data());
+            dispatch::normalize_dualquats(data, data, dualquats.size());
+        }
+        else
+        {
+            for ( D& dq : dualquats )
+                normalize(dq);
+        }
+    }
+
+    // out[i] = dlb(a[i], b[i], t), a and b must be the same length and out at least as long. out may be a or b.
+    template<concepts::dualquat_type D>
+    SQUIGGLE_INLINE void dlb_all( std::span<const D> a, std::span<const D> b, dualquat_scalar<D> t, std::span<D> out )
+    {
+        assert(a.size() == b.size() && out.size() >= a.size());
+        if constexpr ( detail::packed_dualquat<D> )
+        {
+            using scalar = dualquat_scalar<D>;
+            dispatch::blend_dualquats(reinterpret_cast<const scalar*>(a.data()), reinterpret_cast<const scalar*>(b.data()), t, reinterpret_cast<scalar*>(out.data()), a.size());
+        }
+        else
+        {
+            for ( std::size_t i = 0; i < a.size(); i++ )
+                out[i] = dlb(a[i], b[i], t);
+        }
+    }
+
+    // Rigid transform matrix of every dual quaternion, dual quaternions are expected to be normalised.
+    // Every element is written, including the 0 0 0 1 last row of a 4x4.
+    template<concepts::read_dualquat_type D, concepts::affine_type M>
+    SQUIGGLE_INLINE void convert_all( std::span<const D> dualquats, std::span<M> matrices )
+    {
+        static_assert( std::same_as<dualquat_scalar<D>, typename detail::affine_traits<M>::scalar_type>, "Scalar type must match for this operation" );
+        assert(matrices.size() >= dualquats.size());
+
+        if constexpr ( detail::packed_dualquat<D> && detail::packed_affine<M> )
+        {
+            using scalar = dualquat_scalar<D>;
+            constexpr int rows = concepts::mat34_type<M> ? 3 : 4;
+            dispatch::dualquat_to_mat<rows>(reinterpret_cast<const scalar*>(dualquats.data()), reinterpret_cast<scalar*>(matrices.data()), dualquats.size());
+        }
+        else
+        {
+            for ( std::size_t i = 0; i < dualquats.size(); i++ )
+                assign(matrices[i], dualquats[i]);
+        }
+    }
+}
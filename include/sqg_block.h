@@ -0,0 +1,133 @@
+#pragma once
+#include "sqg_concepts.h"
+#include "sqg_soa.h"
+#include "sqg_struct.h"
+#include "sqg_traits.h"
+#include "sqg_wide.h"
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace sqg::detail
+{
+    // component I of a vector of wide scalars in X, Y, Z, W order
+    template<int I, typename B>
+    SQUIGGLE_INLINE constexpr auto& block_component( B& b )
+    {
+        if constexpr ( I == 0 )
+            return b.x;
+        else if constexpr ( I == 1 )
+            return b.y;
+        else if constexpr ( I == 2 )
+            return b.z;
+        else
+            return b.w;
+    }
+}
+
+namespace sqg
+{
+    // Array of structures of arrays, elements are held in blocks of W with each component of a block
+    // contiguous, so 8 x then 8 y then 8 z for block<vec3<float>,8>. Every component of an element is
+    // in the same block which keeps random access to one element on one or two cache lines, while
+    // whole blocks are vectors of wide scalars for SIMD code. Elements are reached through soa_view
+    // like soa and satisfy the same vec/quat concepts as V.
+    template<typename V, int W = 8>
+    class block
+    {
+    public:
+        using value_type = V;
+        using scalar_type = vec_scalar<V>;
+        using size_type = std::size_t;
+        using reference = soa_view<block>;
+        using const_reference = read_soa_view<block>;
+        using iterator = soa_iterator<block, reference>;
+        using const_iterator = soa_iterator<const block, const_reference>;
+
+        static constexpr int n_dims = vec_traits<V>::n_dims;
+        static constexpr int width = W;
+        static_assert( n_dims == 3 || n_dims == 4, "block holds 3 or 4 dimension vectors" );
+
+        // One block, W elements as one vector of wide scalars
+        using wide_type = detail::rebind_scalar<V, wide<scalar_type,W>>::type;
+
+        block() = default;
+        explicit block( size_type count ) { resize(count); }
+
+        [[nodiscard]] SQUIGGLE_INLINE size_type size() const { return size_; }
+        [[nodiscard]] SQUIGGLE_INLINE bool empty() const { return size_ == 0; }
+        [[nodiscard]] SQUIGGLE_INLINE size_type block_count() const { return blocks_.size(); }
+
+        // new elements are default initialised V, zero for vectors and identity for quaternions.
+        // Lanes of the last block past size() are kept default initialised so kernels can run whole blocks.
+        void resize( size_type count )
+        {
+            const V init{};
+            wide_type fill;
+            X(fill, wide<scalar_type,W>{ X(init) });
+            Y(fill, wide<scalar_type,W>{ Y(init) });
+            Z(fill, wide<scalar_type,W>{ Z(init) });
+            if constexpr ( n_dims == 4 )
+                sqg::W(fill, wide<scalar_type,W>{ sqg::W(init) });
+
+            blocks_.resize(( count + W - 1 ) / W, fill);
+            const size_type end = std::min(size_, blocks_.size() * W);
+            for ( size_type i = count; i < end; i++ )
+                (*this)[i] = init;
+            size_ = count;
+        }
+
+        void reserve( size_type count ) { blocks_.reserve(( count + W - 1 ) / W); }
+
+        void clear()
+        {
+            blocks_.clear();
+            size_ = 0;
+        }
+
+        template<concepts::vec_type R>
+        void push_back( const R& vector )
+        {
+            static_assert( vec_traits<R>::n_dims == n_dims, "Number of dimensions must match" );
+            if ( size_ == blocks_.size() * W )
+                resize(size_ + 1);
+            else
+                size_++;
+            (*this)[size_ - 1] = vector;
+        }
+
+        [[nodiscard]] SQUIGGLE_INLINE reference operator[]( size_type i ) { return { *this, i }; }
+        [[nodiscard]] SQUIGGLE_INLINE const_reference operator[]( size_type i ) const { return { *this, i }; }
+
+        [[nodiscard]] SQUIGGLE_INLINE iterator begin() { return { *this, 0 }; }
+        [[nodiscard]] SQUIGGLE_INLINE iterator end() { return { *this, size() }; }
+        [[nodiscard]] SQUIGGLE_INLINE const_iterator begin() const { return { *this, 0 }; }
+        [[nodiscard]] SQUIGGLE_INLINE const_iterator end() const { return { *this, size() }; }
+
+        // component I of element i in X, Y, Z, W order, the element views read and write through this
+        template<int I>
+        [[nodiscard]] SQUIGGLE_INLINE scalar_type& component( size_type i )
+        {
+            return detail::block_component<I>(blocks_[i / W]).lane[i % W];
+        }
+
+        template<int I>
+        [[nodiscard]] SQUIGGLE_INLINE scalar_type component( size_type i ) const
+        {
+            return detail::block_component<I>(blocks_[i / W]).lane[i % W];
+        }
+
+        // Every block as a vector of wide scalars, block_count() long. Element i is lane i % W of block i / W.
+        [[nodiscard]] SQUIGGLE_INLINE std::span<wide_type> blocks() { return blocks_; }
+        [[nodiscard]] SQUIGGLE_INLINE std::span<const wide_type> blocks() const { return blocks_; }
+
+    private:
+        std::vector<wide_type> blocks_;
+        size_type size_ = 0;
+    };
+
+    template<typename T, int W = 8> using vec3_block = block<vec3<T>,W>;
+    template<typename T, int W = 8> using vec4_block = block<vec4<T>,W>;
+    template<typename T, int W = 8> using quat_block = block<quat<T>,W>;
+}
@@ -26,6 +26,18 @@ namespace sqg
     template<typename T>
     struct mat_traits;
 
+    // 3x4 affine matrices, the top three rows of a 4x4 matrix whose last row is 0 0 0 1
+    template<typename T>
+    struct mat34_traits;
+
+    // Dual quaternions, a real and a dual quaternion part
+    template<typename T>
+    struct dualquat_traits;
+
+    // Maths the library needs from a scalar type, see sqg_scalar.h
+    template<typename T>
+    struct scalar_traits;
+
     // Determines what value gets selected, default to left argument
     template<typename M1, typename M2>
     struct deduce_mat_traits
@@ -346,18 +358,47 @@ namespace sqg::concepts
         requires vec4_read<T>;
     };
 
+    // Any scalar with a square root and trig functions through scalar_traits, floating point by default
+    // but also wide simd scalars where every lane is a separate value.
+    template<typename T>
+    concept real_scalar = requires(const T s) {
+        { scalar_traits<T>::sqrt(s) } -> std::convertible_to<T>;
+        { scalar_traits<T>::sin(s) } -> std::convertible_to<T>;
+        { scalar_traits<T>::cos(s) } -> std::convertible_to<T>;
+    };
+
     template<typename T>
     concept quat_type = requires() {
         requires vec4_type<T>;
-        requires std::floating_point<typename vec_traits<T>::scalar_type>;
+        requires real_scalar<typename vec_traits<T>::scalar_type>;
     };
 
     template<typename T>
     concept read_quat_type = requires() {
         requires read_vec4_type<T>;
-        requires std::floating_point<typename vec_traits<T>::scalar_type>;
+        requires real_scalar<typename vec_traits<T>::scalar_type>;
+    };
+
+    // Vectors stored as four contiguous scalar lanes which can be moved straight into a simd register.
+    // simd_w_lane is the lane holding W, 3 for x,y,z,w storage and 0 for w,x,y,z storage.
+    // Padded 3 dimension vectors report their padding lane, which must stay zero.
+    // These are written as conjunctions so the simd overloads are more constrained than the generic ones.
+    template<typename T>
+    concept simd_vec_type = vec_type<T> && requires(const T cv, typename vec_traits<T>::type v) {
+        { vec_traits<T>::data(cv) } -> std::same_as<const typename vec_traits<T>::scalar_type*>;
+        { vec_traits<typename vec_traits<T>::type>::data(v) } -> std::same_as<typename vec_traits<T>::scalar_type*>;
+        { vec_traits<T>::simd_w_lane } -> std::convertible_to<int>;
     };
 
+    template<typename T>
+    concept simd_vec3_type = read_vec3_type<T> && simd_vec_type<T>;
+
+    template<typename T>
+    concept simd_vec4_type = read_vec4_type<T> && simd_vec_type<T>;
+
+    template<typename T>
+    concept simd_quat_type = read_quat_type<T> && simd_vec_type<T>;
+
     template<typename T>
     concept mat44_type = requires() {
         requires mat_type_n<T,4>;
@@ -370,6 +411,111 @@ namespace sqg::concepts
         requires mat_type_n<T,4>;
         requires mat44_read<T>;
     };
+
+    // 4x4 matrices of native floating point stored as sixteen contiguous row major scalars
+    template<typename T>
+    concept simd_mat44_type = read_mat44_type<T> && std::floating_point<typename mat_traits<T>::scalar_type> && requires(const T cm, typename mat_traits<T>::type m) {
+        { mat_traits<T>::data(cm) } -> std::same_as<const typename mat_traits<T>::scalar_type*>;
+        { mat_traits<typename mat_traits<T>::type>::data(m) } -> std::same_as<typename mat_traits<T>::scalar_type*>;
+    };
+
+    // 3x4 affine matrices, rows 0 to 2 of mat34_traits. Elements are written through references.
+    template<typename T>
+    concept mat34_base = requires() {
+        { typename mat34_traits<T>::type{} };
+        { typename mat34_traits<T>::scalar_type{} };
+    };
+
+    template<typename T, int row, int col>
+    concept mat34_read_element = requires( T cm ) {
+        { mat34_traits<std::remove_const_t<T>>::template A<row,col>(cm) } -> std::convertible_to<typename mat34_traits<std::remove_const_t<T>>::scalar_type>;
+    };
+
+    template<typename T, int row, int col>
+    concept mat34_write_element = requires( T m ) {
+        { mat34_traits<T>::template A<row,col>(m) } -> std::same_as<typename mat34_traits<T>::scalar_type&>;
+    };
+
+    template<typename T>
+    concept mat34_read = requires() {
+        requires mat34_read_element<const T, 0,0>;
+        requires mat34_read_element<const T, 0,1>;
+        requires mat34_read_element<const T, 0,2>;
+        requires mat34_read_element<const T, 0,3>;
+
+        requires mat34_read_element<const T, 1,0>;
+        requires mat34_read_element<const T, 1,1>;
+        requires mat34_read_element<const T, 1,2>;
+        requires mat34_read_element<const T, 1,3>;
+
+        requires mat34_read_element<const T, 2,0>;
+        requires mat34_read_element<const T, 2,1>;
+        requires mat34_read_element<const T, 2,2>;
+        requires mat34_read_element<const T, 2,3>;
+    };
+
+    template<typename T>
+    concept mat34_write = requires() {
+        requires mat34_write_element<T, 0,0>;
+        requires mat34_write_element<T, 0,1>;
+        requires mat34_write_element<T, 0,2>;
+        requires mat34_write_element<T, 0,3>;
+
+        requires mat34_write_element<T, 1,0>;
+        requires mat34_write_element<T, 1,1>;
+        requires mat34_write_element<T, 1,2>;
+        requires mat34_write_element<T, 1,3>;
+
+        requires mat34_write_element<T, 2,0>;
+        requires mat34_write_element<T, 2,1>;
+        requires mat34_write_element<T, 2,2>;
+        requires mat34_write_element<T, 2,3>;
+    };
+
+    template<typename T>
+    concept mat34_type = requires() {
+        requires mat34_base<T>;
+        requires mat34_read<T>;
+        requires mat34_write<T>;
+    };
+
+    template<typename T>
+    concept read_mat34_type = requires() {
+        requires mat34_base<T>;
+        requires mat34_read<T>;
+    };
+
+    // 3x4 matrices with contiguous row major storage, each row is one simd::pack4
+    template<typename T>
+    concept simd_mat34_type = read_mat34_type<T> && std::floating_point<typename mat34_traits<T>::scalar_type> && requires(const T cm, typename mat34_traits<T>::type m) {
+        { mat34_traits<T>::data(cm) } -> std::same_as<const typename mat34_traits<T>::scalar_type*>;
+        { mat34_traits<typename mat34_traits<T>::type>::data(m) } -> std::same_as<typename mat34_traits<T>::scalar_type*>;
+    };
+
+    // Dual quaternions real + eps dual, the two parts are quaternions returned by dualquat_traits
+    template<typename T>
+    concept read_dualquat_type = requires( const T cdq ) {
+        { typename dualquat_traits<T>::type{} };
+        { typename dualquat_traits<T>::scalar_type{} };
+        requires read_quat_type<std::remove_cvref_t<decltype(dualquat_traits<T>::real(cdq))>>;
+        requires read_quat_type<std::remove_cvref_t<decltype(dualquat_traits<T>::dual(cdq))>>;
+    };
+
+    // Parts written through references
+    template<typename T>
+    concept dualquat_type = read_dualquat_type<T> && requires( T dq ) {
+        requires std::is_lvalue_reference_v<decltype(dualquat_traits<T>::real(dq))>;
+        requires std::is_lvalue_reference_v<decltype(dualquat_traits<T>::dual(dq))>;
+        requires quat_type<std::remove_cvref_t<decltype(dualquat_traits<T>::real(dq))>>;
+        requires quat_type<std::remove_cvref_t<decltype(dualquat_traits<T>::dual(dq))>>;
+    };
+
+    // Matrices with an orientation and a position, see orientation_view and position_view
+    template<typename T>
+    concept affine_type = mat44_type<T> || mat34_type<T>;
+
+    template<typename T>
+    concept read_affine_type = read_mat44_type<T> || read_mat34_type<T>;
 }
 
 namespace sqg
@@ -397,4 +543,16 @@ namespace sqg
 
     template<concepts::mat_type M1, concepts::mat_type M2>
     using mat_scalar2 = deduce_mat_traits<M1,M2>::traits::scalar_type;
+
+    template<concepts::read_mat34_type T>
+    using mat34_value = mat34_traits<T>::type;
+
+    template<concepts::read_mat34_type T>
+    using mat34_scalar = mat34_traits<T>::scalar_type;
+
+    template<concepts::read_dualquat_type T>
+    using dualquat_value = dualquat_traits<T>::type;
+
+    template<concepts::read_dualquat_type T>
+    using dualquat_scalar = dualquat_traits<T>::scalar_type;
 }
\ No newline at end of file
@@ -68,9 +68,9 @@ namespace sqg::coordinates
     struct SystemQuat
     {
         // This is the same as the SystemMat but for quaternions instead - otherwise the maths is equivalent.
-        // Calculated from sqg::convert_to<sqg::quatd>( basis matrix ) of the matricies above (since constexpr convert_to for quat to mat doesn't exist)
-        static constexpr sqg::quat<T> NUE_TO_NED = {T{0.70710678118654746}, T{-0.70710678118654746}, T{0.0}, T{0.0}};
-        static constexpr sqg::quat<T> NUE_TO_NWU = {T{0.70710678118654746}, T{ 0.70710678118654746}, T{0.0}, T{0.0}};
+        // Calculated from the basis matrices above at compile time
+        static constexpr sqg::quat<T> NUE_TO_NED = sqg::convert_to<sqg::quat<T>>( SystemMat<T>::NUE_TO_NED );
+        static constexpr sqg::quat<T> NUE_TO_NWU = sqg::convert_to<sqg::quat<T>>( SystemMat<T>::NUE_TO_NWU );
 
         static constexpr sqg::quat<T> NED_TO_NUE = sqg::inverse( NUE_TO_NED );
         static constexpr sqg::quat<T> NWU_TO_NUE = sqg::inverse( NUE_TO_NWU );
@@ -0,0 +1,810 @@
+#pragma once
+#include "sqg_concepts.h"
+#include "sqg_scalar.h"
+#include "sqg_simd.h"
+#include <atomic>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#if defined(SQUIGGLE_SSE2) && defined(_MSC_VER) && !defined(__clang__)
+#   include <intrin.h>
+#endif
+
+// Batch kernels compiled for several instruction set levels in the same binary, the best level the
+// cpu supports is picked once at runtime. The rest of the library follows the compile flags of the
+// consumer, these kernels let a conservative baseline build still use AVX2/AVX-512 where available.
+//
+// Each level is a copy of sqg_dispatch_kernels.h compiled with a different target attribute.
+
+#if defined(__GNUC__) || defined(__clang__)
+#   define SQUIGGLE_TARGET(isa) __attribute__((target(isa)))
+#else
+#   define SQUIGGLE_TARGET(isa)
+#endif
+
+#define SQUIGGLE_TARGET_SSE41 SQUIGGLE_TARGET("sse4.1")
+#define SQUIGGLE_TARGET_AVX2 SQUIGGLE_TARGET("avx2,fma")
+#define SQUIGGLE_TARGET_AVX512 SQUIGGLE_TARGET("avx512f,avx2,fma")
+
+namespace sqg::dispatch
+{
+    enum class level : int
+    {
+        scalar = 0,
+        sse41,
+        avx2,
+        avx512,
+    };
+
+    [[nodiscard]] inline constexpr const char* level_name( level l )
+    {
+        switch ( l )
+        {
+        case level::scalar: return "scalar";
+        case level::sse41: return "sse4.1";
+        case level::avx2: return "avx2";
+        case level::avx512: return "avx512";
+        }
+        return "unknown";
+    }
+}
+
+namespace sqg::dispatch::detail
+{
+    // Interleaved x,y,z data loaded into three registers of width lanes.
+    // Lane i of register r holds component (width * r + i) % 3 of point (width * r + i) / 3.
+    constexpr int aos_register( int width, int component, int lane )
+    {
+        for ( int r = 0; r < 3; r++ )
+        {
+            if ( ( width * r + lane ) % 3 == component )
+                return r;
+        }
+        return -1;
+    }
+
+    constexpr int aos_point( int width, int component, int lane )
+    {
+        return ( width * aos_register(width, component, lane) + lane ) / 3;
+    }
+
+    // lanes of register r which hold this component
+    constexpr int aos_mask( int width, int component, int r )
+    {
+        int mask = 0;
+        for ( int i = 0; i < width; i++ )
+        {
+            if ( aos_register(width, component, i) == r )
+                mask |= 1 << i;
+        }
+        return mask;
+    }
+
+    // lane holding point of this component once the three registers are blended together
+    constexpr int aos_lane( int width, int component, int point )
+    {
+        for ( int i = 0; i < width; i++ )
+        {
+            if ( aos_point(width, component, i) == point )
+                return i;
+        }
+        return -1;
+    }
+
+    static_assert( aos_mask(4, 0, 0) == 0b1001 && aos_mask(4, 0, 1) == 0b0100 && aos_mask(4, 0, 2) == 0b0010 );
+    static_assert( aos_lane(8, 0, 1) == 3 && aos_lane(8, 1, 5) == 0 && aos_lane(8, 2, 0) == 2 );
+
+    // The same for elements of n interleaved scalars, width elements loaded into n registers.
+    // Component c of element p is in lane (n * p + c) % width of register (n * p + c) / width.
+    constexpr int strided_register( int width, int n, int component, int element )
+    {
+        return ( n * element + component ) / width;
+    }
+
+    // lanes, in element order, whose component comes from register r
+    constexpr int strided_mask( int width, int n, int component, int r )
+    {
+        int mask = 0;
+        for ( int p = 0; p < width; p++ )
+        {
+            if ( strided_register(width, n, component, p) == r )
+                mask |= 1 << p;
+        }
+        return mask;
+    }
+
+    // lane of register r to move into lane element, any lane when r doesn't hold it
+    constexpr int strided_source( int width, int n, int component, int r, int element )
+    {
+        return strided_register(width, n, component, element) == r ? ( n * element + component ) % width : 0;
+    }
+
+    // lanes of stored register r which hold this component
+    constexpr int scatter_mask( int width, int n, int component, int r )
+    {
+        int mask = 0;
+        for ( int i = 0; i < width; i++ )
+        {
+            if ( ( width * r + i ) % n == component )
+                mask |= 1 << i;
+        }
+        return mask;
+    }
+
+    // element whose component goes to lane i of stored register r
+    constexpr int scatter_source( int width, int n, int component, int r, int i )
+    {
+        return ( width * r + i ) % n == component ? ( width * r + i ) / n : 0;
+    }
+
+    // When n and width share no factor, as for x,y,z, no two registers hold the same component in the
+    // same lane. Registers can then be blended before a single permute instead of permuted one by one.
+    constexpr bool strided_disjoint( int width, int n )
+    {
+        for ( int component = 0; component < n; component++ )
+        {
+            for ( int i = 0; i < width; i++ )
+            {
+                int registers = 0;
+                for ( int r = 0; r < n; r++ )
+                    registers += ( width * r + i ) % n == component;
+                if ( registers > 1 )
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // element whose component is in lane i of whichever register holds it there, when disjoint
+    constexpr int scatter_element( int width, int n, int component, int i )
+    {
+        for ( int r = 0; r < n; r++ )
+        {
+            if ( ( width * r + i ) % n == component )
+                return ( width * r + i ) / n;
+        }
+        return 0;
+    }
+
+    // Row major 4x4 products split into 16 / width registers, lane i of register q is element q * width + i.
+    // Each lane of the product sums a[row][k] * b[k][col], and for every k both terms of a register's lanes
+    // come from one register of a and one of b, so each is a single permute.
+    constexpr int product_left_element( int width, int q, int k, int i )
+    {
+        return ( q * width + i ) / 4 * 4 + k;
+    }
+
+    constexpr int product_right_element( int width, int q, int k, int i )
+    {
+        return k * 4 + ( q * width + i ) % 4;
+    }
+
+    static_assert( product_left_element(4, 2, 1, 3) == 9 && product_right_element(4, 2, 1, 3) == 7 );
+    static_assert( product_left_element(2, 3, 0, 1) / 2 == product_left_element(2, 3, 0, 0) / 2 && product_right_element(16, 0, 3, 13) == 13 );
+
+    static_assert( strided_disjoint(8, 9) && strided_disjoint(4, 3) && !strided_disjoint(4, 4) && !strided_disjoint(16, 16) );
+    static_assert( strided_mask(4, 4, 1, 2) == 0b0100 && strided_source(4, 4, 1, 2, 2) == 1 && strided_mask(8, 9, 0, 1) == 0b10 );
+    static_assert( scatter_mask(4, 9, 4, 1) == 0b0001 && scatter_source(4, 9, 4, 1, 0) == 0 && scatter_source(16, 9, 0, 1, 2) == 2 );
+}
+
+// ========== Lanes ========== //
+// Each level wraps its registers in lanes<T>, blend takes lane i from b when bit i of mask is set
+// and permute sets lane i to lane idx# of a. select_ge takes lane i from x where a >= b and from y
+// otherwise. rsqrt is the hardware estimate, at least 12 bits and evaluated in single precision for
+// double before AVX-512. Lanes with has_gather also have load_index, which reads width 32 bit indices
+// times scale, and gather, which sets lane i to p[lane i of the index].
+
+namespace sqg::dispatch::scalar
+{
+    template<typename T>
+    struct lanes
+    {
+        using reg = T;
+        static constexpr int width = 1;
+        static constexpr bool has_gather = false;
+
+        static SQUIGGLE_INLINE reg load( const T* p ) { return *p; }
+        static SQUIGGLE_INLINE void store( T* p, reg a ) { *p = a; }
+        static SQUIGGLE_INLINE reg set1( T s ) { return s; }
+
+        static SQUIGGLE_INLINE reg add( reg a, reg b ) { return a + b; }
+        static SQUIGGLE_INLINE reg sub( reg a, reg b ) { return a - b; }
+        static SQUIGGLE_INLINE reg mul( reg a, reg b ) { return a * b; }
+        static SQUIGGLE_INLINE reg div( reg a, reg b ) { return a / b; }
+        static SQUIGGLE_INLINE reg sqrt( reg a ) { return std::sqrt(a); }
+        static SQUIGGLE_INLINE reg rsqrt( reg a ) { return scalar_traits<T>::rsqrt_estimate(a); }
+        static SQUIGGLE_INLINE reg fmadd( reg a, reg b, reg c ) { return a * b + c; }
+        static SQUIGGLE_INLINE reg max( reg a, reg b ) { return a < b ? b : a; }
+        static SQUIGGLE_INLINE reg select_ge( reg a, reg b, reg x, reg y ) { return a >= b ? x : y; }
+
+        template<int mask> static SQUIGGLE_INLINE reg blend( reg a, reg b ) { return ( mask & 1 ) ? b : a; }
+        template<int i0> static SQUIGGLE_INLINE reg permute( reg a ) { return a; }
+    };
+}
+
+#if defined(SQUIGGLE_SSE2)
+
+namespace sqg::dispatch::sse41
+{
+    template<typename T>
+    struct lanes;
+
+    template<>
+    struct lanes<float>
+    {
+        using reg = __m128;
+        static constexpr int width = 4;
+        static constexpr bool has_gather = false;
+
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg load( const float* p ) { return _mm_loadu_ps(p); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE void store( float* p, reg a ) { _mm_storeu_ps(p, a); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg set1( float s ) { return _mm_set1_ps(s); }
+
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg add( reg a, reg b ) { return _mm_add_ps(a, b); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg sub( reg a, reg b ) { return _mm_sub_ps(a, b); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg mul( reg a, reg b ) { return _mm_mul_ps(a, b); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg div( reg a, reg b ) { return _mm_div_ps(a, b); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg sqrt( reg a ) { return _mm_sqrt_ps(a); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg rsqrt( reg a ) { return _mm_rsqrt_ps(a); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg fmadd( reg a, reg b, reg c ) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg max( reg a, reg b ) { return _mm_max_ps(a, b); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg select_ge( reg a, reg b, reg x, reg y ) { return _mm_blendv_ps(y, x, _mm_cmpge_ps(a, b)); }
+
+        template<int mask> static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg blend( reg a, reg b ) { return _mm_blend_ps(a, b, mask); }
+
+        template<int i0, int i1, int i2, int i3>
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg permute( reg a ) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(i3,i2,i1,i0)); }
+    };
+
+    template<>
+    struct lanes<double>
+    {
+        using reg = __m128d;
+        static constexpr int width = 2;
+        static constexpr bool has_gather = false;
+
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg load( const double* p ) { return _mm_loadu_pd(p); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE void store( double* p, reg a ) { _mm_storeu_pd(p, a); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg set1( double s ) { return _mm_set1_pd(s); }
+
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg add( reg a, reg b ) { return _mm_add_pd(a, b); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg sub( reg a, reg b ) { return _mm_sub_pd(a, b); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg mul( reg a, reg b ) { return _mm_mul_pd(a, b); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg div( reg a, reg b ) { return _mm_div_pd(a, b); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg sqrt( reg a ) { return _mm_sqrt_pd(a); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg rsqrt( reg a ) { return _mm_cvtps_pd(_mm_rsqrt_ps(_mm_cvtpd_ps(a))); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg fmadd( reg a, reg b, reg c ) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg max( reg a, reg b ) { return _mm_max_pd(a, b); }
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg select_ge( reg a, reg b, reg x, reg y ) { return _mm_blendv_pd(y, x, _mm_cmpge_pd(a, b)); }
+
+        template<int mask> static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg blend( reg a, reg b ) { return _mm_blend_pd(a, b, mask); }
+
+        template<int i0, int i1>
+        static SQUIGGLE_TARGET_SSE41 SQUIGGLE_INLINE reg permute( reg a ) { return _mm_shuffle_pd(a, a, i0 | ( i1 << 1 )); }
+    };
+}
+
+namespace sqg::dispatch::avx2
+{
+    template<typename T>
+    struct lanes;
+
+    template<>
+    struct lanes<float>
+    {
+        using reg = __m256;
+        using index = __m256i;
+        static constexpr int width = 8;
+        static constexpr bool has_gather = true;
+
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg load( const float* p ) { return _mm256_loadu_ps(p); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE void store( float* p, reg a ) { _mm256_storeu_ps(p, a); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg set1( float s ) { return _mm256_set1_ps(s); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE index load_index( const std::uint32_t* p, int scale ) { return _mm256_mullo_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), _mm256_set1_epi32(scale)); }
+        // masked with every lane set for the reason given in the AVX-512 lanes
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg gather( const float* p, index i ) { return _mm256_mask_i32gather_ps(_mm256_setzero_ps(), p, i, _mm256_castsi256_ps(_mm256_set1_epi32(-1)), 4); }
+
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg add( reg a, reg b ) { return _mm256_add_ps(a, b); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg sub( reg a, reg b ) { return _mm256_sub_ps(a, b); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg mul( reg a, reg b ) { return _mm256_mul_ps(a, b); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg div( reg a, reg b ) { return _mm256_div_ps(a, b); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg sqrt( reg a ) { return _mm256_sqrt_ps(a); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg rsqrt( reg a ) { return _mm256_rsqrt_ps(a); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg fmadd( reg a, reg b, reg c ) { return _mm256_fmadd_ps(a, b, c); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg max( reg a, reg b ) { return _mm256_max_ps(a, b); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg select_ge( reg a, reg b, reg x, reg y ) { return _mm256_blendv_ps(y, x, _mm256_cmp_ps(a, b, _CMP_GE_OQ)); }
+
+        template<int mask> static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg blend( reg a, reg b ) { return _mm256_blend_ps(a, b, mask); }
+
+        template<int... idx>
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg permute( reg a ) { return _mm256_permutevar8x32_ps(a, _mm256_setr_epi32(idx...)); }
+    };
+
+    template<>
+    struct lanes<double>
+    {
+        using reg = __m256d;
+        using index = __m128i;
+        static constexpr int width = 4;
+        static constexpr bool has_gather = true;
+
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg load( const double* p ) { return _mm256_loadu_pd(p); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE void store( double* p, reg a ) { _mm256_storeu_pd(p, a); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg set1( double s ) { return _mm256_set1_pd(s); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE index load_index( const std::uint32_t* p, int scale ) { return _mm_mullo_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), _mm_set1_epi32(scale)); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg gather( const double* p, index i ) { return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), p, i, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8); }
+
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg add( reg a, reg b ) { return _mm256_add_pd(a, b); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg sub( reg a, reg b ) { return _mm256_sub_pd(a, b); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg mul( reg a, reg b ) { return _mm256_mul_pd(a, b); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg div( reg a, reg b ) { return _mm256_div_pd(a, b); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg sqrt( reg a ) { return _mm256_sqrt_pd(a); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg rsqrt( reg a ) { return _mm256_cvtps_pd(_mm_rsqrt_ps(_mm256_cvtpd_ps(a))); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg fmadd( reg a, reg b, reg c ) { return _mm256_fmadd_pd(a, b, c); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg max( reg a, reg b ) { return _mm256_max_pd(a, b); }
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg select_ge( reg a, reg b, reg x, reg y ) { return _mm256_blendv_pd(y, x, _mm256_cmp_pd(a, b, _CMP_GE_OQ)); }
+
+        template<int mask> static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg blend( reg a, reg b ) { return _mm256_blend_pd(a, b, mask); }
+
+        template<int i0, int i1, int i2, int i3>
+        static SQUIGGLE_TARGET_AVX2 SQUIGGLE_INLINE reg permute( reg a ) { return _mm256_permute4x64_pd(a, _MM_SHUFFLE(i3,i2,i1,i0)); }
+    };
+}
+
+namespace sqg::dispatch::avx512
+{
+    template<typename T>
+    struct lanes;
+
+    template<>
+    struct lanes<float>
+    {
+        using reg = __m512;
+        using index = __m512i;
+        static constexpr int width = 16;
+        static constexpr bool has_gather = true;
+        // The masked forms of gather, permutexvar, sqrt, rsqrt14 and max with every lane set are the same instructions,
+        // the unmasked ones pass _mm512_undefined_ps as the source and GCC 12 warns it may be uninitialized
+        static constexpr __mmask16 all = 0xFFFF;
+
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg load( const float* p ) { return _mm512_loadu_ps(p); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE void store( float* p, reg a ) { _mm512_storeu_ps(p, a); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg set1( float s ) { return _mm512_set1_ps(s); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE index load_index( const std::uint32_t* p, int scale ) { return _mm512_mullo_epi32(_mm512_loadu_si512(p), _mm512_set1_epi32(scale)); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg gather( const float* p, index i ) { return _mm512_mask_i32gather_ps(_mm512_setzero_ps(), all, i, p, 4); }
+
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg add( reg a, reg b ) { return _mm512_add_ps(a, b); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg sub( reg a, reg b ) { return _mm512_sub_ps(a, b); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg mul( reg a, reg b ) { return _mm512_mul_ps(a, b); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg div( reg a, reg b ) { return _mm512_div_ps(a, b); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg sqrt( reg a ) { return _mm512_mask_sqrt_ps(a, all, a); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg rsqrt( reg a ) { return _mm512_mask_rsqrt14_ps(a, all, a); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg fmadd( reg a, reg b, reg c ) { return _mm512_fmadd_ps(a, b, c); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg max( reg a, reg b ) { return _mm512_mask_max_ps(a, all, a, b); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg select_ge( reg a, reg b, reg x, reg y ) { return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_GE_OQ), y, x); }
+
+        template<int mask> static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg blend( reg a, reg b ) { return _mm512_mask_blend_ps(static_cast<__mmask16>(mask), a, b); }
+
+        template<int... idx>
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg permute( reg a )
+        {
+            // _mm512_setr_epi32 is a macro on some compilers and can't take a pack
+            alignas(64) static constexpr int index[] = { idx... };
+            return _mm512_mask_permutexvar_ps(a, all, _mm512_load_si512(index), a);
+        }
+    };
+
+    template<>
+    struct lanes<double>
+    {
+        using reg = __m512d;
+        using index = __m256i;
+        static constexpr int width = 8;
+        static constexpr bool has_gather = true;
+        static constexpr __mmask8 all = 0xFF;
+
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg load( const double* p ) { return _mm512_loadu_pd(p); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE void store( double* p, reg a ) { _mm512_storeu_pd(p, a); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg set1( double s ) { return _mm512_set1_pd(s); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE index load_index( const std::uint32_t* p, int scale ) { return _mm256_mullo_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), _mm256_set1_epi32(scale)); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg gather( const double* p, index i ) { return _mm512_mask_i32gather_pd(_mm512_setzero_pd(), all, i, p, 8); }
+
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg add( reg a, reg b ) { return _mm512_add_pd(a, b); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg sub( reg a, reg b ) { return _mm512_sub_pd(a, b); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg mul( reg a, reg b ) { return _mm512_mul_pd(a, b); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg div( reg a, reg b ) { return _mm512_div_pd(a, b); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg sqrt( reg a ) { return _mm512_mask_sqrt_pd(a, all, a); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg rsqrt( reg a ) { return _mm512_mask_rsqrt14_pd(a, all, a); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg fmadd( reg a, reg b, reg c ) { return _mm512_fmadd_pd(a, b, c); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg max( reg a, reg b ) { return _mm512_mask_max_pd(a, all, a, b); }
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg select_ge( reg a, reg b, reg x, reg y ) { return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a, b, _CMP_GE_OQ), y, x); }
+
+        template<int mask> static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg blend( reg a, reg b ) { return _mm512_mask_blend_pd(static_cast<__mmask8>(mask), a, b); }
+
+        template<int... idx>
+        static SQUIGGLE_TARGET_AVX512 SQUIGGLE_INLINE reg permute( reg a )
+        {
+            alignas(64) static constexpr long long index[] = { idx... };
+            return _mm512_mask_permutexvar_pd(a, all, _mm512_load_si512(index), a);
+        }
+    };
+}
+
+#endif // SQUIGGLE_SSE2
+
+// ========== Kernels ========== //
+
+namespace sqg::dispatch
+{
+    // Refinements are the number of Newton steps after the rsqrt estimate, see math::rsqrt_fast
+    inline constexpr int max_refinements = 3;
+
+    template<std::floating_point T>
+    struct kernel_table
+    {
+        void (*transform_points)( const T* points, T* out, std::size_t count, const T* matrix );
+        void (*transform_dirs)( const T* directions, T* out, std::size_t count, const T* matrix );
+        void (*transform_soa)( const T* x, const T* y, const T* z, T* out_x, T* out_y, T* out_z, std::size_t count, const T* matrix );
+        void (*normalize)( const T* vectors, T* out, std::size_t count );
+        void (*mag2)( const T* vectors, T* out, std::size_t count );
+        void (*mag)( const T* vectors, T* out, std::size_t count );
+        void (*dot)( const T* a, const T* b, T* out, std::size_t count );
+        void (*sum[3])( const T* vectors, std::size_t count, T* out );
+        void (*compose)( const T* a, const T* b, T* out, std::size_t count );
+        void (*premultiply)( const T* quaternion, const T* b, T* out, std::size_t count );
+        void (*compose_soa)( const T* const* a, const T* const* b, T* const* out, std::size_t count );
+        void (*premultiply_soa)( const T* quaternion, const T* const* b, T* const* out, std::size_t count );
+        void (*compose_blocks)( const T* a, const T* b, T* out, std::size_t count, std::size_t block_width );
+        void (*premultiply_blocks)( const T* quaternion, const T* b, T* out, std::size_t count, std::size_t block_width );
+        void (*quat_to_mat[2])( const T* quaternions, T* matrices, std::size_t count );
+        void (*mat_to_quat[2])( const T* matrices, T* quaternions, std::size_t count );
+        void (*multiply_parents)( T* world, const T* local, const std::uint32_t* parents, const std::uint32_t* nodes, std::size_t count );
+        void (*normalize_fast[max_refinements + 1])( const T* vectors, T* out, std::size_t count );
+        void (*normalize4_fast[max_refinements + 1])( const T* vectors, T* out, std::size_t count );
+        void (*compose_dualquats)( const T* a, const T* b, T* out, std::size_t count );
+        void (*normalize_dualquats)( const T* dualquats, T* out, std::size_t count );
+        void (*blend_dualquats)( const T* a, const T* b, T t, T* out, std::size_t count );
+        void (*dualquat_to_mat[2])( const T* dualquats, T* matrices, std::size_t count );
+        void (*skin_vertices[2])( const T* bones, const std::uint32_t* indices, const T* weights, std::size_t influences, std::size_t stride,
+                                  const T* const* in, T* const* out, std::size_t count );
+    };
+}
+
+#define SQUIGGLE_KERNEL_NAMESPACE scalar
+#define SQUIGGLE_KERNEL_TARGET
+#include "sqg_dispatch_kernels.h"
+#undef SQUIGGLE_KERNEL_NAMESPACE
+#undef SQUIGGLE_KERNEL_TARGET
+
+#if defined(SQUIGGLE_SSE2)
+
+#define SQUIGGLE_KERNEL_NAMESPACE sse41
+#define SQUIGGLE_KERNEL_TARGET SQUIGGLE_TARGET_SSE41
+#include "sqg_dispatch_kernels.h"
+#undef SQUIGGLE_KERNEL_NAMESPACE
+#undef SQUIGGLE_KERNEL_TARGET
+
+#define SQUIGGLE_KERNEL_NAMESPACE avx2
+#define SQUIGGLE_KERNEL_TARGET SQUIGGLE_TARGET_AVX2
+#include "sqg_dispatch_kernels.h"
+#undef SQUIGGLE_KERNEL_NAMESPACE
+#undef SQUIGGLE_KERNEL_TARGET
+
+#define SQUIGGLE_KERNEL_NAMESPACE avx512
+#define SQUIGGLE_KERNEL_TARGET SQUIGGLE_TARGET_AVX512
+#include "sqg_dispatch_kernels.h"
+#undef SQUIGGLE_KERNEL_NAMESPACE
+#undef SQUIGGLE_KERNEL_TARGET
+
+#endif // SQUIGGLE_SSE2
+
+// ========== Dispatch ========== //
+
+namespace sqg::dispatch
+{
+    namespace detail
+    {
+        [[nodiscard]] inline level detect_level()
+        {
+#if defined(SQUIGGLE_SSE2)
+#   if defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 0);
+            const int max_leaf = info[0];
+
+            __cpuid(info, 1);
+            const bool sse41 = info[2] & ( 1 << 19 );
+            const bool fma = info[2] & ( 1 << 12 );
+            const bool osxsave = info[2] & ( 1 << 27 );
+
+            // the os must save the ymm/zmm state on context switches as well
+            const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+            const bool ymm = ( xcr0 & 0x6 ) == 0x6;
+            const bool zmm = ( xcr0 & 0xe6 ) == 0xe6;
+
+            bool avx2 = false;
+            bool avx512 = false;
+            if ( max_leaf >= 7 )
+            {
+                __cpuidex(info, 7, 0);
+                avx2 = info[1] & ( 1 << 5 );
+                avx512 = info[1] & ( 1 << 16 );
+            }
+
+            if ( avx512 && avx2 && fma && zmm ) return level::avx512;
+            if ( avx2 && fma && ymm ) return level::avx2;
+            if ( sse41 ) return level::sse41;
+#   else
+            // these also check the os has enabled the register state
+            __builtin_cpu_init();
+            if ( __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ) return level::avx512;
+            if ( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ) return level::avx2;
+            if ( __builtin_cpu_supports("sse4.1") ) return level::sse41;
+#   endif
+#endif
+            return level::scalar;
+        }
+
+        inline constexpr int no_forced_level = -1;
+        inline std::atomic<int> forced_level{ no_forced_level };
+    }
+
+    // Best level this cpu supports, detected once
+    [[nodiscard]] inline level detected_level()
+    {
+        static const level detected = detail::detect_level();
+        return detected;
+    }
+
+    // Level the batch kernels currently run at
+    [[nodiscard]] inline level active_level()
+    {
+        const int forced = detail::forced_level.load(std::memory_order_relaxed);
+        return forced == detail::no_forced_level ? detected_level() : static_cast<level>(forced);
+    }
+
+    // Pins the batch kernels to a level, mainly for tests and benchmarks.
+    // Levels above what the cpu supports are clamped to detected_level, returns the level now active.
+    inline level force_level( level l )
+    {
+        const level clamped = static_cast<int>(l) > static_cast<int>(detected_level()) ? detected_level() : l;
+        detail::forced_level.store(static_cast<int>(clamped), std::memory_order_relaxed);
+        return clamped;
+    }
+
+    // Returns to the detected level
+    inline void reset_level()
+    {
+        detail::forced_level.store(detail::no_forced_level, std::memory_order_relaxed);
+    }
+
+    namespace detail
+    {
+#if defined(SQUIGGLE_SSE2)
+        template<typename T>
+        inline constexpr kernel_table<T> tables[] = { scalar::table<T>, sse41::table<T>, avx2::table<T>, avx512::table<T> };
+        template<typename T>
+        inline constexpr int widths[] = { scalar::lanes<T>::width, sse41::lanes<T>::width, avx2::lanes<T>::width, avx512::lanes<T>::width };
+#else
+        template<typename T>
+        inline constexpr kernel_table<T> tables[] = { scalar::table<T> };
+        template<typename T>
+        inline constexpr int widths[] = { scalar::lanes<T>::width };
+#endif
+    }
+
+    // Kernels for the active level
+    template<std::floating_point T>
+    [[nodiscard]] inline const kernel_table<T>& kernels()
+    {
+        static_assert( std::same_as<T,float> || std::same_as<T,double>, "Batch kernels are only available for float and double" );
+        constexpr int levels = static_cast<int>(std::size(detail::tables<T>));
+        const int l = static_cast<int>(active_level());
+        return detail::tables<T>[l < levels ? l : levels - 1];
+    }
+
+    // Kernels for the active level, or the highest level below it with registers of at most max_width lanes.
+    // For data held in fixed size blocks, a register wider than the block would only ever run the scalar tail.
+    template<std::floating_point T>
+    [[nodiscard]] inline const kernel_table<T>& kernels( std::size_t max_width )
+    {
+        constexpr int levels = static_cast<int>(std::size(detail::tables<T>));
+        const int active = static_cast<int>(active_level());
+        int l = active < levels ? active : levels - 1;
+        while ( l > 0 && static_cast<std::size_t>(detail::widths<T>[l]) > max_width )
+            l--;
+        return detail::tables<T>[l];
+    }
+
+    // All of these take arrays of interleaved x,y,z (such as vec3<T>[count]), out may alias the input.
+    // Matrices are row major 4x4 (mat44<T>::a) and quaternions are w,x,y,z (quat<T>).
+
+    // out = matrix * (point, 1)
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void transform_points( const T* points, T* out, std::size_t count, const T* matrix )
+    {
+        kernels<T>().transform_points(points, out, count, matrix);
+    }
+
+    // out = matrix * (direction, 0)
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void transform_dirs( const T* directions, T* out, std::size_t count, const T* matrix )
+    {
+        kernels<T>().transform_dirs(directions, out, count, matrix);
+    }
+
+    // out = matrix * (point, 1) for separate x, y and z arrays, each out array may alias its input
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void transform_soa( const T* x, const T* y, const T* z, T* out_x, T* out_y, T* out_z, std::size_t count, const T* matrix )
+    {
+        kernels<T>().transform_soa(x, y, z, out_x, out_y, out_z, count, matrix);
+    }
+
+    // out = vector / |vector|, zero length vectors are not checked
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void normalize( const T* vectors, T* out, std::size_t count )
+    {
+        kernels<T>().normalize(vectors, out, count);
+    }
+
+    // out[i] = |vector[i]|^2, out is one scalar per vector
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void mag2( const T* vectors, T* out, std::size_t count )
+    {
+        kernels<T>().mag2(vectors, out, count);
+    }
+
+    // out[i] = |vector[i]|
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void mag( const T* vectors, T* out, std::size_t count )
+    {
+        kernels<T>().mag(vectors, out, count);
+    }
+
+    // out[i] = dot(a[i], b[i])
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void dot( const T* a, const T* b, T* out, std::size_t count )
+    {
+        kernels<T>().dot(a, b, out, count);
+    }
+
+    // out = the sum of count vectors of n_dims interleaved components, out is n_dims long.
+    // Lanes are summed separately so the rounding depends on the level, see reduction in sqg_batch.h.
+    template<int n_dims, std::floating_point T>
+    SQUIGGLE_INLINE void sum( const T* vectors, std::size_t count, T* out )
+    {
+        static_assert( n_dims >= 2 && n_dims <= 4, "sum supports 2 to 4 components" );
+        kernels<T>().sum[n_dims - 2](vectors, count, out);
+    }
+
+    // out[i] = a[i] * b[i] for arrays of w,x,y,z quaternions
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void compose( const T* a, const T* b, T* out, std::size_t count )
+    {
+        kernels<T>().compose(a, b, out, count);
+    }
+
+    // out[i] = quaternion * b[i]
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void premultiply( const T* quaternion, const T* b, T* out, std::size_t count )
+    {
+        kernels<T>().premultiply(quaternion, b, out, count);
+    }
+
+    // As compose for separate component arrays, a, b and out each point to the w, x, y and z arrays
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void compose_soa( const T* const* a, const T* const* b, T* const* out, std::size_t count )
+    {
+        kernels<T>().compose_soa(a, b, out, count);
+    }
+
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void premultiply_soa( const T* quaternion, const T* const* b, T* const* out, std::size_t count )
+    {
+        kernels<T>().premultiply_soa(quaternion, b, out, count);
+    }
+
+    // As compose_soa for blocks of block_width quaternions each stored as block_width w, x, y then z
+    // (quat_block), count quaternions in total
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void compose_blocks( const T* a, const T* b, T* out, std::size_t count, std::size_t block_width )
+    {
+        kernels<T>(block_width).compose_blocks(a, b, out, count, block_width);
+    }
+
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void premultiply_blocks( const T* quaternion, const T* b, T* out, std::size_t count, std::size_t block_width )
+    {
+        kernels<T>(block_width).premultiply_blocks(quaternion, b, out, count, block_width);
+    }
+
+    // Rotation matrix of each w,x,y,z quaternion. Matrices are row major n_dims x n_dims, mat33<T> or
+    // mat44<T>, and only their upper 3x3 is written.
+    template<int n_dims = 3, std::floating_point T>
+    SQUIGGLE_INLINE void quat_to_mat( const T* quaternions, T* matrices, std::size_t count )
+    {
+        static_assert( n_dims == 3 || n_dims == 4, "Rotation matrices are 3x3 or 4x4" );
+        kernels<T>().quat_to_mat[n_dims - 3](quaternions, matrices, count);
+    }
+
+    // Quaternion of the upper 3x3 of each rotation matrix with Shepperd's method
+    template<int n_dims = 3, std::floating_point T>
+    SQUIGGLE_INLINE void mat_to_quat( const T* matrices, T* quaternions, std::size_t count )
+    {
+        static_assert( n_dims == 3 || n_dims == 4, "Rotation matrices are 3x3 or 4x4" );
+        kernels<T>().mat_to_quat[n_dims - 3](matrices, quaternions, count);
+    }
+
+    // world[node] = world[parents[node]] * local[node] for each of the count nodes, arrays of row major 4x4 matrices.
+    // No node in nodes may be the parent of another, see transform_hierarchy in sqg_hierarchy.h.
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void multiply_parents( T* world, const T* local, const std::uint32_t* parents, const std::uint32_t* nodes, std::size_t count )
+    {
+        kernels<T>().multiply_parents(world, local, parents, nodes, count);
+    }
+
+    // out = vector * rsqrt(|vector|^2) with refinements Newton steps, see math::rsqrt_fast for the error.
+    // Squared lengths must be in the normal float range.
+    template<int refinements = 1, std::floating_point T>
+    SQUIGGLE_INLINE void normalize_fast( const T* vectors, T* out, std::size_t count )
+    {
+        static_assert( refinements >= 0 && refinements <= max_refinements, "normalize_fast supports 0 to 3 refinements" );
+        kernels<T>().normalize_fast[refinements](vectors, out, count);
+    }
+
+    // As normalize_fast for four component vectors or quaternions, the component order does not matter
+    template<int refinements = 1, std::floating_point T>
+    SQUIGGLE_INLINE void normalize4_fast( const T* vectors, T* out, std::size_t count )
+    {
+        static_assert( refinements >= 0 && refinements <= max_refinements, "normalize4_fast supports 0 to 3 refinements" );
+        kernels<T>().normalize4_fast[refinements](vectors, out, count);
+    }
+
+    // Dual quaternions are 8 scalars, the real part w,x,y,z then the dual part w,x,y,z as in dualquat<T>.
+    // out[i] = a[i] * b[i], out may be a or b.
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void compose_dualquats( const T* a, const T* b, T* out, std::size_t count )
+    {
+        kernels<T>().compose_dualquats(a, b, out, count);
+    }
+
+    // out[i] = normalized(dualquats[i]), see normalize in sqg_dualquat.h
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void normalize_dualquats( const T* dualquats, T* out, std::size_t count )
+    {
+        kernels<T>().normalize_dualquats(dualquats, out, count);
+    }
+
+    // out[i] = dlb(a[i], b[i], t), see dlb in sqg_dualquat.h
+    template<std::floating_point T>
+    SQUIGGLE_INLINE void blend_dualquats( const T* a, const T* b, T t, T* out, std::size_t count )
+    {
+        kernels<T>().blend_dualquats(a, b, t, out, count);
+    }
+
+    // Rigid transform matrix of each normalised dual quaternion. Matrices are row major with rows = 3 for
+    // mat34<T> and rows = 4 for mat44<T>, every element is written.
+    template<int rows = 4, std::floating_point T>
+    SQUIGGLE_INLINE void dualquat_to_mat( const T* dualquats, T* matrices, std::size_t count )
+    {
+        static_assert( rows == 3 || rows == 4, "Dual quaternion matrices are 3x4 or 4x4" );
+        kernels<T>().dualquat_to_mat[rows - 3](dualquats, matrices, count);
+    }
+
+    // Linear blend skinning of count vertices held as structure of arrays. Bones are row major 3x4 (rows = 3)
+    // or 4x4 (rows = 4) matrices of which only the top three rows are read. Influence k of vertex i is bone
+    // indices[k * stride + i] with weight weights[k * stride + i]. in and out are the x, y and z arrays of the
+    // positions then of the normals, out may be in. Normals are skipped when in[3] is null and are normalised.
+    template<int rows = 4, std::floating_point T>
+    SQUIGGLE_INLINE void skin_vertices( const T* bones, const std::uint32_t* indices, const T* weights, std::size_t influences, std::size_t stride,
+                                        const T* const* in, T* const* out, std::size_t count )
+    {
+        static_assert( rows == 3 || rows == 4, "Bone matrices are 3x4 or 4x4" );
+        kernels<T>().skin_vertices[rows - 3](bones, indices, weights, influences, stride, in, out, count);
+    }
+}
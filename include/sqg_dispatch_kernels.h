@@ -0,0 +1,1168 @@
+// No include guard, this is included once per instruction set level by sqg_dispatch.h with
+// SQUIGGLE_KERNEL_NAMESPACE naming the level and SQUIGGLE_KERNEL_TARGET its target attribute.
+// The level namespace must already define lanes<T>.
+
+#if !defined(SQUIGGLE_KERNEL_NAMESPACE) || !defined(SQUIGGLE_KERNEL_TARGET)
+#   error "sqg_dispatch_kernels.h is included by sqg_dispatch.h only"
+#endif
+
+namespace sqg::dispatch::SQUIGGLE_KERNEL_NAMESPACE
+{
+    // Three registers of interleaved x,y,z are blended so each lane holds the right component then
+    // permuted back into point order, see detail::aos_register for the layout.
+    template<typename L, int component, int... point>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE typename L::reg load_component( typename L::reg m0, typename L::reg m1, typename L::reg m2, std::integer_sequence<int, point...> )
+    {
+        constexpr int width = L::width;
+        const auto blended = L::template blend<detail::aos_mask(width, component, 2)>(
+            L::template blend<detail::aos_mask(width, component, 1)>(m0, m1), m2
+        );
+        return L::template permute<detail::aos_lane(width, component, point)...>(blended);
+    }
+
+    template<typename L, int component, int... lane>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE typename L::reg scatter_component( typename L::reg v, std::integer_sequence<int, lane...> )
+    {
+        return L::template permute<detail::aos_point(L::width, component, lane)...>(v);
+    }
+
+    template<typename L, typename T>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE void load_xyz( const T* p, typename L::reg& x, typename L::reg& y, typename L::reg& z )
+    {
+        constexpr int width = L::width;
+        const auto m0 = L::load(p);
+        const auto m1 = L::load(p + width);
+        const auto m2 = L::load(p + 2 * width);
+        x = load_component<L, 0>(m0, m1, m2, std::make_integer_sequence<int, width>{});
+        y = load_component<L, 1>(m0, m1, m2, std::make_integer_sequence<int, width>{});
+        z = load_component<L, 2>(m0, m1, m2, std::make_integer_sequence<int, width>{});
+    }
+
+    template<typename L, typename T>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE void store_xyz( T* p, typename L::reg x, typename L::reg y, typename L::reg z )
+    {
+        constexpr int width = L::width;
+        const auto sx = scatter_component<L, 0>(x, std::make_integer_sequence<int, width>{});
+        const auto sy = scatter_component<L, 1>(y, std::make_integer_sequence<int, width>{});
+        const auto sz = scatter_component<L, 2>(z, std::make_integer_sequence<int, width>{});
+
+        L::store(p,             L::template blend<detail::aos_mask(width, 2, 0)>(L::template blend<detail::aos_mask(width, 1, 0)>(sx, sy), sz));
+        L::store(p + width,     L::template blend<detail::aos_mask(width, 2, 1)>(L::template blend<detail::aos_mask(width, 1, 1)>(sx, sy), sz));
+        L::store(p + 2 * width, L::template blend<detail::aos_mask(width, 2, 2)>(L::template blend<detail::aos_mask(width, 1, 2)>(sx, sy), sz));
+    }
+
+    // Same evaluation order as transform_point/transform_dir in sqg_mat_vec.h
+    template<bool translate, typename T>
+    SQUIGGLE_KERNEL_TARGET void transform( const T* in, T* out, std::size_t count, const T* m )
+    {
+        using L = lanes<T>;
+        constexpr std::size_t width = L::width;
+
+        const auto m00 = L::set1(m[0]);  const auto m01 = L::set1(m[1]);  const auto m02 = L::set1(m[2]);  const auto m03 = L::set1(m[3]);
+        const auto m10 = L::set1(m[4]);  const auto m11 = L::set1(m[5]);  const auto m12 = L::set1(m[6]);  const auto m13 = L::set1(m[7]);
+        const auto m20 = L::set1(m[8]);  const auto m21 = L::set1(m[9]);  const auto m22 = L::set1(m[10]); const auto m23 = L::set1(m[11]);
+
+        std::size_t i = 0;
+        for ( ; i + width <= count; i += width )
+        {
+            typename L::reg x, y, z;
+            load_xyz<L>(in + 3 * i, x, y, z);
+
+            auto rx = L::fmadd(m02, z, L::fmadd(m01, y, L::mul(m00, x)));
+            auto ry = L::fmadd(m12, z, L::fmadd(m11, y, L::mul(m10, x)));
+            auto rz = L::fmadd(m22, z, L::fmadd(m21, y, L::mul(m20, x)));
+            if constexpr ( translate )
+            {
+                rx = L::add(rx, m03);
+                ry = L::add(ry, m13);
+                rz = L::add(rz, m23);
+            }
+
+            store_xyz<L>(out + 3 * i, rx, ry, rz);
+        }
+
+        if constexpr ( width > 1 )
+        {
+            if ( i < count )
+                scalar::transform<translate>(in + 3 * i, out + 3 * i, count - i, m);
+        }
+    }
+
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void transform_points( const T* points, T* out, std::size_t count, const T* matrix )
+    {
+        transform<true>(points, out, count, matrix);
+    }
+
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void transform_dirs( const T* directions, T* out, std::size_t count, const T* matrix )
+    {
+        transform<false>(directions, out, count, matrix);
+    }
+
+    // Structure of arrays, each component is its own array so there is no shuffling. Same evaluation order as transform
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void transform_soa( const T* x, const T* y, const T* z, T* out_x, T* out_y, T* out_z, std::size_t count, const T* m )
+    {
+        using L = lanes<T>;
+        constexpr std::size_t width = L::width;
+
+        const auto m00 = L::set1(m[0]);  const auto m01 = L::set1(m[1]);  const auto m02 = L::set1(m[2]);  const auto m03 = L::set1(m[3]);
+        const auto m10 = L::set1(m[4]);  const auto m11 = L::set1(m[5]);  const auto m12 = L::set1(m[6]);  const auto m13 = L::set1(m[7]);
+        const auto m20 = L::set1(m[8]);  const auto m21 = L::set1(m[9]);  const auto m22 = L::set1(m[10]); const auto m23 = L::set1(m[11]);
+
+        std::size_t i = 0;
+        for ( ; i + width <= count; i += width )
+        {
+            const auto px = L::load(x + i);
+            const auto py = L::load(y + i);
+            const auto pz = L::load(z + i);
+
+            L::store(out_x + i, L::add(L::fmadd(m02, pz, L::fmadd(m01, py, L::mul(m00, px))), m03));
+            L::store(out_y + i, L::add(L::fmadd(m12, pz, L::fmadd(m11, py, L::mul(m10, px))), m13));
+            L::store(out_z + i, L::add(L::fmadd(m22, pz, L::fmadd(m21, py, L::mul(m20, px))), m23));
+        }
+
+        if constexpr ( width > 1 )
+        {
+            if ( i < count )
+                scalar::transform_soa(x + i, y + i, z + i, out_x + i, out_y + i, out_z + i, count - i, m);
+        }
+    }
+
+    // Same evaluation order as normalize in sqg_vec.h, no fused operations so results match it exactly
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void normalize( const T* in, T* out, std::size_t count )
+    {
+        using L = lanes<T>;
+        constexpr std::size_t width = L::width;
+        const auto one = L::set1(T{1});
+
+        std::size_t i = 0;
+        for ( ; i + width <= count; i += width )
+        {
+            typename L::reg x, y, z;
+            load_xyz<L>(in + 3 * i, x, y, z);
+
+            const auto length2 = L::add(L::add(L::mul(x, x), L::mul(y, y)), L::mul(z, z));
+            const auto inverse = L::div(one, L::sqrt(length2));
+
+            store_xyz<L>(out + 3 * i, L::mul(inverse, x), L::mul(inverse, y), L::mul(inverse, z));
+        }
+
+        if constexpr ( width > 1 )
+        {
+            if ( i < count )
+                scalar::normalize(in + 3 * i, out + 3 * i, count - i);
+        }
+    }
+
+    // Same evaluation order as dot in sqg_vec3.h, one squared length or length per vector
+    template<bool root, typename T>
+    SQUIGGLE_KERNEL_TARGET void magnitudes( const T* in, T* out, std::size_t count )
+    {
+        using L = lanes<T>;
+        constexpr std::size_t width = L::width;
+
+        std::size_t i = 0;
+        for ( ; i + width <= count; i += width )
+        {
+            typename L::reg x, y, z;
+            load_xyz<L>(in + 3 * i, x, y, z);
+
+            const auto length2 = L::add(L::add(L::mul(x, x), L::mul(y, y)), L::mul(z, z));
+            L::store(out + i, root ? L::sqrt(length2) : length2);
+        }
+
+        if constexpr ( width > 1 )
+        {
+            if ( i < count )
+                scalar::magnitudes<root>(in + 3 * i, out + i, count - i);
+        }
+    }
+
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void mag2( const T* vectors, T* out, std::size_t count )
+    {
+        magnitudes<false>(vectors, out, count);
+    }
+
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void mag( const T* vectors, T* out, std::size_t count )
+    {
+        magnitudes<true>(vectors, out, count);
+    }
+
+    // Same evaluation order as dot in sqg_vec3.h
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void dot( const T* a, const T* b, T* out, std::size_t count )
+    {
+        using L = lanes<T>;
+        constexpr std::size_t width = L::width;
+
+        std::size_t i = 0;
+        for ( ; i + width <= count; i += width )
+        {
+            typename L::reg ax, ay, az, bx, by, bz;
+            load_xyz<L>(a + 3 * i, ax, ay, az);
+            load_xyz<L>(b + 3 * i, bx, by, bz);
+
+            L::store(out + i, L::add(L::add(L::mul(ax, bx), L::mul(ay, by)), L::mul(az, bz)));
+        }
+
+        if constexpr ( width > 1 )
+        {
+            if ( i < count )
+                scalar::dot(a + 3 * i, b + 3 * i, out + i, count - i);
+        }
+    }
+
+    // n registers cover width whole vectors of n components and lane j of register r always holds
+    // component (width * r + j) % n, so they accumulate without shuffles and are folded into out once
+    // at the end. Each lane is a separate partial sum so the order is not that of a running sum.
+    template<int n, typename T>
+    SQUIGGLE_KERNEL_TARGET void sum( const T* in, std::size_t count, T* out )
+    {
+        using L = lanes<T>;
+        constexpr std::size_t width = L::width;
+
+        // two sets of accumulators so consecutive adds do not wait on each other
+        typename L::reg total[2 * n];
+        for ( int r = 0; r < 2 * n; r++ )
+            total[r] = L::set1(T{0});
+
+        std::size_t i = 0;
+        for ( ; i + 2 * width <= count; i += 2 * width )
+        {
+            for ( int r = 0; r < 2 * n; r++ )
+                total[r] = L::add(total[r], L::load(in + n * i + width * r));
+        }
+        for ( ; i + width <= count; i += width )
+        {
+            for ( int r = 0; r < n; r++ )
+                total[r] = L::add(total[r], L::load(in + n * i + width * r));
+        }
+
+        T partial[n * width];
+        for ( int r = 0; r < n; r++ )
+            L::store(partial + width * r, L::add(total[r], total[n + r]));
+
+        for ( int c = 0; c < n; c++ )
+            out[c] = T{0};
+        for ( std::size_t j = 0; j < n * width; j++ )
+            out[j % n] += partial[j];
+
+        for ( ; i < count; i++ )
+        {
+            for ( int c = 0; c < n; c++ )
+                out[c] += in[n * i + c];
+        }
+    }
+
+    // Same steps as math::rsqrt_fast
+    template<typename L, int refinements>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE typename L::reg rsqrt_fast( typename L::reg s )
+    {
+        const auto half = L::mul(L::set1(0.5f), s);
+        const auto three_halves = L::set1(1.5f);
+
+        auto y = L::rsqrt(s);
+        for ( int i = 0; i < refinements; i++ )
+            y = L::mul(y, L::sub(three_halves, L::mul(L::mul(half, y), y)));
+        return y;
+    }
+
+    template<int refinements, typename T>
+    SQUIGGLE_KERNEL_TARGET void normalize_fast( const T* in, T* out, std::size_t count )
+    {
+        using L = lanes<T>;
+        constexpr std::size_t width = L::width;
+
+        std::size_t i = 0;
+        for ( ; i + width <= count; i += width )
+        {
+            typename L::reg x, y, z;
+            load_xyz<L>(in + 3 * i, x, y, z);
+
+            const auto length2 = L::add(L::add(L::mul(x, x), L::mul(y, y)), L::mul(z, z));
+            const auto inverse = rsqrt_fast<L, refinements>(length2);
+
+            store_xyz<L>(out + 3 * i, L::mul(inverse, x), L::mul(inverse, y), L::mul(inverse, z));
+        }
+
+        if constexpr ( width > 1 )
+        {
+            if ( i < count )
+                scalar::normalize_fast<refinements>(in + 3 * i, out + 3 * i, count - i);
+        }
+    }
+
+    template<typename L, int mask, int... lane>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE typename L::reg permute_xor( typename L::reg v, std::integer_sequence<int, lane...> )
+    {
+        return L::template permute<( lane ^ mask )...>(v);
+    }
+
+    // Each register holds width / 4 whole vectors, the squares are summed pairwise across each group
+    // of four lanes which leaves the squared length in every lane of the group.
+    // Levels with fewer than four lanes run one vector at a time.
+    template<int refinements, typename T>
+    SQUIGGLE_KERNEL_TARGET void normalize4_fast( const T* in, T* out, std::size_t count )
+    {
+        using L = lanes<T>;
+        constexpr std::size_t width = L::width;
+
+        std::size_t i = 0;
+        if constexpr ( width % 4 == 0 )
+        {
+            constexpr std::size_t per_register = width / 4;
+            for ( ; i + per_register <= count; i += per_register )
+            {
+                const auto v = L::load(in + 4 * i);
+                const auto squares = L::mul(v, v);
+                const auto pairs = L::add(squares, permute_xor<L, 1>(squares, std::make_integer_sequence<int, width>{}));
+                const auto length2 = L::add(pairs, permute_xor<L, 2>(pairs, std::make_integer_sequence<int, width>{}));
+
+                L::store(out + 4 * i, L::mul(v, rsqrt_fast<L, refinements>(length2)));
+            }
+        }
+
+        using S = scalar::lanes<T>;
+        for ( ; i < count; i++ )
+        {
+            const T* v = in + 4 * i;
+            const T length2 = ( v[0] * v[0] + v[1] * v[1] ) + ( v[2] * v[2] + v[3] * v[3] );
+            const T inverse = scalar::rsqrt_fast<S, refinements>(length2);
+
+            T* r = out + 4 * i;
+            r[0] = v[0] * inverse;
+            r[1] = v[1] * inverse;
+            r[2] = v[2] * inverse;
+            r[3] = v[3] * inverse;
+        }
+    }
+
+    // Applies the same four lane permutation to every group of four lanes
+    template<typename L, int p0, int p1, int p2, int p3, int... lane>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE typename L::reg permute_groups( typename L::reg v, std::integer_sequence<int, lane...> )
+    {
+        return L::template permute<( ( lane & ~3 ) + ( ( lane & 3 ) == 0 ? p0 : ( lane & 3 ) == 1 ? p1 : ( lane & 3 ) == 2 ? p2 : p3 ) )...>(v);
+    }
+
+    // Each group of four lanes holds one w,x,y,z quaternion. As the simd quaternion product in sqg_quat.h
+    // each component of a is broadcast across its group against a signed permutation of b.
+    template<typename L, typename T>
+    struct quat_product
+    {
+        using reg = typename L::reg;
+        static constexpr auto lane_sequence = std::make_integer_sequence<int, L::width>{};
+
+        reg sign_x, sign_y, sign_z;
+
+        SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE quat_product()
+        {
+            T x[L::width], y[L::width], z[L::width];
+            for ( int j = 0; j < L::width; j++ )
+            {
+                constexpr T signs_x[4] = { -1, 1, -1, 1 };
+                constexpr T signs_y[4] = { -1, 1, 1, -1 };
+                constexpr T signs_z[4] = { -1, -1, 1, 1 };
+                x[j] = signs_x[j & 3];
+                y[j] = signs_y[j & 3];
+                z[j] = signs_z[j & 3];
+            }
+            sign_x = L::load(x);
+            sign_y = L::load(y);
+            sign_z = L::load(z);
+        }
+
+        // a with its components broadcast and signed, so a product is one mul and three fmadds
+        struct left { reg w, x, y, z; };
+
+        SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE left expand( reg a ) const
+        {
+            return {
+                permute_groups<L, 0, 0, 0, 0>(a, lane_sequence),
+                L::mul(sign_x, permute_groups<L, 1, 1, 1, 1>(a, lane_sequence)),
+                L::mul(sign_y, permute_groups<L, 2, 2, 2, 2>(a, lane_sequence)),
+                L::mul(sign_z, permute_groups<L, 3, 3, 3, 3>(a, lane_sequence)),
+            };
+        }
+
+        static SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE reg multiply( const left& a, reg b )
+        {
+            auto r = L::mul(a.w, b);
+            r = L::fmadd(a.x, permute_groups<L, 1, 0, 3, 2>(b, lane_sequence), r);
+            r = L::fmadd(a.y, permute_groups<L, 2, 3, 0, 1>(b, lane_sequence), r);
+            r = L::fmadd(a.z, permute_groups<L, 3, 2, 1, 0>(b, lane_sequence), r);
+            return r;
+        }
+    };
+
+    // Same evaluation order as the quaternion product in sqg_quat.h
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE void quat_multiply( T aw, T ax, T ay, T az, T bw, T bx, T by, T bz, T* out )
+    {
+        out[0] = aw * bw - ax * bx - ay * by - az * bz;
+        out[1] = aw * bx + ax * bw + ay * bz - az * by;
+        out[2] = aw * by + ay * bw + az * bx - ax * bz;
+        out[3] = aw * bz + az * bw + ax * by - ay * bx;
+    }
+
+    // a is one quaternion for every product when broadcast. Levels with fewer than four lanes run one at a time.
+    template<bool broadcast, typename T>
+    SQUIGGLE_KERNEL_TARGET void compose( const T* a, const T* b, T* out, std::size_t count )
+    {
+        using L = lanes<T>;
+        constexpr std::size_t width = L::width;
+
+        std::size_t i = 0;
+        if constexpr ( width % 4 == 0 )
+        {
+            constexpr std::size_t per_register = width / 4;
+            const quat_product<L,T> product;
+
+            typename quat_product<L,T>::left q{};
+            if constexpr ( broadcast )
+            {
+                T repeated[width];
+                for ( std::size_t j = 0; j < width; j++ )
+                    repeated[j] = a[j & 3];
+                q = product.expand(L::load(repeated));
+            }
+
+            for ( ; i + per_register <= count; i += per_register )
+            {
+                if constexpr ( !broadcast )
+                    q = product.expand(L::load(a + 4 * i));
+                L::store(out + 4 * i, product.multiply(q, L::load(b + 4 * i)));
+            }
+        }
+
+        for ( ; i < count; i++ )
+        {
+            const T* p = broadcast ? a : a + 4 * i;
+            const T* r = b + 4 * i;
+            quat_multiply(p[0], p[1], p[2], p[3], r[0], r[1], r[2], r[3], out + 4 * i);
+        }
+    }
+
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void compose_aos( const T* a, const T* b, T* out, std::size_t count )
+    {
+        compose<false>(a, b, out, count);
+    }
+
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void premultiply_aos( const T* q, const T* b, T* out, std::size_t count )
+    {
+        compose<true>(q, b, out, count);
+    }
+
+    // Separate w, x, y and z arrays, no shuffling and the same evaluation order as the quaternion product
+    // in sqg_quat.h so the results match it exactly. a is one quaternion (w,x,y,z) when broadcast.
+    template<bool broadcast, typename T>
+    SQUIGGLE_KERNEL_TARGET void compose_components( const T* const* a, const T* q, const T* const* b, T* const* out, std::size_t count )
+    {
+        using L = lanes<T>;
+        constexpr std::size_t width = L::width;
+
+        std::size_t i = 0;
+        for ( ; i + width <= count; i += width )
+        {
+            const auto aw = broadcast ? L::set1(q[0]) : L::load(a[0] + i);
+            const auto ax = broadcast ? L::set1(q[1]) : L::load(a[1] + i);
+            const auto ay = broadcast ? L::set1(q[2]) : L::load(a[2] + i);
+            const auto az = broadcast ? L::set1(q[3]) : L::load(a[3] + i);
+            const auto bw = L::load(b[0] + i);
+            const auto bx = L::load(b[1] + i);
+            const auto by = L::load(b[2] + i);
+            const auto bz = L::load(b[3] + i);
+
+            L::store(out[0] + i, L::sub(L::sub(L::sub(L::mul(aw, bw), L::mul(ax, bx)), L::mul(ay, by)), L::mul(az, bz)));
+            L::store(out[1] + i, L::sub(L::add(L::add(L::mul(aw, bx), L::mul(ax, bw)), L::mul(ay, bz)), L::mul(az, by)));
+            L::store(out[2] + i, L::sub(L::add(L::add(L::mul(aw, by), L::mul(ay, bw)), L::mul(az, bx)), L::mul(ax, bz)));
+            L::store(out[3] + i, L::sub(L::add(L::add(L::mul(aw, bz), L::mul(az, bw)), L::mul(ax, by)), L::mul(ay, bx)));
+        }
+
+        for ( ; i < count; i++ )
+        {
+            T r[4];
+            if constexpr ( broadcast )
+                quat_multiply(q[0], q[1], q[2], q[3], b[0][i], b[1][i], b[2][i], b[3][i], r);
+            else
+                quat_multiply(a[0][i], a[1][i], a[2][i], a[3][i], b[0][i], b[1][i], b[2][i], b[3][i], r);
+
+            for ( int c = 0; c < 4; c++ )
+                out[c][i] = r[c];
+        }
+    }
+
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void compose_soa( const T* const* a, const T* const* b, T* const* out, std::size_t count )
+    {
+        compose_components<false>(a, static_cast<const T*>(nullptr), b, out, count);
+    }
+
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void premultiply_soa( const T* q, const T* const* b, T* const* out, std::size_t count )
+    {
+        compose_components<true>(static_cast<const T* const*>(nullptr), q, b, out, count);
+    }
+
+    // Blocks of block_width quaternions stored as block_width w, x, y then z, as in quat_block.
+    // Only the first count quaternions are written so the padding lanes of the last block are untouched.
+    template<bool broadcast, typename T>
+    SQUIGGLE_KERNEL_TARGET void compose_block_components( const T* a, const T* q, const T* b, T* out, std::size_t count, std::size_t block_width )
+    {
+        for ( std::size_t i = 0; i < count; i += block_width )
+        {
+            const std::size_t offset = i * 4;
+            const T* pa[4];
+            const T* pb[4];
+            T* po[4];
+            for ( std::size_t c = 0; c < 4; c++ )
+            {
+                pa[c] = broadcast ? nullptr : a + offset + c * block_width;
+                pb[c] = b + offset + c * block_width;
+                po[c] = out + offset + c * block_width;
+            }
+            compose_components<broadcast>(pa, q, pb, po, count - i < block_width ? count - i : block_width);
+        }
+    }
+
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void compose_blocks( const T* a, const T* b, T* out, std::size_t count, std::size_t block_width )
+    {
+        compose_block_components<false>(a, static_cast<const T*>(nullptr), b, out, count, block_width);
+    }
+
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void premultiply_blocks( const T* q, const T* b, T* out, std::size_t count, std::size_t block_width )
+    {
+        compose_block_components<true>(static_cast<const T*>(nullptr), q, b, out, count, block_width);
+    }
+
+    // Same terms as assign from a quaternion in sqg_quat_mat.h, m is the 3x3 matrix in row order
+    template<typename L, typename T>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE void quat_matrix( const typename L::reg* q, typename L::reg* m )
+    {
+        using reg = typename L::reg;
+        const reg one = L::set1(T{1});
+        const reg two = L::set1(T{2});
+
+        const reg xx = L::mul(q[1], q[1]);
+        const reg yy = L::mul(q[2], q[2]);
+        const reg zz = L::mul(q[3], q[3]);
+
+        const reg xy = L::mul(q[1], q[2]);
+        const reg zw = L::mul(q[3], q[0]);
+        const reg xz = L::mul(q[1], q[3]);
+        const reg yw = L::mul(q[2], q[0]);
+        const reg yz = L::mul(q[2], q[3]);
+        const reg xw = L::mul(q[1], q[0]);
+
+        m[0] = L::sub(one, L::mul(two, L::add(yy, zz)));
+        m[1] = L::mul(two, L::sub(xy, zw));
+        m[2] = L::mul(two, L::add(xz, yw));
+
+        m[3] = L::mul(two, L::add(xy, zw));
+        m[4] = L::sub(one, L::mul(two, L::add(xx, zz)));
+        m[5] = L::mul(two, L::sub(yz, xw));
+
+        m[6] = L::mul(two, L::sub(xz, yw));
+        m[7] = L::mul(two, L::add(yz, xw));
+        m[8] = L::sub(one, L::mul(two, L::add(xx, yy)));
+    }
+
+    // The value for whichever of w, x, y and z is largest, ties go to the first as in sqg_quat_mat.h
+    template<typename L, typename reg = typename L::reg>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE reg pick_largest( reg trace, const reg* m, reg largest, reg w, reg x, reg y, reg z )
+    {
+        return L::select_ge(trace, largest, w, L::select_ge(m[0], largest, x, L::select_ge(m[4], largest, y, z)));
+    }
+
+    // Shepperd's method as assign from a matrix in sqg_quat_mat.h. Every lane computes the shared terms
+    // and the branch on the largest component becomes selects, so lanes taking different branches cost nothing.
+    template<typename L, typename T>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE void matrix_quat( const typename L::reg* m, typename L::reg* q )
+    {
+        using reg = typename L::reg;
+        const reg one = L::set1(T{1});
+        const reg half = L::set1(T{0.5});
+
+        const reg trace = L::add(L::add(m[0], m[4]), m[8]);
+        const reg largest = L::max(L::max(trace, m[0]), L::max(m[4], m[8]));
+        const reg r = L::sqrt(L::sub(L::add(one, L::add(largest, largest)), trace));
+        const reg h = L::mul(half, r);
+        const reg s = L::div(half, r);
+
+        const reg wx = L::mul(L::sub(m[7], m[5]), s);
+        const reg wy = L::mul(L::sub(m[2], m[6]), s);
+        const reg wz = L::mul(L::sub(m[3], m[1]), s);
+        const reg xy = L::mul(L::add(m[1], m[3]), s);
+        const reg xz = L::mul(L::add(m[2], m[6]), s);
+        const reg yz = L::mul(L::add(m[5], m[7]), s);
+
+        if constexpr ( L::width == 1 )
+        {
+            // one element at a time a branch is cheaper than evaluating every select
+            const reg picked[4][4] = { { h, wx, wy, wz }, { wx, h, xy, xz }, { wy, xy, h, yz }, { wz, xz, yz, h } };
+            const int largest_component = trace >= largest ? 0 : m[0] >= largest ? 1 : m[4] >= largest ? 2 : 3;
+            for ( int c = 0; c < 4; c++ )
+                q[c] = picked[largest_component][c];
+        }
+        else
+        {
+            q[0] = pick_largest<L>(trace, m, largest, h, wx, wy, wz);
+            q[1] = pick_largest<L>(trace, m, largest, wx, h, xy, xz);
+            q[2] = pick_largest<L>(trace, m, largest, wy, xy, h, yz);
+            q[3] = pick_largest<L>(trace, m, largest, wz, xz, yz, h);
+        }
+    }
+
+    // Elements of n interleaved scalars, see detail::strided_register for where each component lands.
+    // When the lanes are disjoint the registers are blended and permuted once like load_component, otherwise
+    // every register holding the component is permuted into element order and blended in, r counts down.
+    template<typename L, int n, int component, int r, int... element>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE typename L::reg strided_permute( typename L::reg v, std::integer_sequence<int, element...> )
+    {
+        return L::template permute<detail::strided_source(L::width, n, component, r, element)...>(v);
+    }
+
+    template<typename L, int n, int component, typename T, int r = n - 1>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE typename L::reg blend_component( const T* p )
+    {
+        constexpr int mask = detail::scatter_mask(L::width, n, component, r);
+        if constexpr ( r == 0 )
+            return L::load(p);
+        else if constexpr ( mask == 0 )
+            return blend_component<L, n, component, T, r - 1>(p);
+        else
+            return L::template blend<mask>(blend_component<L, n, component, T, r - 1>(p), L::load(p + r * L::width));
+    }
+
+    template<typename L, int n, int component, typename T, int... element>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE typename L::reg gather_disjoint( const T* p, std::integer_sequence<int, element...> )
+    {
+        return L::template permute<( n * element + component ) % L::width...>(blend_component<L, n, component>(p));
+    }
+
+    template<typename L, int n, int component, typename T, int r = ( n * ( L::width - 1 ) + component ) / L::width>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE typename L::reg gather_component( const T* p )
+    {
+        constexpr int width = L::width;
+        constexpr int mask = detail::strided_mask(width, n, component, r);
+        if constexpr ( detail::strided_disjoint(width, n) )
+            return gather_disjoint<L, n, component>(p, std::make_integer_sequence<int, width>{});
+        else if constexpr ( r == component / width )
+            return strided_permute<L, n, component, r>(L::load(p + r * width), std::make_integer_sequence<int, width>{});
+        else if constexpr ( mask == 0 )
+            return gather_component<L, n, component, T, r - 1>(p);
+        else
+            return L::template blend<mask>(gather_component<L, n, component, T, r - 1>(p),
+                                           strided_permute<L, n, component, r>(L::load(p + r * width), std::make_integer_sequence<int, width>{}));
+    }
+
+    // Sets out[c] to component c of width elements of n scalars for each listed component. Registers
+    // are loaded again for each component rather than held, which keeps AVX2 from spilling them.
+    template<typename L, int n, typename T, int... component>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE void load_strided( const T* p, typename L::reg* out, std::integer_sequence<int, component...> )
+    {
+        ( ( out[component] = gather_component<L, n, component>(p) ), ... );
+    }
+
+    // Component permuted so each lane holds the element stored there, r is any register when disjoint
+    template<typename L, int n, int component, int r, int... lane>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE typename L::reg scatter_permute( typename L::reg v, std::integer_sequence<int, lane...> )
+    {
+        if constexpr ( detail::strided_disjoint(L::width, n) )
+            return L::template permute<detail::scatter_element(L::width, n, component, lane)...>(v);
+        else
+            return L::template permute<detail::scatter_source(L::width, n, component, r, lane)...>(v);
+    }
+
+    // Stored register r from the component registers, lanes of components not set in written keep base
+    template<typename L, int n, int written, int r, int component = n - 1>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE typename L::reg scatter_register( const typename L::reg* components, typename L::reg base )
+    {
+        constexpr int mask = ( written >> component & 1 ) ? detail::scatter_mask(L::width, n, component, r) : 0;
+        typename L::reg rest = base;
+        if constexpr ( component > 0 )
+            rest = scatter_register<L, n, written, r, component - 1>(components, base);
+
+        if constexpr ( mask == 0 )
+            return rest;
+        else if constexpr ( detail::strided_disjoint(L::width, n) )
+            return L::template blend<mask>(rest, components[component]);
+        else
+            return L::template blend<mask>(rest, scatter_permute<L, n, component, r>(components[component], std::make_integer_sequence<int, L::width>{}));
+    }
+
+    // Stores width elements of n scalars, only the components set in written are changed
+    template<typename L, int n, int written, typename T, int... r>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE void store_strided( T* p, const typename L::reg* components, std::integer_sequence<int, r...> )
+    {
+        constexpr bool all = written == ( 1 << n ) - 1;
+        if constexpr ( detail::strided_disjoint(L::width, n) )
+        {
+            // every register takes the same permutation of a component, do it once
+            typename L::reg permuted[n];
+            for ( int c = 0; c < n; c++ )
+                permuted[c] = components[c];
+            ( ( permuted[r] = ( written >> r & 1 ) ? scatter_permute<L, n, r, 0>(components[r], std::make_integer_sequence<int, L::width>{}) : components[r] ), ... );
+            ( L::store(p + r * L::width, scatter_register<L, n, written, r>(permuted, all ? permuted[0] : L::load(p + r * L::width))), ... );
+        }
+        else
+        {
+            ( L::store(p + r * L::width, scatter_register<L, n, written, r>(components, all ? components[0] : L::load(p + r * L::width))), ... );
+        }
+    }
+
+    // Scalars of the upper 3x3 of a row major n x n matrix, and the same as a mask
+    template<int n>
+    using rotation_components = std::integer_sequence<int, 0, 1, 2, n, n + 1, n + 2, 2 * n, 2 * n + 1, 2 * n + 2>;
+
+    template<int n>
+    inline constexpr int rotation_mask = 0b111 | 0b111 << n | 0b111 << ( 2 * n );
+
+    // Matrices are row major n x n and only their upper 3x3 is read or written, so 4x4 matrices keep their
+    // translation. Registers are transposed with blends and permutes as for x,y,z above.
+    template<int n, typename T>
+    SQUIGGLE_KERNEL_TARGET void quat_to_mat( const T* quaternions, T* matrices, std::size_t count )
+    {
+        using L = lanes<T>;
+        using S = sqg::dispatch::scalar::lanes<T>;
+        using reg = typename L::reg;
+        constexpr std::size_t width = L::width;
+
+        std::size_t i = 0;
+        for ( ; i + width <= count; i += width )
+        {
+            reg q[4];
+            load_strided<L, 4>(quaternions + i * 4, q, std::make_integer_sequence<int, 4>{});
+
+            reg m[9];
+            quat_matrix<L,T>(q, m);
+
+            reg out[n * n];
+            for ( int row = 0; row < 3; row++ )
+            {
+                for ( int col = 0; col < 3; col++ )
+                    out[row * n + col] = m[row * 3 + col];
+            }
+            store_strided<L, n * n, rotation_mask<n>>(matrices + i * n * n, out, std::make_integer_sequence<int, n * n>{});
+        }
+
+        for ( ; i < count; i++ )
+        {
+            T m[9];
+            quat_matrix<S,T>(quaternions + i * 4, m);
+            T* matrix = matrices + i * n * n;
+            for ( int row = 0; row < 3; row++ )
+            {
+                for ( int col = 0; col < 3; col++ )
+                    matrix[row * n + col] = m[row * 3 + col];
+            }
+        }
+    }
+
+    template<int n, typename T>
+    SQUIGGLE_KERNEL_TARGET void mat_to_quat( const T* matrices, T* quaternions, std::size_t count )
+    {
+        using L = lanes<T>;
+        using S = sqg::dispatch::scalar::lanes<T>;
+        using reg = typename L::reg;
+        constexpr std::size_t width = L::width;
+
+        std::size_t i = 0;
+        for ( ; i + width <= count; i += width )
+        {
+            reg in[n * n];
+            load_strided<L, n * n>(matrices + i * n * n, in, rotation_components<n>{});
+
+            reg m[9];
+            for ( int row = 0; row < 3; row++ )
+            {
+                for ( int col = 0; col < 3; col++ )
+                    m[row * 3 + col] = in[row * n + col];
+            }
+
+            reg q[4];
+            matrix_quat<L,T>(m, q);
+            store_strided<L, 4, 0b1111>(quaternions + i * 4, q, std::make_integer_sequence<int, 4>{});
+        }
+
+        for ( ; i < count; i++ )
+        {
+            const T* matrix = matrices + i * n * n;
+            T m[9];
+            for ( int row = 0; row < 3; row++ )
+            {
+                for ( int col = 0; col < 3; col++ )
+                    m[row * 3 + col] = matrix[row * n + col];
+            }
+            matrix_quat<S,T>(m, quaternions + i * 4);
+        }
+    }
+
+    // Dual quaternions are 8 scalars, the real part w,x,y,z then the dual part w,x,y,z. Each is transposed
+    // into one register per scalar so a lane holds a whole dual quaternion and nothing is shuffled.
+
+    // Same evaluation order as the quaternion product in sqg_quat.h, a quaternion is four registers w, x, y, z
+    template<typename L>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE void quat_components_product( const typename L::reg* a, const typename L::reg* b, typename L::reg* out )
+    {
+        out[0] = L::sub(L::sub(L::sub(L::mul(a[0], b[0]), L::mul(a[1], b[1])), L::mul(a[2], b[2])), L::mul(a[3], b[3]));
+        out[1] = L::sub(L::add(L::add(L::mul(a[0], b[1]), L::mul(a[1], b[0])), L::mul(a[2], b[3])), L::mul(a[3], b[2]));
+        out[2] = L::sub(L::add(L::add(L::mul(a[0], b[2]), L::mul(a[2], b[0])), L::mul(a[3], b[1])), L::mul(a[1], b[3]));
+        out[3] = L::sub(L::add(L::add(L::mul(a[0], b[3]), L::mul(a[3], b[0])), L::mul(a[1], b[2])), L::mul(a[2], b[1]));
+    }
+
+    template<typename L>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE typename L::reg quat_components_dot( const typename L::reg* a, const typename L::reg* b )
+    {
+        return L::add(L::add(L::add(L::mul(a[0], b[0]), L::mul(a[1], b[1])), L::mul(a[2], b[2])), L::mul(a[3], b[3]));
+    }
+
+    // Same steps as the dual quaternion product in sqg_dualquat.h
+    template<typename L>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE void dualquat_product( const typename L::reg* a, const typename L::reg* b, typename L::reg* out )
+    {
+        typename L::reg rd[4], dr[4];
+        quat_components_product<L>(a, b, out);
+        quat_components_product<L>(a, b + 4, rd);
+        quat_components_product<L>(a + 4, b, dr);
+        for ( int c = 0; c < 4; c++ )
+            out[4 + c] = L::add(rd[c], dr[c]);
+    }
+
+    // Same steps as normalize in sqg_dualquat.h
+    template<typename L, typename T>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE void dualquat_normalize( typename L::reg* dq )
+    {
+        const typename L::reg inverse_length = L::div(L::set1(T{1}), L::sqrt(quat_components_dot<L>(dq, dq)));
+        for ( int c = 0; c < 8; c++ )
+            dq[c] = L::mul(dq[c], inverse_length);
+
+        const typename L::reg d = quat_components_dot<L>(dq, dq + 4);
+        for ( int c = 0; c < 4; c++ )
+            dq[4 + c] = L::sub(dq[4 + c], L::mul(dq[c], d));
+    }
+
+    // Rotation and translation as assign to a matrix in sqg_dualquat.h, m is the 3x4 matrix in row order
+    template<typename L, typename T>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE void dualquat_matrix( const typename L::reg* dq, typename L::reg* m )
+    {
+        using reg = typename L::reg;
+        reg rotation[9];
+        quat_matrix<L,T>(dq, rotation);
+        for ( int row = 0; row < 3; row++ )
+        {
+            for ( int col = 0; col < 3; col++ )
+                m[row * 4 + col] = rotation[row * 3 + col];
+        }
+
+        // t = 2 * ( d * w - v * dw + cross(v, d) ) for the vector parts v and d
+        const reg two = L::set1(T{2});
+        const reg* v = dq + 1;
+        const reg* d = dq + 5;
+        for ( int c = 0; c < 3; c++ )
+        {
+            const int c1 = ( c + 1 ) % 3;
+            const int c2 = ( c + 2 ) % 3;
+            const reg cross = L::sub(L::mul(v[c1], d[c2]), L::mul(v[c2], d[c1]));
+            m[c * 4 + 3] = L::mul(L::add(L::sub(L::mul(d[c], dq[0]), L::mul(v[c], dq[4])), cross), two);
+        }
+    }
+
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void compose_dualquats( const T* a, const T* b, T* out, std::size_t count )
+    {
+        using L = lanes<T>;
+        using S = sqg::dispatch::scalar::lanes<T>;
+        using reg = typename L::reg;
+        constexpr std::size_t width = L::width;
+        constexpr auto components = std::make_integer_sequence<int, 8>{};
+
+        std::size_t i = 0;
+        for ( ; i + width <= count; i += width )
+        {
+            reg ra[8], rb[8], r[8];
+            load_strided<L, 8>(a + i * 8, ra, components);
+            load_strided<L, 8>(b + i * 8, rb, components);
+            dualquat_product<L>(ra, rb, r);
+            store_strided<L, 8, 0xFF>(out + i * 8, r, components);
+        }
+
+        for ( ; i < count; i++ )
+        {
+            T r[8];
+            dualquat_product<S>(a + i * 8, b + i * 8, r);
+            for ( int c = 0; c < 8; c++ )
+                out[i * 8 + c] = r[c];
+        }
+    }
+
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void normalize_dualquats( const T* in, T* out, std::size_t count )
+    {
+        using L = lanes<T>;
+        using S = sqg::dispatch::scalar::lanes<T>;
+        using reg = typename L::reg;
+        constexpr std::size_t width = L::width;
+        constexpr auto components = std::make_integer_sequence<int, 8>{};
+
+        std::size_t i = 0;
+        for ( ; i + width <= count; i += width )
+        {
+            reg dq[8];
+            load_strided<L, 8>(in + i * 8, dq, components);
+            dualquat_normalize<L,T>(dq);
+            store_strided<L, 8, 0xFF>(out + i * 8, dq, components);
+        }
+
+        for ( ; i < count; i++ )
+        {
+            T dq[8];
+            for ( int c = 0; c < 8; c++ )
+                dq[c] = in[i * 8 + c];
+            dualquat_normalize<S,T>(dq);
+            for ( int c = 0; c < 8; c++ )
+                out[i * 8 + c] = dq[c];
+        }
+    }
+
+    // out = normalized(a * (1 - t) + b * +-t), b's sign flipped where the real parts are more than 90 degrees apart
+    template<typename L, typename T>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE void dualquat_blend( const typename L::reg* a, const typename L::reg* b, T t, typename L::reg* out )
+    {
+        using reg = typename L::reg;
+        const reg zero = L::set1(T{0});
+        const reg ta = L::set1(T{1} - t);
+        const reg tb = L::select_ge(quat_components_dot<L>(a, b), zero, L::set1(t), L::set1(-t));
+        for ( int c = 0; c < 8; c++ )
+            out[c] = L::add(L::mul(a[c], ta), L::mul(b[c], tb));
+        dualquat_normalize<L,T>(out);
+    }
+
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void blend_dualquats( const T* a, const T* b, T t, T* out, std::size_t count )
+    {
+        using L = lanes<T>;
+        using S = sqg::dispatch::scalar::lanes<T>;
+        using reg = typename L::reg;
+        constexpr std::size_t width = L::width;
+        constexpr auto components = std::make_integer_sequence<int, 8>{};
+
+        std::size_t i = 0;
+        for ( ; i + width <= count; i += width )
+        {
+            reg ra[8], rb[8], r[8];
+            load_strided<L, 8>(a + i * 8, ra, components);
+            load_strided<L, 8>(b + i * 8, rb, components);
+            dualquat_blend<L,T>(ra, rb, t, r);
+            store_strided<L, 8, 0xFF>(out + i * 8, r, components);
+        }
+
+        for ( ; i < count; i++ )
+        {
+            T r[8];
+            dualquat_blend<S,T>(a + i * 8, b + i * 8, t, r);
+            for ( int c = 0; c < 8; c++ )
+                out[i * 8 + c] = r[c];
+        }
+    }
+
+    // Matrices are row major 3x4 or 4x4 and every element is written, the last row of a 4x4 is 0 0 0 1
+    template<int rows, typename T>
+    SQUIGGLE_KERNEL_TARGET void dualquat_to_mat( const T* dualquats, T* matrices, std::size_t count )
+    {
+        using L = lanes<T>;
+        using S = sqg::dispatch::scalar::lanes<T>;
+        using reg = typename L::reg;
+        constexpr std::size_t width = L::width;
+        constexpr int n = rows * 4;
+
+        std::size_t i = 0;
+        for ( ; i + width <= count; i += width )
+        {
+            reg dq[8];
+            load_strided<L, 8>(dualquats + i * 8, dq, std::make_integer_sequence<int, 8>{});
+
+            reg m[16];
+            dualquat_matrix<L,T>(dq, m);
+            if constexpr ( rows == 4 )
+            {
+                m[12] = m[13] = m[14] = L::set1(T{0});
+                m[15] = L::set1(T{1});
+            }
+            store_strided<L, n, ( 1 << n ) - 1>(matrices + i * n, m, std::make_integer_sequence<int, n>{});
+        }
+
+        for ( ; i < count; i++ )
+        {
+            T* matrix = matrices + i * n;
+            dualquat_matrix<S,T>(dualquats + i * 8, matrix);
+            if constexpr ( rows == 4 )
+            {
+                matrix[12] = matrix[13] = matrix[14] = T{0};
+                matrix[15] = T{1};
+            }
+        }
+    }
+
+    // Weighted sum of the top three rows of each lane's bones, m is the blended 3x4 in row order. Each
+    // element is gathered straight from the bones, copying them through a transposed buffer stalls on
+    // store forwarding and is no faster than one vertex at a time.
+    template<int rows, typename L, typename T>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE void blend_bones( const T* bones, const std::uint32_t* indices, const T* weights, std::size_t influences, std::size_t stride, typename L::reg* m )
+    {
+        for ( int e = 0; e < 12; e++ )
+            m[e] = L::set1(T{0});
+
+        for ( std::size_t k = 0; k < influences; k++ )
+        {
+            const typename L::reg weight = L::load(weights + k * stride);
+            if constexpr ( L::width == 1 )
+            {
+                // one vertex at a time the unused influences are skipped
+                if ( weight == T{0} )
+                    continue;
+                const T* bone = bones + rows * 4 * std::size_t{ indices[k * stride] };
+                for ( int e = 0; e < 12; e++ )
+                    m[e] = L::fmadd(weight, bone[e], m[e]);
+            }
+            else
+            {
+                const typename L::index bone = L::load_index(indices + k * stride, rows * 4);
+                for ( int e = 0; e < 12; e++ )
+                    m[e] = L::fmadd(weight, L::gather(bones + e, bone), m[e]);
+            }
+        }
+    }
+
+    // Vertices i to i + width - 1, same evaluation order as skin_vertices in sqg_skin.h
+    template<int rows, typename L, typename T>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE void skin_lanes( const T* bones, const std::uint32_t* indices, const T* weights, std::size_t influences, std::size_t stride,
+                                                            const T* const* in, T* const* out, std::size_t i )
+    {
+        using reg = typename L::reg;
+        reg m[12];
+        blend_bones<rows, L>(bones, indices + i, weights + i, influences, stride, m);
+
+        const reg px = L::load(in[0] + i);
+        const reg py = L::load(in[1] + i);
+        const reg pz = L::load(in[2] + i);
+        L::store(out[0] + i, L::add(L::fmadd(m[2], pz, L::fmadd(m[1], py, L::mul(m[0], px))), m[3]));
+        L::store(out[1] + i, L::add(L::fmadd(m[6], pz, L::fmadd(m[5], py, L::mul(m[4], px))), m[7]));
+        L::store(out[2] + i, L::add(L::fmadd(m[10], pz, L::fmadd(m[9], py, L::mul(m[8], px))), m[11]));
+
+        if ( in[3] )
+        {
+            const reg nx = L::load(in[3] + i);
+            const reg ny = L::load(in[4] + i);
+            const reg nz = L::load(in[5] + i);
+            const reg x = L::fmadd(m[2], nz, L::fmadd(m[1], ny, L::mul(m[0], nx)));
+            const reg y = L::fmadd(m[6], nz, L::fmadd(m[5], ny, L::mul(m[4], nx)));
+            const reg z = L::fmadd(m[10], nz, L::fmadd(m[9], ny, L::mul(m[8], nx)));
+            const reg inverse_length = L::div(L::set1(T{1}), L::sqrt(L::add(L::add(L::mul(x, x), L::mul(y, y)), L::mul(z, z))));
+            L::store(out[3] + i, L::mul(x, inverse_length));
+            L::store(out[4] + i, L::mul(y, inverse_length));
+            L::store(out[5] + i, L::mul(z, inverse_length));
+        }
+    }
+
+    // Each lane skins its own vertex, the positions and normals are already one component per array.
+    // Levels without a gather skin one vertex at a time.
+    template<int rows, typename T>
+    SQUIGGLE_KERNEL_TARGET void skin_vertices( const T* bones, const std::uint32_t* indices, const T* weights, std::size_t influences, std::size_t stride,
+                                               const T* const* in, T* const* out, std::size_t count )
+    {
+        using S = sqg::dispatch::scalar::lanes<T>;
+        using L = std::conditional_t<lanes<T>::has_gather, lanes<T>, S>;
+        constexpr std::size_t width = L::width;
+
+        std::size_t i = 0;
+        for ( ; i + width <= count; i += width )
+            skin_lanes<rows, L>(bones, indices, weights, influences, stride, in, out, i);
+
+        for ( ; i < count; i++ )
+            skin_lanes<rows, S>(bones, indices, weights, influences, stride, in, out, i);
+    }
+
+    // One term of register q of a 4x4 product, see detail::product_left_element
+    template<typename L, int q, int k, int... lane>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE typename L::reg product_left( const typename L::reg* a, std::integer_sequence<int, lane...> )
+    {
+        constexpr int width = L::width;
+        const auto v = a[detail::product_left_element(width, q, k, 0) / width];
+        if constexpr ( ( ( detail::product_left_element(width, q, k, lane) % width == lane ) && ... ) )
+            return v;
+        else
+            return L::template permute<( detail::product_left_element(width, q, k, lane) % width )...>(v);
+    }
+
+    template<typename L, int q, int k, int... lane>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE typename L::reg product_right( const typename L::reg* b, std::integer_sequence<int, lane...> )
+    {
+        constexpr int width = L::width;
+        const auto v = b[detail::product_right_element(width, q, k, 0) / width];
+        if constexpr ( ( ( detail::product_right_element(width, q, k, lane) % width == lane ) && ... ) )
+            return v;
+        else
+            return L::template permute<( detail::product_right_element(width, q, k, lane) % width )...>(v);
+    }
+
+    template<typename L, int... q>
+    SQUIGGLE_KERNEL_TARGET SQUIGGLE_INLINE void mat44_product( const typename L::reg* a, const typename L::reg* b, typename L::reg* out, std::integer_sequence<int, q...> )
+    {
+        constexpr auto lane_sequence = std::make_integer_sequence<int, L::width>{};
+        ( ( out[q] = L::fmadd(product_left<L, q, 3>(a, lane_sequence), product_right<L, q, 3>(b, lane_sequence),
+                     L::fmadd(product_left<L, q, 2>(a, lane_sequence), product_right<L, q, 2>(b, lane_sequence),
+                     L::fmadd(product_left<L, q, 1>(a, lane_sequence), product_right<L, q, 1>(b, lane_sequence),
+                              L::mul(product_left<L, q, 0>(a, lane_sequence), product_right<L, q, 0>(b, lane_sequence))))) ), ... );
+    }
+
+    // world[node] = world[parents[node]] * local[node] for each listed node, row major 4x4 matrices.
+    // No listed node may be the parent of another, as for the nodes of one level of a hierarchy.
+    template<typename T>
+    SQUIGGLE_KERNEL_TARGET void multiply_parents( T* world, const T* local, const std::uint32_t* parents, const std::uint32_t* nodes, std::size_t count )
+    {
+        using L = lanes<T>;
+        using reg = typename L::reg;
+        constexpr int registers = 16 / L::width;
+        static_assert( registers * L::width == 16 );
+
+        for ( std::size_t i = 0; i < count; i++ )
+        {
+            const std::size_t node = nodes[i];
+            const T* a = world + 16 * std::size_t{ parents[node] };
+            const T* b = local + 16 * node;
+
+            reg ra[registers], rb[registers], r[registers];
+            for ( int q = 0; q < registers; q++ )
+            {
+                ra[q] = L::load(a + q * L::width);
+                rb[q] = L::load(b + q * L::width);
+            }
+            mat44_product<L>(ra, rb, r, std::make_integer_sequence<int, registers>{});
+
+            T* out = world + 16 * node;
+            for ( int q = 0; q < registers; q++ )
+                L::store(out + q * L::width, r[q]);
+        }
+    }
+
+    template<typename T>
+    inline constexpr kernel_table<T> table = {
+        &transform_points<T>, &transform_dirs<T>, &transform_soa<T>, &normalize<T>,
+        &mag2<T>, &mag<T>, &dot<T>, { &sum<2,T>, &sum<3,T>, &sum<4,T> },
+        &compose_aos<T>, &premultiply_aos<T>, &compose_soa<T>, &premultiply_soa<T>, &compose_blocks<T>, &premultiply_blocks<T>,
+        { &quat_to_mat<3,T>, &quat_to_mat<4,T> }, { &mat_to_quat<3,T>, &mat_to_quat<4,T> }, &multiply_parents<T>,
+        { &normalize_fast<0,T>, &normalize_fast<1,T>, &normalize_fast<2,T>, &normalize_fast<3,T> },
+        { &normalize4_fast<0,T>, &normalize4_fast<1,T>, &normalize4_fast<2,T>, &normalize4_fast<3,T> },
+        &compose_dualquats<T>, &normalize_dualquats<T>, &blend_dualquats<T>, { &dualquat_to_mat<3,T>, &dualquat_to_mat<4,T> },
+        { &skin_vertices<3,T>, &skin_vertices<4,T> },
+    };
+}
@@ -0,0 +1,323 @@
+#pragma once
+#include "sqg_concepts.h"
+#include "sqg_mat_view.h"
+#include "sqg_mat34.h"
+#include "sqg_mat44.h"
+#include "sqg_quat.h"
+#include "sqg_quat_mat.h"
+#include "sqg_scalar.h"
+#include "sqg_struct.h"
+#include "sqg_traits.h"
+#include "sqg_vec3.h"
+#include "sqg_vec4.h"
+#include <cassert>
+#include <concepts>
+#include <limits>
+#include <span>
+
+// Dual quaternions real + eps dual. A unit dual quaternion is a rigid transform, the real part is its rotation
+// and the dual part is 0.5 * t * real for its translation t. They compose in the same order as the matrices
+// they convert to, a * b applies b first, and blend without the shrinking of a weighted sum of matrices.
+
+namespace sqg
+{
+    template<concepts::dualquat_type D1, concepts::read_dualquat_type D2>
+    SQUIGGLE_INLINE constexpr void assign( D1& destination, const D2& source )
+    {
+        static_assert( std::convertible_to<dualquat_scalar<D2>, dualquat_scalar<D1>>, "Source Scalar must be convertible to Destination Scalar" );
+        assign(real(destination), real(source));
+        assign(dual(destination), dual(source));
+    }
+
+    template<concepts::dualquat_type D>
+    SQUIGGLE_INLINE constexpr void set_identity( D& dq )
+    {
+        using scalar = dualquat_scalar<D>;
+        set_identity(real(dq));
+        W(dual(dq), scalar{0}); X(dual(dq), scalar{0}); Y(dual(dq), scalar{0}); Z(dual(dq), scalar{0});
+    }
+
+    // Rotation then translation, rotation is expected to be normalised
+    template<concepts::dualquat_type D, concepts::read_quat_type Q, concepts::read_vec3_type V>
+    SQUIGGLE_INLINE constexpr void set_rigid( D& dq, const Q& rotation, const V& translation )
+    {
+        static_assert( std::same_as<vec_scalar<Q>, vec_scalar<V>>, "Scalar type must match for this operation" );
+        using scalar = dualquat_scalar<D>;
+        constexpr scalar half{0.5};
+
+        const scalar w = W(rotation);
+        const scalar x = X(rotation);
+        const scalar y = Y(rotation);
+        const scalar z = Z(rotation);
+        const scalar tx = X(translation);
+        const scalar ty = Y(translation);
+        const scalar tz = Z(translation);
+
+        // dual = 0.5 * (0, t) * rotation
+        assign(real(dq), rotation);
+        W(dual(dq), -half * ( tx * x + ty * y + tz * z ));
+        X(dual(dq), half * ( tx * w + ty * z - tz * y ));
+        Y(dual(dq), half * ( ty * w + tz * x - tx * z ));
+        Z(dual(dq), half * ( tz * w + tx * y - ty * x ));
+    }
+
+    template<concepts::read_quat_type Q, concepts::read_vec3_type V>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr dualquat<vec_scalar<Q>> rigid_dualquat( const Q& rotation, const V& translation )
+    {
+        dualquat<vec_scalar<Q>> dq;
+        set_rigid(dq, rotation, translation);
+        return dq;
+    }
+
+    template<concepts::real_scalar T>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr dualquat<T> identity_dualquat()
+    {
+        return {};
+    }
+
+    template<concepts::read_dualquat_type D>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr quat<dualquat_scalar<D>> rotation( const D& dq )
+    {
+        quat<dualquat_scalar<D>> q;
+        assign(q, real(dq));
+        return q;
+    }
+
+    // t = 2 * dual * conjugate(real), of which only the vector part is computed
+    template<concepts::read_dualquat_type D>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec3<dualquat_scalar<D>> translation( const D& dq )
+    {
+        using scalar = dualquat_scalar<D>;
+        const vec3<scalar> v = V(real(dq));
+        const vec3<scalar> d = V(dual(dq));
+        const vec3<scalar> t = d * W(real(dq)) - v * W(dual(dq)) + cross(v, d);
+        return t * scalar{2};
+    }
+
+    // a * b applies b and then a
+    template<concepts::read_dualquat_type D1, concepts::read_dualquat_type D2>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr dualquat_value<D1> operator*( const D1& a, const D2& b )
+    {
+        static_assert( std::same_as<dualquat_scalar<D1>, dualquat_scalar<D2>>, "Scalar type must match for this operation" );
+        dualquat_value<D1> dq;
+        assign(real(dq), real(a) * real(b));
+        assign(dual(dq), real(a) * dual(b) + dual(a) * real(b));
+        return dq;
+    }
+
+    template<concepts::read_dualquat_type D1, concepts::read_dualquat_type D2>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr dualquat_value<D1> operator+( const D1& a, const D2& b )
+    {
+        static_assert( std::same_as<dualquat_scalar<D1>, dualquat_scalar<D2>>, "Scalar type must match for this operation" );
+        dualquat_value<D1> dq;
+        assign(real(dq), real(a) + real(b));
+        assign(dual(dq), dual(a) + dual(b));
+        return dq;
+    }
+
+    template<concepts::read_dualquat_type D>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr dualquat_value<D> operator-( const D& a )
+    {
+        dualquat_value<D> dq;
+        assign(real(dq), -real(a));
+        assign(dual(dq), -dual(a));
+        return dq;
+    }
+
+    template<concepts::read_dualquat_type D>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr dualquat_value<D> operator*( const D& a, dualquat_scalar<D> s )
+    {
+        dualquat_value<D> dq;
+        assign(real(dq), real(a) * s);
+        assign(dual(dq), dual(a) * s);
+        return dq;
+    }
+
+    template<concepts::read_dualquat_type D>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr dualquat_value<D> operator*( dualquat_scalar<D> s, const D& a )
+    {
+        return a * s;
+    }
+
+    template<concepts::read_dualquat_type D1, concepts::read_dualquat_type D2>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr bool operator==( const D1& a, const D2& b )
+    {
+        return real(a) == real(b) && dual(a) == dual(b);
+    }
+
+    template<concepts::read_dualquat_type D1, concepts::read_dualquat_type D2>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr bool operator!=( const D1& a, const D2& b )
+    {
+        return !( a == b );
+    }
+
+    // Conjugates both parts, the inverse of a unit dual quaternion
+    template<concepts::read_dualquat_type D>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr dualquat_value<D> conjugate( const D& dq )
+    {
+        dualquat_value<D> c;
+        assign(real(c), conjugate(real(dq)));
+        assign(dual(c), conjugate(dual(dq)));
+        return c;
+    }
+
+    // dq is expected to be normalised
+    template<concepts::read_dualquat_type D>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr dualquat_value<D> inverse( const D& dq )
+    {
+        return conjugate(dq);
+    }
+
+    // Unit length real part, and the dual part made orthogonal to it so the result is a rigid transform
+    template<concepts::dualquat_type D>
+    SQUIGGLE_INLINE constexpr void normalize( D& dq )
+    {
+        using scalar = dualquat_scalar<D>;
+        const scalar inverse_length = scalar{1} / mag(real(dq));
+        real(dq) *= inverse_length;
+        dual(dq) *= inverse_length;
+        dual(dq) -= real(dq) * dot(real(dq), dual(dq));
+    }
+
+    template<concepts::read_dualquat_type D>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr dualquat_value<D> normalized( const D& dq )
+    {
+        dualquat_value<D> n;
+        assign(n, dq);
+        normalize(n);
+        return n;
+    }
+
+    // dq is expected to be normalised
+    template<concepts::read_dualquat_type D, concepts::read_vec3_type V>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> transform_point( const D& dq, const V& point )
+    {
+        static_assert( std::same_as<dualquat_scalar<D>, vec_scalar<V>>, "Scalar type must match for this operation" );
+        const quat<vec_scalar<V>> r = rotation(dq);
+        return r * point + translation(dq);
+    }
+
+    // Rotation only, for directions and normals
+    template<concepts::read_dualquat_type D, concepts::read_vec3_type V>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> transform_dir( const D& dq, const V& direction )
+    {
+        static_assert( std::same_as<dualquat_scalar<D>, vec_scalar<V>>, "Scalar type must match for this operation" );
+        const quat<vec_scalar<V>> r = rotation(dq);
+        return r * direction;
+    }
+
+    template<concepts::read_dualquat_type D, concepts::read_vec3_type V>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> operator*( const D& dq, const V& point )
+    {
+        return transform_point(dq, point);
+    }
+
+    // Rigid transform matrix of a dual quaternion, dq is expected to be normalised. The last row of a 4x4 is set to 0 0 0 1.
+    template<concepts::affine_type M, concepts::read_dualquat_type D>
+    SQUIGGLE_INLINE constexpr void assign( M& matrix, const D& dq )
+    {
+        using scalar = detail::affine_traits<M>::scalar_type;
+        static_assert( std::convertible_to<dualquat_scalar<D>, scalar>, "Source Scalar must be convertible to Destination Scalar" );
+
+        orientation(matrix) = real(dq);
+        position(matrix) = translation(dq);
+        if constexpr ( concepts::mat44_type<M> )
+        {
+            A30(matrix, scalar{0}); A31(matrix, scalar{0}); A32(matrix, scalar{0}); A33(matrix, scalar{1});
+        }
+    }
+
+    // Dual quaternion of a rigid transform matrix, its orientation is expected to be orthonormal with determinant 1
+    template<concepts::dualquat_type D, concepts::read_affine_type M>
+    SQUIGGLE_INLINE constexpr void assign( D& dq, const M& matrix )
+    {
+        using scalar = dualquat_scalar<D>;
+        static_assert( std::convertible_to<typename detail::affine_traits<M>::scalar_type, scalar>, "Source Scalar must be convertible to Destination Scalar" );
+
+        quat<scalar> r;
+        assign(r, orientation(matrix));
+        set_rigid(dq, r, convert_to<vec3<scalar>>(position(matrix)));
+    }
+}
+
+namespace sqg::detail
+{
+    // dq^t of a unit dual quaternion from its screw, a rotation about a line and a translation along it which
+    // both scale with t. Below the angle at which the line can be found the rotation and translation scale separately.
+    template<concepts::read_dualquat_type D>
+    SQUIGGLE_INLINE dualquat_value<D> screw_power( const D& dq, dualquat_scalar<D> t )
+    {
+        using scalar = dualquat_scalar<D>;
+        constexpr scalar half{0.5};
+
+        const quat<scalar> r = rotation(dq);
+        const vec3<scalar> v = V(r);
+        const scalar s = mag(v);
+
+        dualquat_value<D> q;
+        if ( s < math::sqrt(std::numeric_limits<scalar>::epsilon()) )
+        {
+            const quat<scalar> scaled{ W(r), X(v) * t, Y(v) * t, Z(v) * t };
+            set_rigid(q, normalized(scaled), translation(dq) * t);
+            return q;
+        }
+
+        // angle = 2 * half_angle about axis, moving by pitch along it, through the point whose moment is moment
+        const scalar inverse_s = scalar{1} / s;
+        const vec3<scalar> axis = v * inverse_s;
+        const scalar pitch = scalar{-2} * W(dual(dq)) * inverse_s;
+        const vec3<scalar> moment = ( V(dual(dq)) - axis * ( half * pitch * W(r) ) ) * inverse_s;
+
+        const auto [sin_half, cos_half] = math::sincos(math::atan2(s, W(r)) * t);
+        const scalar half_pitch = half * pitch * t;
+        const vec3<scalar> dual_v = moment * sin_half + axis * ( half_pitch * cos_half );
+
+        W(real(q), cos_half); X(real(q), X(axis) * sin_half); Y(real(q), Y(axis) * sin_half); Z(real(q), Z(axis) * sin_half);
+        W(dual(q), -half_pitch * sin_half); X(dual(q), X(dual_v)); Y(dual(q), Y(dual_v)); Z(dual(q), Z(dual_v));
+        return q;
+    }
+}
+
+namespace sqg
+{
+    // Screw linear interpolation, a constant speed rotation and translation along the screw from a to b.
+    // a and b are expected to be normalised, t = 0 gives a and t = 1 gives b or -b, the same transform.
+    template<concepts::read_dualquat_type D1, concepts::read_dualquat_type D2>
+    [[nodiscard]] SQUIGGLE_INLINE dualquat_value<D1> sclerp( const D1& a, const D2& b, dualquat_scalar<D1> t )
+    {
+        static_assert( std::same_as<dualquat_scalar<D1>, dualquat_scalar<D2>>, "Scalar type must match for this operation" );
+        dualquat_value<D1> difference = conjugate(a) * b;
+        // dq and -dq are the same transform, take the shorter way round
+        if ( W(real(difference)) < dualquat_scalar<D1>{0} )
+            difference = -difference;
+        return a * detail::screw_power(difference, t);
+    }
+
+    // Dual quaternion linear blending, the normalised weighted sum. Cheaper than sclerp and close to it,
+    // b is negated when it is on the other side of a so the blend takes the shorter way round.
+    template<concepts::read_dualquat_type D1, concepts::read_dualquat_type D2>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr dualquat_value<D1> dlb( const D1& a, const D2& b, dualquat_scalar<D1> t )
+    {
+        static_assert( std::same_as<dualquat_scalar<D1>, dualquat_scalar<D2>>, "Scalar type must match for this operation" );
+        using scalar = dualquat_scalar<D1>;
+        const scalar tb = dot(real(a), real(b)) < scalar{0} ? -t : t;
+        return normalized(a * ( scalar{1} - t ) + b * tb);
+    }
+
+    // Weighted blend of several, as for skinning. Signs are taken relative to the first, weights need not sum to 1.
+    template<concepts::read_dualquat_type D>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr dualquat_value<D> dlb( std::span<const D> dualquats, std::span<const dualquat_scalar<D>> weights )
+    {
+        using scalar = dualquat_scalar<D>;
+        assert( !dualquats.empty() && dualquats.size() == weights.size() );
+
+        dualquat_value<D> sum = dualquats[0] * weights[0];
+        for ( std::size_t i = 1; i < dualquats.size(); i++ )
+        {
+            const scalar weight = dot(real(dualquats[0]), real(dualquats[i])) < scalar{0} ? -weights[i] : weights[i];
+            sum = sum + dualquats[i] * weight;
+        }
+        normalize(sum);
+        return sum;
+    }
+}
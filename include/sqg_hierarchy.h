@@ -0,0 +1,332 @@
+#pragma once
+#include "sqg_concepts.h"
+#include "sqg_dispatch.h"
+#include "sqg_mat.h"
+#include "sqg_mat44.h"
+#include "sqg_mat_view.h"
+#include "sqg_parallel.h"
+#include "sqg_quat_mat.h"
+#include "sqg_struct.h"
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace sqg
+{
+    // Local and world 4x4 transforms of a tree of nodes, world = world of parent * local.
+    // Nodes are given by their parent indices in topological order, each parent before its children, and are
+    // grouped by depth into levels. update computes the worlds a level at a time, no node of a level depends on
+    // another so each level is one multiply_parents kernel call, split into tiles across threads when it is wide.
+    // update_dirty only recomputes the subtrees under nodes marked dirty since the last update, and changed lists
+    // the nodes whose world was written so callers can process just the deltas.
+    template<typename T>
+    class transform_hierarchy
+    {
+    public:
+        static_assert( std::same_as<T,float> || std::same_as<T,double>, "transform_hierarchy is only available for float and double" );
+        static_assert( sizeof(mat44<T>) == 16 * sizeof(T), "mat44 must be packed for the batch kernels" );
+
+        using scalar_type = T;
+        using matrix_type = mat44<T>;
+        using size_type = std::size_t;
+
+        static constexpr std::uint32_t no_parent = std::numeric_limits<std::uint32_t>::max();
+
+        transform_hierarchy() = default;
+
+        // parents[i] is the parent of node i, or no_parent for a root, and must be less than i.
+        // Local and world transforms start as identity.
+        explicit transform_hierarchy( std::span<const std::uint32_t> parents )
+            : parents_(parents.begin(), parents.end()), depth_(parents.size()), local_(parents.size(), identity_mat<T,4>()), world_(parents.size(), identity_mat<T,4>()),
+              dirty_(parents.size(), 0), visited_(parents.size(), 0)
+        {
+            // depth of every node, then the nodes sorted by depth with a counting sort
+            std::uint32_t deepest = 0;
+            for ( size_type node = 0; node < parents_.size(); node++ )
+            {
+                const std::uint32_t parent = parents_[node];
+                assert(parent == no_parent || parent < node);
+                depth_[node] = parent == no_parent ? 0 : depth_[parent] + 1;
+                deepest = std::max(deepest, depth_[node]);
+            }
+
+            offsets_.assign(parents_.empty() ? 1 : deepest + 2, 0);
+            for ( std::uint32_t d : depth_ )
+                offsets_[d + 1]++;
+            for ( size_type l = 1; l < offsets_.size(); l++ )
+                offsets_[l] += offsets_[l - 1];
+
+            order_.resize(parents_.size());
+            std::vector<size_type> next(offsets_.begin(), offsets_.end() - 1);
+            for ( size_type node = 0; node < parents_.size(); node++ )
+                order_[next[depth_[node]]++] = static_cast<std::uint32_t>(node);
+
+            // children of every node, the same counting sort by parent
+            child_offsets_.assign(parents_.size() + 1, 0);
+            for ( std::uint32_t parent : parents_ )
+            {
+                if ( parent != no_parent )
+                    child_offsets_[parent + 1]++;
+            }
+            for ( size_type node = 1; node < child_offsets_.size(); node++ )
+                child_offsets_[node] += child_offsets_[node - 1];
+
+            children_.resize(child_offsets_.back());
+            next.assign(child_offsets_.begin(), child_offsets_.end() - 1);
+            for ( size_type node = 0; node < parents_.size(); node++ )
+            {
+                if ( parents_[node] != no_parent )
+                    children_[next[parents_[node]]++] = static_cast<std::uint32_t>(node);
+            }
+
+            // nodes under every node including itself
+            subtree_size_.assign(parents_.size(), 1);
+            for ( size_type node = parents_.size(); node-- > 0; )
+            {
+                if ( parents_[node] != no_parent )
+                    subtree_size_[parents_[node]] += subtree_size_[node];
+            }
+
+            changed_offsets_.assign(offsets_.size(), 0);
+        }
+
+        [[nodiscard]] SQUIGGLE_INLINE size_type size() const { return parents_.size(); }
+        [[nodiscard]] SQUIGGLE_INLINE bool empty() const { return parents_.empty(); }
+
+        [[nodiscard]] SQUIGGLE_INLINE std::uint32_t parent( size_type node ) const { return parents_[node]; }
+        [[nodiscard]] SQUIGGLE_INLINE std::span<const std::uint32_t> parents() const { return parents_; }
+
+        [[nodiscard]] SQUIGGLE_INLINE std::span<const std::uint32_t> children( size_type node ) const
+        {
+            return std::span<const std::uint32_t>{ children_ }.subspan(child_offsets_[node], child_offsets_[node + 1] - child_offsets_[node]);
+        }
+
+        // Nodes of each depth, level 0 are the roots
+        [[nodiscard]] SQUIGGLE_INLINE size_type levels() const { return offsets_.size() - 1; }
+        [[nodiscard]] SQUIGGLE_INLINE std::span<const std::uint32_t> level( size_type l ) const
+        {
+            return std::span<const std::uint32_t>{ order_ }.subspan(offsets_[l], offsets_[l + 1] - offsets_[l]);
+        }
+
+        // Writing through the mutable local or locals is not tracked, mark_dirty the node for update_dirty
+        [[nodiscard]] SQUIGGLE_INLINE mat44<T>& local( size_type node ) { return local_[node]; }
+        [[nodiscard]] SQUIGGLE_INLINE const mat44<T>& local( size_type node ) const { return local_[node]; }
+        [[nodiscard]] SQUIGGLE_INLINE std::span<mat44<T>> locals() { return local_; }
+        [[nodiscard]] SQUIGGLE_INLINE std::span<const mat44<T>> locals() const { return local_; }
+
+        // World transforms as of the last update
+        [[nodiscard]] SQUIGGLE_INLINE const mat44<T>& world( size_type node ) const { return world_[node]; }
+        [[nodiscard]] SQUIGGLE_INLINE std::span<const mat44<T>> worlds() const { return world_; }
+
+        // Nodes whose world transform was written by the last update, grouped by level so parents come before
+        // their children. Every node after update, the dirty subtrees after update_dirty.
+        [[nodiscard]] SQUIGGLE_INLINE std::span<const std::uint32_t> changed() const { return changed_; }
+
+        // Local transform from a position and a normalised orientation, marks the node dirty
+        template<concepts::read_vec3_type V, concepts::read_quat_type Q>
+        SQUIGGLE_INLINE void set_local( size_type node, const V& position, const Q& orientation )
+        {
+            mat44<T>& m = local_[node];
+            sqg::position(m) = position;
+            sqg::orientation(m) = orientation;
+            m.a[3][0] = T{0};
+            m.a[3][1] = T{0};
+            m.a[3][2] = T{0};
+            m.a[3][3] = T{1};
+            mark_dirty(node);
+        }
+
+        // The world transforms of node and all its descendants are recomputed by the next update_dirty
+        SQUIGGLE_INLINE void mark_dirty( size_type node )
+        {
+            if ( !dirty_[node] )
+            {
+                dirty_[node] = 1;
+                dirty_nodes_.push_back(static_cast<std::uint32_t>(node));
+            }
+        }
+
+        [[nodiscard]] SQUIGGLE_INLINE bool is_dirty( size_type node ) const { return dirty_[node] != 0; }
+
+        // Recomputes every world transform on the calling thread
+        void update()
+        {
+            for ( size_type l = 0; l < levels(); l++ )
+                update_nodes(l, level(l));
+            changed_all();
+        }
+
+        // Recomputes every world transform, levels wider than options::cutover are split across executor
+        template<typename E>
+        void update( E&& executor, const parallel::options& opts = {} )
+        {
+            for ( size_type l = 0; l < levels(); l++ )
+                update_nodes(executor, l, level(l), opts);
+            changed_all();
+        }
+
+        // Recomputes the world transforms of the dirty nodes and their descendants on the calling thread
+        void update_dirty()
+        {
+            collect_changed();
+            for ( size_type l = 0; l < levels(); l++ )
+                update_nodes(l, changed_level(l));
+        }
+
+        // As update_dirty, changed levels wider than options::cutover are split across executor
+        template<typename E>
+        void update_dirty( E&& executor, const parallel::options& opts = {} )
+        {
+            collect_changed();
+            for ( size_type l = 0; l < levels(); l++ )
+                update_nodes(executor, l, changed_level(l), opts);
+        }
+
+    private:
+        [[nodiscard]] SQUIGGLE_INLINE std::span<const std::uint32_t> changed_level( size_type l ) const
+        {
+            return std::span<const std::uint32_t>{ changed_ }.subspan(changed_offsets_[l], changed_offsets_[l + 1] - changed_offsets_[l]);
+        }
+
+        void changed_all()
+        {
+            changed_ = order_;
+            changed_offsets_ = offsets_;
+            for ( std::uint32_t node : dirty_nodes_ )
+                dirty_[node] = 0;
+            dirty_nodes_.clear();
+        }
+
+        // The changed nodes grouped by level. A few small subtrees are walked from the dirty nodes, when the
+        // subtrees cover a large part of the tree the levels are scanned instead, a byte per node read in order
+        // rather than a cache miss per walked node. Nested dirty nodes are counted twice by the estimate,
+        // which only errs towards the scan.
+        void collect_changed()
+        {
+            changed_.clear();
+            std::fill(changed_offsets_.begin(), changed_offsets_.end(), 0);
+
+            size_type estimate = 0;
+            size_type first = levels();
+            for ( std::uint32_t node : dirty_nodes_ )
+            {
+                estimate += subtree_size_[node];
+                first = std::min<size_type>(first, depth_[node]);
+            }
+
+            if ( estimate > size() / 16 )
+                scan_changed(first);
+            else
+                walk_changed();
+
+            for ( std::uint32_t node : dirty_nodes_ )
+                dirty_[node] = 0;
+            dirty_nodes_.clear();
+            for ( std::uint32_t node : changed_ )
+                visited_[node] = 0;
+        }
+
+        // A node changes when it is dirty or its parent changed, levels above the shallowest dirty node are skipped
+        void scan_changed( size_type first )
+        {
+            for ( size_type l = first; l < levels(); l++ )
+            {
+                for ( std::uint32_t node : level(l) )
+                {
+                    const std::uint32_t parent = parents_[node];
+                    if ( dirty_[node] || ( parent != no_parent && visited_[parent] ) )
+                    {
+                        visited_[node] = 1;
+                        changed_.push_back(node);
+                    }
+                }
+                changed_offsets_[l + 1] = changed_.size();
+            }
+        }
+
+        // Walks the subtree under every dirty node once, skipping subtrees already walked from a dirty ancestor,
+        // then sorts the walked nodes by depth with a counting sort
+        void walk_changed()
+        {
+            walked_.clear();
+            for ( std::uint32_t root : dirty_nodes_ )
+            {
+                if ( visited_[root] )
+                    continue;
+
+                stack_.push_back(root);
+                visited_[root] = 1;
+                while ( !stack_.empty() )
+                {
+                    const std::uint32_t node = stack_.back();
+                    stack_.pop_back();
+                    walked_.push_back(node);
+                    for ( std::uint32_t child : children(node) )
+                    {
+                        if ( !visited_[child] )
+                        {
+                            visited_[child] = 1;
+                            stack_.push_back(child);
+                        }
+                    }
+                }
+            }
+
+            for ( std::uint32_t node : walked_ )
+                changed_offsets_[depth_[node] + 1]++;
+            for ( size_type l = 1; l < changed_offsets_.size(); l++ )
+                changed_offsets_[l] += changed_offsets_[l - 1];
+
+            changed_.resize(walked_.size());
+            next_.assign(changed_offsets_.begin(), changed_offsets_.end() - 1);
+            for ( std::uint32_t node : walked_ )
+                changed_[next_[depth_[node]]++] = node;
+        }
+
+        template<typename E>
+        void update_nodes( E& executor, size_type l, std::span<const std::uint32_t> nodes, const parallel::options& opts )
+        {
+            parallel::detail::for_tiles(executor, nodes.size(), 3 * sizeof(mat44<T>), opts, [&]( std::size_t begin, std::size_t end ) {
+                update_nodes(l, nodes.subspan(begin, end - begin));
+            });
+        }
+
+        void update_nodes( size_type l, std::span<const std::uint32_t> nodes )
+        {
+            if ( l == 0 )
+            {
+                for ( std::uint32_t node : nodes )
+                    world_[node] = local_[node];
+            }
+            else
+            {
+                dispatch::multiply_parents(&world_[0].a[0][0], &local_[0].a[0][0], parents_.data(), nodes.data(), nodes.size());
+            }
+        }
+
+        std::vector<std::uint32_t> parents_;
+        std::vector<std::uint32_t> depth_;
+        std::vector<std::uint32_t> order_;
+        std::vector<size_type> offsets_{ 0 };
+        std::vector<size_type> child_offsets_{ 0 };
+        std::vector<std::uint32_t> children_;
+        std::vector<std::uint32_t> subtree_size_;
+        std::vector<mat44<T>> local_;
+        std::vector<mat44<T>> world_;
+
+        // dirty tracking, the scratch vectors keep their capacity between updates
+        std::vector<std::uint8_t> dirty_;
+        std::vector<std::uint8_t> visited_;
+        std::vector<std::uint32_t> dirty_nodes_;
+        std::vector<std::uint32_t> changed_;
+        std::vector<size_type> changed_offsets_{ 0 };
+        std::vector<std::uint32_t> walked_;
+        std::vector<std::uint32_t> stack_;
+        std::vector<size_type> next_;
+    };
+}
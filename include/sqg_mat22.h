@@ -1,5 +1,6 @@
 #pragma once
 #include "sqg_concepts.h"
+#include "sqg_scalar.h"
 #include "sqg_mat_view.h"
 #include "sqg_vec2.h"
 
@@ -118,14 +119,12 @@ namespace sqg
 
     template<concepts::mat22_type M> SQUIGGLE_INLINE void set_rot2( M& matrix, mat_scalar<M> angle )
     {
-        using scalar = mat_scalar<M>;
-        const scalar cosa = std::cos(angle);
-        const scalar sina = std::sin(angle);
+        const auto [sina, cosa] = math::sincos(angle);
         A00(matrix,  cosa);
         A01(matrix,  -sina);
         
         A10(matrix,  sina);
-        A10(matrix,  cosa);
+        A11(matrix,  cosa);
     }
 
     // 2 dimensional rotation
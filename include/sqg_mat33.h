@@ -1,9 +1,13 @@
 #pragma once
 #include "sqg_concepts.h"
+#include "sqg_scalar.h"
 #include "sqg_mat_view.h"
 #include "sqg_vec3.h"
 #include "sqg_mat22.h"
+#include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <span>
 namespace sqg
 {
     template<concepts::mat33_type M1, concepts::read_mat33_type M2> 
@@ -111,77 +115,49 @@ namespace sqg
             a * f * h;
     }
 
-    // This is horrifically slow, mainly just for constexpr operation
+    // The adjugate's columns are the cross products of the rows, r1 x r2, r2 x r0 and r0 x r1
+    // and the determinant r0 . (r1 x r2) reuses the first of them.
     // If you want the inverse of a rotation for an orthonormal matrix transpose is equivalent.
     template<concepts::read_mat33_type M>
     [[nodiscard]] SQUIGGLE_INLINE constexpr mat_value<M> inverse(const M& matrix)
-    { //https://mathworld.wolfram.com/MatrixInverse.html
-
-        mat_value<M> m;
+    { //https://en.wikipedia.org/wiki/Invertible_matrix#Inversion_of_3_%C3%97_3_matrices
 
         using scalar = mat_scalar<M>;
 
-        const scalar a11 = A00(matrix);
-        const scalar a12 = A01(matrix);
-        const scalar a13 = A02(matrix);
-
-        const scalar a21 = A10(matrix);
-        const scalar a22 = A11(matrix);
-        const scalar a23 = A12(matrix);
-
-        const scalar a31 = A20(matrix);
-        const scalar a32 = A21(matrix);
-        const scalar a33 = A22(matrix);
-
-
-        A00(m, determinant(sqg::mat22<mat_scalar<M>>{{
-            { a22, a23 },
-            { a32, a33 }
-        }}));
-
-        A01(m, determinant(sqg::mat22<mat_scalar<M>>{{
-            { a13, a12 },
-            { a33, a32 }
-        }}));
-
-        A02(m,determinant(sqg::mat22<mat_scalar<M>>{{
-            { a12, a13 },
-            { a22, a23 }
-        }}));
-
-        A10(m,determinant(sqg::mat22<mat_scalar<M>>{{
-            { a23, a21 },
-            { a33, a31 }
-        }}));
-
-        A11(m,determinant(sqg::mat22<mat_scalar<M>>{{
-            { a11, a13 },
-            { a31, a33 }
-        }}));
-
-        A12(m,determinant(sqg::mat22<mat_scalar<M>>{{
-            { a13, a11 },
-            { a23, a21 }
-        }}));
-
-        A20(m,determinant(sqg::mat22<mat_scalar<M>>{{
-            { a21, a22 },
-            { a31, a32 }
-        }}));
-
-        A21(m,determinant(sqg::mat22<mat_scalar<M>>{{
-            { a12, a11 },
-            { a32, a31 }
-        }}));
-
-        A22(m,determinant(sqg::mat22<mat_scalar<M>>{{
-            { a11, a12 },
-            { a21, a22 }
-        }}));
-
-        const scalar det = determinant(matrix);
+        const vec3<scalar> r0 = { A00(matrix), A01(matrix), A02(matrix) };
+        const vec3<scalar> r1 = { A10(matrix), A11(matrix), A12(matrix) };
+        const vec3<scalar> r2 = { A20(matrix), A21(matrix), A22(matrix) };
+
+        const vec3<scalar> c0 = cross(r1, r2);
+        const vec3<scalar> c1 = cross(r2, r0);
+        const vec3<scalar> c2 = cross(r0, r1);
+
+        const scalar det = dot(r0, c0);
         assert(det != scalar{0});
-        return m * ( scalar{1} / det );
+        const scalar inverse_det = scalar{1} / det;
+
+        mat_value<M> m;
+        A00(m,  c0.x * inverse_det);
+        A01(m,  c1.x * inverse_det);
+        A02(m,  c2.x * inverse_det);
+
+        A10(m,  c0.y * inverse_det);
+        A11(m,  c1.y * inverse_det);
+        A12(m,  c2.y * inverse_det);
+
+        A20(m,  c0.z * inverse_det);
+        A21(m,  c1.z * inverse_det);
+        A22(m,  c2.z * inverse_det);
+        return m;
+    }
+
+    // Inverts every matrix of matrices into out, which must be at least as long
+    template<concepts::read_mat33_type M>
+    SQUIGGLE_INLINE void inverse( std::span<const M> matrices, std::span<mat_value<M>> out )
+    {
+        assert(out.size() >= matrices.size());
+        for ( std::size_t i = 0; i < matrices.size(); i++ )
+            out[i] = inverse(matrices[i]);
     }
 
     template<concepts::read_mat33_type M> 
@@ -240,8 +216,7 @@ namespace sqg
     {
         using scalar = mat_traits<T>::scalar_type;
 
-        const scalar cosa = std::cos(angle);
-        const scalar sina = std::sin(angle);
+        const auto [sina, cosa] = math::sincos(angle);
 
         A00(matrix,  scalar{1});
         A01(matrix,  scalar{0});
@@ -262,8 +237,7 @@ namespace sqg
     {
         using scalar = mat_traits<T>::scalar_type;
 
-        const scalar cosa = std::cos(angle);
-        const scalar sina = std::sin(angle);
+        const auto [sina, cosa] = math::sincos(angle);
 
         A00(matrix,  cosa);
         A01(matrix,  scalar{0});
@@ -284,8 +258,7 @@ namespace sqg
     {
         using scalar = mat_traits<T>::scalar_type;
 
-        const scalar cosa = std::cos(angle);
-        const scalar sina = std::sin(angle);
+        const auto [sina, cosa] = math::sincos(angle);
 
         A00(matrix,  cosa);
         A01(matrix,  -sina);
@@ -308,9 +281,8 @@ namespace sqg
         static_assert( std::same_as<mat_scalar<M>,vec_scalar<V>>, "Scalar type must match for this operation" );
 
         using scalar = mat_scalar<M>;
-        const scalar cosa = std::cos(angle);
+        const auto [sina, cosa] = math::sincos(angle);
         const scalar one_cosa = scalar{1} - cosa;
-        const scalar sina = std::sin(angle);
 
         const auto x = X(axis);
         const auto y = Y(axis);
@@ -352,13 +324,9 @@ namespace sqg
     template<concepts::mat33_type M>
     SQUIGGLE_INLINE void set_rotxzx( M& matrix, mat_scalar<M> a, mat_scalar<M> b, mat_scalar<M> y )
     {
-        using scalar = mat_scalar<M>;
-        const scalar ca = std::cos(a);
-        const scalar sa = std::sin(a);
-        const scalar cb = std::cos(b);
-        const scalar sb = std::sin(b);
-        const scalar cy = std::cos(y);
-        const scalar sy = std::sin(y);
+        const auto [sa, ca] = math::sincos(a);
+        const auto [sb, cb] = math::sincos(b);
+        const auto [sy, cy] = math::sincos(y);
 
         A00(matrix, cb );               A01(matrix, -cy*sb );              A02(matrix, sb*sy );
         A10(matrix, ca*sb );            A11(matrix, ca*cb*cy - sa*sy );    A12(matrix, -cy*sa - ca*cb*sy );
@@ -370,13 +338,9 @@ namespace sqg
     template<concepts::mat33_type M>
     SQUIGGLE_INLINE void set_rotxyx( M& matrix, mat_scalar<M> a, mat_scalar<M> b, mat_scalar<M> y )
     {
-        using scalar = mat_scalar<M>;
-        const scalar ca = std::cos(a);
-        const scalar sa = std::sin(a);
-        const scalar cb = std::cos(b);
-        const scalar sb = std::sin(b);
-        const scalar cy = std::cos(y);
-        const scalar sy = std::sin(y);
+        const auto [sa, ca] = math::sincos(a);
+        const auto [sb, cb] = math::sincos(b);
+        const auto [sy, cy] = math::sincos(y);
 
         A00(matrix, cb );               A01(matrix, sb*sy );               A02(matrix, cy*sb );
         A10(matrix, sa*sb );            A11(matrix, ca*cy - cb*sa*sy );    A12(matrix, -ca*sy - cb*cy*sa );
@@ -388,13 +352,9 @@ namespace sqg
     template<concepts::mat33_type M>
     SQUIGGLE_INLINE void set_rotyxy( M& matrix, mat_scalar<M> a, mat_scalar<M> b, mat_scalar<M> y )
     {
-        using scalar = mat_scalar<M>;
-        const scalar ca = std::cos(a);
-        const scalar sa = std::sin(a);
-        const scalar cb = std::cos(b);
-        const scalar sb = std::sin(b);
-        const scalar cy = std::cos(y);
-        const scalar sy = std::sin(y);
+        const auto [sa, ca] = math::sincos(a);
+        const auto [sb, cb] = math::sincos(b);
+        const auto [sy, cy] = math::sincos(y);
 
         A00(matrix, ca*cy - cb*sa*sy ); A01(matrix, sa*sb );               A02(matrix, ca*sy + cb*cy*sa );
         A10(matrix, sb*sy );            A11(matrix, cb );                  A12(matrix, -cy*sb );
@@ -406,13 +366,9 @@ namespace sqg
     template<concepts::mat33_type M>
     SQUIGGLE_INLINE void set_rotyzy( M& matrix, mat_scalar<M> a, mat_scalar<M> b, mat_scalar<M> y )
     {
-        using scalar = mat_scalar<M>;
-        const scalar ca = std::cos(a);
-        const scalar sa = std::sin(a);
-        const scalar cb = std::cos(b);
-        const scalar sb = std::sin(b);
-        const scalar cy = std::cos(y);
-        const scalar sy = std::sin(y);
+        const auto [sa, ca] = math::sincos(a);
+        const auto [sb, cb] = math::sincos(b);
+        const auto [sy, cy] = math::sincos(y);
 
         A00(matrix, ca*cb*cy - sa*sy ); A01(matrix, -ca*sb );              A02(matrix, cy*sa + ca*cb*sy );
         A10(matrix, cy*sb );            A11(matrix, cb );                  A12(matrix, sb*sy );
@@ -424,13 +380,9 @@ namespace sqg
     template<concepts::mat33_type M>
     SQUIGGLE_INLINE void set_rotzyz( M& matrix, mat_scalar<M> a, mat_scalar<M> b, mat_scalar<M> y )
     {
-        using scalar = mat_scalar<M>;
-        const scalar ca = std::cos(a);
-        const scalar sa = std::sin(a);
-        const scalar cb = std::cos(b);
-        const scalar sb = std::sin(b);
-        const scalar cy = std::cos(y);
-        const scalar sy = std::sin(y);
+        const auto [sa, ca] = math::sincos(a);
+        const auto [sb, cb] = math::sincos(b);
+        const auto [sy, cy] = math::sincos(y);
 
         A00(matrix, ca*cb*cy - sa*sy ); A01(matrix, -cy*sa - ca*cb*sy );   A02(matrix, ca*sb );
         A10(matrix, ca*sy + cb*cy*sa ); A11(matrix, ca*cy - cb*sa*sy );    A12(matrix, sa*sb );
@@ -442,13 +394,9 @@ namespace sqg
     template<concepts::mat33_type M>
     SQUIGGLE_INLINE void set_rotzxz( M& matrix, mat_scalar<M> a, mat_scalar<M> b, mat_scalar<M> y )
     {
-        using scalar = mat_scalar<M>;
-        const scalar ca = std::cos(a);
-        const scalar sa = std::sin(a);
-        const scalar cb = std::cos(b);
-        const scalar sb = std::sin(b);
-        const scalar cy = std::cos(y);
-        const scalar sy = std::sin(y);
+        const auto [sa, ca] = math::sincos(a);
+        const auto [sb, cb] = math::sincos(b);
+        const auto [sy, cy] = math::sincos(y);
 
         A00(matrix, ca*cy - cb*sa*sy ); A01(matrix, -ca*sy - cb*cy*sa );   A02(matrix, sa*sb );
         A10(matrix, cy*sa + ca*cb*sy ); A11(matrix, ca*cb*cy - sa*sy );    A12(matrix, -ca*sb );
@@ -462,13 +410,9 @@ namespace sqg
     template<concepts::mat33_type M>
     SQUIGGLE_INLINE void set_rotxzy( M& matrix, mat_scalar<M> a, mat_scalar<M> b, mat_scalar<M> y )
     {
-        using scalar = mat_scalar<M>;
-        const scalar ca = std::cos(a);
-        const scalar sa = std::sin(a);
-        const scalar cb = std::cos(b);
-        const scalar sb = std::sin(b);
-        const scalar cy = std::cos(y);
-        const scalar sy = std::sin(y);
+        const auto [sa, ca] = math::sincos(a);
+        const auto [sb, cb] = math::sincos(b);
+        const auto [sy, cy] = math::sincos(y);
 
         A00(matrix, cb*cy );            A01(matrix, -sb );                 A02(matrix, cb*sy );
         A10(matrix, sa*sy + ca*cy*sb ); A11(matrix, ca*cb );               A12(matrix, ca*sb*sy - cy*sa );
@@ -480,13 +424,9 @@ namespace sqg
     template<concepts::mat33_type M>
     SQUIGGLE_INLINE void set_rotxyz( M& matrix, mat_scalar<M> a, mat_scalar<M> b, mat_scalar<M> y )
     {
-        using scalar = mat_scalar<M>;
-        const scalar ca = std::cos(a);
-        const scalar sa = std::sin(a);
-        const scalar cb = std::cos(b);
-        const scalar sb = std::sin(b);
-        const scalar cy = std::cos(y);
-        const scalar sy = std::sin(y);
+        const auto [sa, ca] = math::sincos(a);
+        const auto [sb, cb] = math::sincos(b);
+        const auto [sy, cy] = math::sincos(y);
 
         A00(matrix, cb*cy );            A01(matrix, -cb*sy );              A02(matrix, sb );
         A10(matrix, ca*sy + cy*sa*sb ); A11(matrix, ca*cy - sa*sb*sy );    A12(matrix, -cb*sa );
@@ -498,13 +438,9 @@ namespace sqg
     template<concepts::mat33_type M>
     SQUIGGLE_INLINE void set_rotyxz( M& matrix, mat_scalar<M> a, mat_scalar<M> b, mat_scalar<M> y )
     {
-        using scalar = mat_scalar<M>;
-        const scalar ca = std::cos(a);
-        const scalar sa = std::sin(a);
-        const scalar cb = std::cos(b);
-        const scalar sb = std::sin(b);
-        const scalar cy = std::cos(y);
-        const scalar sy = std::sin(y);
+        const auto [sa, ca] = math::sincos(a);
+        const auto [sb, cb] = math::sincos(b);
+        const auto [sy, cy] = math::sincos(y);
 
         A00(matrix, ca*cy + sa*sb*sy ); A01(matrix, cy*sa*sb - ca*sy );    A02(matrix, cb*sa );
         A10(matrix, cb*sy );            A11(matrix, cb*cy );               A12(matrix, -sb );
@@ -516,13 +452,9 @@ namespace sqg
     template<concepts::mat33_type M>
     SQUIGGLE_INLINE void set_rotyzx( M& matrix, mat_scalar<M> a, mat_scalar<M> b, mat_scalar<M> y )
     {
-        using scalar = mat_scalar<M>;
-        const scalar ca = std::cos(a);
-        const scalar sa = std::sin(a);
-        const scalar cb = std::cos(b);
-        const scalar sb = std::sin(b);
-        const scalar cy = std::cos(y);
-        const scalar sy = std::sin(y);
+        const auto [sa, ca] = math::sincos(a);
+        const auto [sb, cb] = math::sincos(b);
+        const auto [sy, cy] = math::sincos(y);
 
         A00(matrix, ca*cb );            A01(matrix, sa*sy - ca*cy*sb );    A02(matrix, cy*sa + ca*sb*sy );
         A10(matrix, sb );               A11(matrix, cb*cy );               A12(matrix, -cb*sy );
@@ -534,13 +466,9 @@ namespace sqg
     template<concepts::mat33_type M>
     SQUIGGLE_INLINE void set_rotzyx( M& matrix, mat_scalar<M> a, mat_scalar<M> b, mat_scalar<M> y )
     {
-        using scalar = mat_scalar<M>;
-        const scalar ca = std::cos(a);
-        const scalar sa = std::sin(a);
-        const scalar cb = std::cos(b);
-        const scalar sb = std::sin(b);
-        const scalar cy = std::cos(y);
-        const scalar sy = std::sin(y);
+        const auto [sa, ca] = math::sincos(a);
+        const auto [sb, cb] = math::sincos(b);
+        const auto [sy, cy] = math::sincos(y);
 
         A00(matrix, ca*cb );            A01(matrix, ca*sb*sy - cy*sa );    A02(matrix, sa*sy + ca*cy*sb );
         A10(matrix, cb*sa );            A11(matrix, ca*cy + sa*sb*sy );    A12(matrix, cy*sa*sb - ca*sy );
@@ -552,13 +480,9 @@ namespace sqg
     template<concepts::mat33_type M>
     SQUIGGLE_INLINE void set_rotzxy( M& matrix, mat_scalar<M> a, mat_scalar<M> b, mat_scalar<M> y )
     {
-        using scalar = mat_scalar<M>;
-        const scalar ca = std::cos(a);
-        const scalar sa = std::sin(a);
-        const scalar cb = std::cos(b);
-        const scalar sb = std::sin(b);
-        const scalar cy = std::cos(y);
-        const scalar sy = std::sin(y);
+        const auto [sa, ca] = math::sincos(a);
+        const auto [sb, cb] = math::sincos(b);
+        const auto [sy, cy] = math::sincos(y);
 
         A00(matrix, ca*cy - sa*sb*sy ); A01(matrix, -cb*sa );              A02(matrix, ca*sy + cy*sa*sb );
         A10(matrix, cy*sa + ca*sb*sy ); A11(matrix, ca*cb );               A12(matrix, sa*sy - ca*cy*sb );
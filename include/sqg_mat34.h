@@ -0,0 +1,286 @@
+#pragma once
+#include "sqg_concepts.h"
+#include "sqg_mat33.h"
+#include "sqg_mat44.h"
+#include "sqg_mat_view.h"
+#include "sqg_simd.h"
+#include "sqg_traits.h"
+#include "sqg_vec3.h"
+#include <array>
+#include <type_traits>
+#include <utility>
+
+// 3x4 affine matrices, the top three rows of a 4x4 matrix whose last row is always 0 0 0 1.
+// They are a quarter smaller than a mat44 and the products below never multiply by the implied row.
+// orientation and position views work on them the same as on a mat44.
+
+namespace sqg::detail
+{
+    // Element row, col of a * b as 4x4 affine matrices, the implied last row of b only adds the translation of a
+    template<int row, int col, typename M1, typename M2>
+    SQUIGGLE_INLINE constexpr mat34_scalar<M1> affine_product_element( const M1& a, const M2& b )
+    {
+        const mat34_scalar<M1> s = A<row,0>(a) * A<0,col>(b) + A<row,1>(a) * A<1,col>(b) + A<row,2>(a) * A<2,col>(b);
+        if constexpr ( col == 3 )
+            return s + A<row,3>(a);
+        else
+            return s;
+    }
+
+    template<typename M, typename M1, typename M2, int... i>
+    SQUIGGLE_INLINE constexpr void affine_product( M& m, const M1& a, const M2& b, std::integer_sequence<int, i...> )
+    {
+        ( A<i / 4, i % 4>(m, affine_product_element<i / 4, i % 4>(a, b)), ... );
+    }
+
+    template<typename M1, typename M2, int... i>
+    SQUIGGLE_INLINE constexpr bool affine_equal( const M1& a, const M2& b, std::integer_sequence<int, i...> )
+    {
+        return ( ( A<i / 4, i % 4>(a) == A<i / 4, i % 4>(b) ) && ... );
+    }
+}
+
+namespace sqg
+{
+    template<concepts::mat34_type M1, concepts::read_mat34_type M2>
+    SQUIGGLE_INLINE constexpr void assign( M1& destination, const M2& source )
+    {
+        static_assert( std::convertible_to<mat34_scalar<M2>, mat34_scalar<M1>>, "Source Scalar must be convertible to Destination Scalar" );
+        A<0,0>(destination,  A<0,0>(source));
+        A<0,1>(destination,  A<0,1>(source));
+        A<0,2>(destination,  A<0,2>(source));
+        A<0,3>(destination,  A<0,3>(source));
+
+        A<1,0>(destination,  A<1,0>(source));
+        A<1,1>(destination,  A<1,1>(source));
+        A<1,2>(destination,  A<1,2>(source));
+        A<1,3>(destination,  A<1,3>(source));
+
+        A<2,0>(destination,  A<2,0>(source));
+        A<2,1>(destination,  A<2,1>(source));
+        A<2,2>(destination,  A<2,2>(source));
+        A<2,3>(destination,  A<2,3>(source));
+    }
+
+    // Top three rows of a 4x4 matrix, its last row is assumed to be 0 0 0 1 and is dropped
+    template<concepts::mat34_type M34, concepts::read_mat44_type M44>
+    SQUIGGLE_INLINE constexpr void assign( M34& destination, const M44& source )
+    {
+        static_assert( std::convertible_to<mat_scalar<M44>, mat34_scalar<M34>>, "Source Scalar must be convertible to Destination Scalar" );
+        orientation(destination) = orientation(source);
+        position(destination) = position(source);
+    }
+
+    // 4x4 matrix with the implied last row 0 0 0 1 written out
+    template<concepts::mat44_type M44, concepts::read_mat34_type M34>
+    SQUIGGLE_INLINE constexpr void assign( M44& destination, const M34& source )
+    {
+        static_assert( std::convertible_to<mat34_scalar<M34>, mat_scalar<M44>>, "Source Scalar must be convertible to Destination Scalar" );
+        using scalar = mat_scalar<M44>;
+        orientation(destination) = orientation(source);
+        position(destination) = position(source);
+        A30(destination,  scalar{0});
+        A31(destination,  scalar{0});
+        A32(destination,  scalar{0});
+        A33(destination,  scalar{1});
+    }
+
+    template<concepts::mat34_type M> SQUIGGLE_INLINE constexpr void set_identity( M& matrix )
+    {
+        using scalar = mat34_scalar<M>;
+        A<0,0>(matrix,  scalar{1});
+        A<0,1>(matrix,  scalar{0});
+        A<0,2>(matrix,  scalar{0});
+        A<0,3>(matrix,  scalar{0});
+
+        A<1,0>(matrix,  scalar{0});
+        A<1,1>(matrix,  scalar{1});
+        A<1,2>(matrix,  scalar{0});
+        A<1,3>(matrix,  scalar{0});
+
+        A<2,0>(matrix,  scalar{0});
+        A<2,1>(matrix,  scalar{0});
+        A<2,2>(matrix,  scalar{1});
+        A<2,3>(matrix,  scalar{0});
+    }
+
+    template<typename T>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr mat34<T> identity_mat34()
+    {
+        mat34<T> m;
+        set_identity(m);
+        return m;
+    }
+
+    // a * b as 4x4 affine matrices, 36 multiplies rather than the 64 of the mat44 product.
+    // Orientation is Ra * Rb and position is Ra * tb + ta.
+    template<concepts::read_mat34_type M1, concepts::read_mat34_type M2>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr mat34_value<M1> operator*( const M1& a, const M2& b )
+    {
+        static_assert( std::same_as<mat34_scalar<M1>,mat34_scalar<M2>>, "Scalar type must match for this operation" );
+
+        mat34_value<M1> m;
+        detail::affine_product(m, a, b, std::make_integer_sequence<int, 12>{});
+        return m;
+    }
+
+    // Contiguous row major storage, each row of the result is a linear combination of the rows of b and of
+    // the implied 0 0 0 1 row, as in the mat44 product
+    template<concepts::simd_mat34_type M1, concepts::simd_mat34_type M2>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr mat34_value<M1> operator*( const M1& a, const M2& b )
+    {
+        static_assert( std::same_as<mat34_scalar<M1>,mat34_scalar<M2>>, "Scalar type must match for this operation" );
+
+        mat34_value<M1> m;
+        if ( std::is_constant_evaluated() )
+        {
+            detail::affine_product(m, a, b, std::make_integer_sequence<int, 12>{});
+            return m;
+        }
+
+        using scalar = mat34_scalar<M1>;
+        const scalar* pb = mat34_traits<M2>::data(b);
+        const auto b0 = simd::load(pb);
+        const auto b1 = simd::load(pb + 4);
+        const auto b2 = simd::load(pb + 8);
+        const auto b3 = simd::load(std::array<scalar,4>{ scalar{0}, scalar{0}, scalar{0}, scalar{1} }.data());
+
+        const scalar* pa = mat34_traits<M1>::data(a);
+        scalar* pm = mat34_traits<mat34_value<M1>>::data(m);
+        for ( int i = 0; i < 3; i++ )
+        {
+            const scalar* ai = pa + 4 * i;
+            auto r = simd::mul(simd::splat(ai[0]), b0);
+            r = simd::fmadd(simd::splat(ai[1]), b1, r);
+            r = simd::fmadd(simd::splat(ai[2]), b2, r);
+            r = simd::fmadd(simd::splat(ai[3]), b3, r);
+            simd::store(pm + 4 * i, r);
+        }
+        return m;
+    }
+
+    // The orientation block is inverted as a 3x3 matrix and the translation becomes -(R^-1 * t)
+    template<concepts::read_mat34_type M>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr mat34_value<M> affine_inverse( const M& matrix )
+    {
+        using scalar = mat34_scalar<M>;
+        const mat33<scalar> r = inverse(orientation(matrix));
+
+        mat34_value<M> m;
+        orientation(m) = r;
+        position(m) = -( r * position(matrix) );
+        return m;
+    }
+
+    // Inverse of a rotation plus translation, the orthonormal 3x3 block inverts by transposing
+    // and the translation becomes -(R^T * t). Scale or shear needs affine_inverse.
+    template<concepts::read_mat34_type M>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr mat34_value<M> rigid_inverse( const M& matrix )
+    {
+        using scalar = mat34_scalar<M>;
+        mat33<scalar> r = orientation(matrix);
+        transpose(r);
+
+        mat34_value<M> m;
+        orientation(m) = r;
+        position(m) = -( r * position(matrix) );
+        return m;
+    }
+
+    // Every 3x4 matrix is affine, so the general inverse is affine_inverse
+    template<concepts::read_mat34_type M>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr mat34_value<M> inverse( const M& matrix )
+    {
+        return affine_inverse(matrix);
+    }
+
+    // Transforms a point, the point has an implied w = 1 so the translation is added directly
+    template<concepts::read_mat34_type M, concepts::read_vec3_type V>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> transform_point( const M& matrix, const V& point )
+    {
+        static_assert( std::same_as<mat34_scalar<M>,vec_scalar<V>>, "Scalar type must match for this operation" );
+
+        const auto x = X(point);
+        const auto y = Y(point);
+        const auto z = Z(point);
+
+        vec_value<V> v;
+        X(v,  A<0,0>(matrix) * x + A<0,1>(matrix) * y + A<0,2>(matrix) * z + A<0,3>(matrix));
+        Y(v,  A<1,0>(matrix) * x + A<1,1>(matrix) * y + A<1,2>(matrix) * z + A<1,3>(matrix));
+        Z(v,  A<2,0>(matrix) * x + A<2,1>(matrix) * y + A<2,2>(matrix) * z + A<2,3>(matrix));
+        return v;
+    }
+
+    // Contiguous row major storage, the three rows and a zero row are transposed in registers into columns
+    template<concepts::simd_mat34_type M, concepts::read_vec3_type V>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> transform_point( const M& matrix, const V& point )
+    {
+        static_assert( std::same_as<mat34_scalar<M>,vec_scalar<V>>, "Scalar type must match for this operation" );
+
+        vec_value<V> v;
+        if ( std::is_constant_evaluated() )
+        {
+            X(v,  A<0,0>(matrix) * X(point) + A<0,1>(matrix) * Y(point) + A<0,2>(matrix) * Z(point) + A<0,3>(matrix));
+            Y(v,  A<1,0>(matrix) * X(point) + A<1,1>(matrix) * Y(point) + A<1,2>(matrix) * Z(point) + A<1,3>(matrix));
+            Z(v,  A<2,0>(matrix) * X(point) + A<2,1>(matrix) * Y(point) + A<2,2>(matrix) * Z(point) + A<2,3>(matrix));
+            return v;
+        }
+
+        using scalar = mat34_scalar<M>;
+        const scalar* p = mat34_traits<M>::data(matrix);
+        auto c0 = simd::load(p);
+        auto c1 = simd::load(p + 4);
+        auto c2 = simd::load(p + 8);
+        auto c3 = simd::splat(scalar{0});
+        simd::transpose(c0, c1, c2, c3);
+
+        auto r = simd::mul(simd::splat(scalar{X(point)}), c0);
+        r = simd::fmadd(simd::splat(scalar{Y(point)}), c1, r);
+        r = simd::fmadd(simd::splat(scalar{Z(point)}), c2, r);
+        r = simd::add(r, c3);
+
+        alignas(sizeof(simd::pack4<scalar>)) scalar out[4];
+        simd::store_aligned(out, r);
+        X(v,  out[0]);
+        Y(v,  out[1]);
+        Z(v,  out[2]);
+        return v;
+    }
+
+    // Transforms a direction, the direction has an implied w = 0 so the translation is ignored
+    template<concepts::read_mat34_type M, concepts::read_vec3_type V>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> transform_dir( const M& matrix, const V& direction )
+    {
+        static_assert( std::same_as<mat34_scalar<M>,vec_scalar<V>>, "Scalar type must match for this operation" );
+
+        const auto x = X(direction);
+        const auto y = Y(direction);
+        const auto z = Z(direction);
+
+        vec_value<V> v;
+        X(v,  A<0,0>(matrix) * x + A<0,1>(matrix) * y + A<0,2>(matrix) * z);
+        Y(v,  A<1,0>(matrix) * x + A<1,1>(matrix) * y + A<1,2>(matrix) * z);
+        Z(v,  A<2,0>(matrix) * x + A<2,1>(matrix) * y + A<2,2>(matrix) * z);
+        return v;
+    }
+
+    // A 3d vector multiplied by a 3x4 matrix is a point, as for mat44
+    template<concepts::read_mat34_type M, concepts::read_vec3_type V>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> operator*( const M& matrix, const V& vector )
+    {
+        return transform_point(matrix, vector);
+    }
+
+    template<concepts::read_mat34_type M1, concepts::read_mat34_type M2>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr bool operator==( const M1& a, const M2& b )
+    {
+        static_assert( std::same_as<mat34_scalar<M1>,mat34_scalar<M2>>, "Scalar type must match for this operation" );
+        return detail::affine_equal(a, b, std::make_integer_sequence<int, 12>{});
+    }
+
+    template<concepts::read_mat34_type M1, concepts::read_mat34_type M2>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr bool operator!=( const M1& a, const M2& b )
+    {
+        return !( a == b );
+    }
+}
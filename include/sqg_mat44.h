@@ -1,7 +1,12 @@
 #pragma once
 #include "sqg_concepts.h"
 #include "sqg_mat_view.h"
+#include "sqg_mat_vec.h"
+#include "sqg_mat33.h"
 #include "sqg_vec4.h"
+#include "sqg_simd.h"
+#include <cassert>
+#include <type_traits>
 
 namespace sqg
 {
@@ -107,6 +112,41 @@ namespace sqg
         return m;
     }
 
+    // Contiguous row major storage, each row of the result is a linear combination of the rows of b
+    // so rather than walking the columns of b the rows are broadcast multiplied and summed.
+    template<concepts::simd_mat44_type M1, concepts::simd_mat44_type M2>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr mat_value2<M1,M2> operator*( const M1& a, const M2& b )
+    {
+        static_assert( std::same_as<mat_scalar<M1>,mat_scalar<M2>>, "Scalar type must match for this operation" );
+
+        mat_value2<M1,M2> m;
+        if ( std::is_constant_evaluated() )
+        {
+            row<0>(m) = A00(a) * row<0>(b) + A01(a) * row<1>(b) + A02(a) * row<2>(b) + A03(a) * row<3>(b);
+            row<1>(m) = A10(a) * row<0>(b) + A11(a) * row<1>(b) + A12(a) * row<2>(b) + A13(a) * row<3>(b);
+            row<2>(m) = A20(a) * row<0>(b) + A21(a) * row<1>(b) + A22(a) * row<2>(b) + A23(a) * row<3>(b);
+            row<3>(m) = A30(a) * row<0>(b) + A31(a) * row<1>(b) + A32(a) * row<2>(b) + A33(a) * row<3>(b);
+            return m;
+        }
+
+        const auto b0 = simd::load_row(b, 0);
+        const auto b1 = simd::load_row(b, 1);
+        const auto b2 = simd::load_row(b, 2);
+        const auto b3 = simd::load_row(b, 3);
+
+        const mat_scalar<M1>* pa = mat_traits<M1>::data(a);
+        for ( int i = 0; i < 4; i++ )
+        {
+            const mat_scalar<M1>* ai = pa + 4 * i;
+            auto r = simd::mul(simd::splat(ai[0]), b0);
+            r = simd::fmadd(simd::splat(ai[1]), b1, r);
+            r = simd::fmadd(simd::splat(ai[2]), b2, r);
+            r = simd::fmadd(simd::splat(ai[3]), b3, r);
+            simd::store_row(m, i, r);
+        }
+        return m;
+    }
+
     template<concepts::mat44_type M> SQUIGGLE_INLINE constexpr void transpose(M& matrix)
     {
         // xx 01 02 03
@@ -123,6 +163,176 @@ namespace sqg
         mat_swap_element<2,3, 3,2>(matrix);
     }
 
+    template<concepts::read_mat44_type M>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr mat_scalar<M> determinant( const M& matrix )
+    {
+        // 2x2 determinants of the top two and bottom two rows, expanded by Laplace along them
+        const auto s0 = A00(matrix) * A11(matrix) - A10(matrix) * A01(matrix);
+        const auto s1 = A00(matrix) * A12(matrix) - A10(matrix) * A02(matrix);
+        const auto s2 = A00(matrix) * A13(matrix) - A10(matrix) * A03(matrix);
+        const auto s3 = A01(matrix) * A12(matrix) - A11(matrix) * A02(matrix);
+        const auto s4 = A01(matrix) * A13(matrix) - A11(matrix) * A03(matrix);
+        const auto s5 = A02(matrix) * A13(matrix) - A12(matrix) * A03(matrix);
+
+        const auto c5 = A22(matrix) * A33(matrix) - A32(matrix) * A23(matrix);
+        const auto c4 = A21(matrix) * A33(matrix) - A31(matrix) * A23(matrix);
+        const auto c3 = A21(matrix) * A32(matrix) - A31(matrix) * A22(matrix);
+        const auto c2 = A20(matrix) * A33(matrix) - A30(matrix) * A23(matrix);
+        const auto c1 = A20(matrix) * A32(matrix) - A30(matrix) * A22(matrix);
+        const auto c0 = A20(matrix) * A31(matrix) - A30(matrix) * A21(matrix);
+
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+
+    namespace detail
+    {
+        // Adjugate from the twelve 2x2 determinants of the top and bottom row pairs, each is shared by four cofactors
+        template<concepts::read_mat44_type M>
+        SQUIGGLE_INLINE constexpr mat_value<M> inverse_cofactor( const M& matrix )
+        {
+            using scalar = mat_scalar<M>;
+
+            const scalar a00 = A00(matrix), a01 = A01(matrix), a02 = A02(matrix), a03 = A03(matrix);
+            const scalar a10 = A10(matrix), a11 = A11(matrix), a12 = A12(matrix), a13 = A13(matrix);
+            const scalar a20 = A20(matrix), a21 = A21(matrix), a22 = A22(matrix), a23 = A23(matrix);
+            const scalar a30 = A30(matrix), a31 = A31(matrix), a32 = A32(matrix), a33 = A33(matrix);
+
+            const scalar s0 = a00 * a11 - a10 * a01;
+            const scalar s1 = a00 * a12 - a10 * a02;
+            const scalar s2 = a00 * a13 - a10 * a03;
+            const scalar s3 = a01 * a12 - a11 * a02;
+            const scalar s4 = a01 * a13 - a11 * a03;
+            const scalar s5 = a02 * a13 - a12 * a03;
+
+            const scalar c5 = a22 * a33 - a32 * a23;
+            const scalar c4 = a21 * a33 - a31 * a23;
+            const scalar c3 = a21 * a32 - a31 * a22;
+            const scalar c2 = a20 * a33 - a30 * a23;
+            const scalar c1 = a20 * a32 - a30 * a22;
+            const scalar c0 = a20 * a31 - a30 * a21;
+
+            const scalar det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+            assert(det != scalar{0});
+            const scalar inverse_det = scalar{1} / det;
+
+            mat_value<M> m;
+            A00(m,  (  a11 * c5 - a12 * c4 + a13 * c3 ) * inverse_det);
+            A01(m,  ( -a01 * c5 + a02 * c4 - a03 * c3 ) * inverse_det);
+            A02(m,  (  a31 * s5 - a32 * s4 + a33 * s3 ) * inverse_det);
+            A03(m,  ( -a21 * s5 + a22 * s4 - a23 * s3 ) * inverse_det);
+
+            A10(m,  ( -a10 * c5 + a12 * c2 - a13 * c1 ) * inverse_det);
+            A11(m,  (  a00 * c5 - a02 * c2 + a03 * c1 ) * inverse_det);
+            A12(m,  ( -a30 * s5 + a32 * s2 - a33 * s1 ) * inverse_det);
+            A13(m,  (  a20 * s5 - a22 * s2 + a23 * s1 ) * inverse_det);
+
+            A20(m,  (  a10 * c4 - a11 * c2 + a13 * c0 ) * inverse_det);
+            A21(m,  ( -a00 * c4 + a01 * c2 - a03 * c0 ) * inverse_det);
+            A22(m,  (  a30 * s4 - a31 * s2 + a33 * s0 ) * inverse_det);
+            A23(m,  ( -a20 * s4 + a21 * s2 - a23 * s0 ) * inverse_det);
+
+            A30(m,  ( -a10 * c3 + a11 * c1 - a12 * c0 ) * inverse_det);
+            A31(m,  (  a00 * c3 - a01 * c1 + a02 * c0 ) * inverse_det);
+            A32(m,  ( -a30 * s3 + a31 * s1 - a32 * s0 ) * inverse_det);
+            A33(m,  (  a20 * s3 - a21 * s1 + a22 * s0 ) * inverse_det);
+            return m;
+        }
+
+        // Lane j is the determinant of the 3x3 matrix with rows a, b, c and column j removed,
+        // p, q and r pick the three remaining columns in order for every lane
+        template<typename T>
+        SQUIGGLE_INLINE simd::pack4<T> minors( simd::pack4<T> a, simd::pack4<T> b, simd::pack4<T> c )
+        {
+            const auto bp = simd::shuffle<1,0,0,0>(b), bq = simd::shuffle<2,2,1,1>(b), br = simd::shuffle<3,3,3,2>(b);
+            const auto cp = simd::shuffle<1,0,0,0>(c), cq = simd::shuffle<2,2,1,1>(c), cr = simd::shuffle<3,3,3,2>(c);
+
+            const auto qr = simd::sub(simd::mul(bq, cr), simd::mul(br, cq));
+            const auto pr = simd::sub(simd::mul(bp, cr), simd::mul(br, cp));
+            const auto pq = simd::sub(simd::mul(bp, cq), simd::mul(bq, cp));
+
+            auto r = simd::mul(simd::shuffle<1,0,0,0>(a), qr);
+            r = simd::sub(r, simd::mul(simd::shuffle<2,2,1,1>(a), pr));
+            return simd::fmadd(simd::shuffle<3,3,3,2>(a), pq, r);
+        }
+    }
+
+    // General inverse by cofactors, see affine_inverse and rigid_inverse for the much cheaper special cases
+    template<concepts::read_mat44_type M>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr mat_value<M> inverse( const M& matrix )
+    {
+        return detail::inverse_cofactor(matrix);
+    }
+
+    // Contiguous row major storage, row i of the cofactor matrix is the minors of the other three rows
+    // with alternating signs. The four are transposed in registers into the adjugate.
+    template<concepts::simd_mat44_type M>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr mat_value<M> inverse( const M& matrix )
+    {
+        if ( std::is_constant_evaluated() )
+            return detail::inverse_cofactor(matrix);
+
+        using scalar = mat_scalar<M>;
+        const auto r0 = simd::load_row(matrix, 0);
+        const auto r1 = simd::load_row(matrix, 1);
+        const auto r2 = simd::load_row(matrix, 2);
+        const auto r3 = simd::load_row(matrix, 3);
+
+        auto c0 = simd::negate<false,true,false,true>(detail::minors(r1, r2, r3));
+        auto c1 = simd::negate<true,false,true,false>(detail::minors(r0, r2, r3));
+        auto c2 = simd::negate<false,true,false,true>(detail::minors(r0, r1, r3));
+        auto c3 = simd::negate<true,false,true,false>(detail::minors(r0, r1, r2));
+
+        const scalar det = simd::hsum(simd::mul(r0, c0));
+        assert(det != scalar{0});
+        const auto inverse_det = simd::splat(scalar{1} / det);
+
+        simd::transpose(c0, c1, c2, c3);
+
+        mat_value<M> m;
+        simd::store_row(m, 0, simd::mul(c0, inverse_det));
+        simd::store_row(m, 1, simd::mul(c1, inverse_det));
+        simd::store_row(m, 2, simd::mul(c2, inverse_det));
+        simd::store_row(m, 3, simd::mul(c3, inverse_det));
+        return m;
+    }
+
+    // Inverse of an affine matrix, bottom row 0 0 0 1. The 3x3 block is inverted
+    // on its own and the translation becomes -(R^-1 * t).
+    template<concepts::read_mat44_type M>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr mat_value<M> affine_inverse( const M& matrix )
+    {
+        using scalar = mat_scalar<M>;
+        const mat33<scalar> r = inverse(orientation(matrix));
+
+        mat_value<M> m;
+        orientation(m) = r;
+        position(m) = -( r * position(matrix) );
+        A30(m,  scalar{0});
+        A31(m,  scalar{0});
+        A32(m,  scalar{0});
+        A33(m,  scalar{1});
+        return m;
+    }
+
+    // Inverse of a rotation plus translation, the orthonormal 3x3 block inverts by transposing
+    // and the translation becomes -(R^T * t). Scale or shear needs affine_inverse.
+    template<concepts::read_mat44_type M>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr mat_value<M> rigid_inverse( const M& matrix )
+    {
+        using scalar = mat_scalar<M>;
+        mat33<scalar> r = orientation(matrix);
+        transpose(r);
+
+        mat_value<M> m;
+        orientation(m) = r;
+        position(m) = -( r * position(matrix) );
+        A30(m,  scalar{0});
+        A31(m,  scalar{0});
+        A32(m,  scalar{0});
+        A33(m,  scalar{1});
+        return m;
+    }
+
     template<concepts::read_mat44_type M> 
     SQUIGGLE_INLINE constexpr mat_value<M> operator-( const M& matrix )
     {
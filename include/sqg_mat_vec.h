@@ -5,13 +5,15 @@
 #include "sqg_vec3.h"
 #include "sqg_vec4.h"
 #include "sqg_vec_view.h"
+#include "sqg_simd.h"
+#include <type_traits>
 
 namespace sqg
 {
     template<concepts::read_mat22_type M, concepts::read_vec2_type V>
     [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> operator*( const M& matrix, const V& vector )
     {
-        V v;
+        vec_value<V> v;
         X(v,   dot( row<0>(matrix), vector ));
         Y(v,   dot( row<1>(matrix), vector ));
         return v;
@@ -20,7 +22,7 @@ namespace sqg
     template<concepts::read_mat33_type M, concepts::read_vec3_type V>
     [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> operator*( const M& matrix, const V& vector )
     {
-        V v;
+        vec_value<V> v;
         X(v,   dot( row<0>(matrix), vector ));
         Y(v,   dot( row<1>(matrix), vector ));
         Z(v,   dot( row<2>(matrix), vector ));
@@ -30,7 +32,7 @@ namespace sqg
     template<concepts::read_mat44_type M, concepts::read_vec4_type V>
     [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> operator*( const M& matrix, const V& vector )
     {
-        V v;
+        vec_value<V> v;
         X(v,  dot( row<0>(matrix), vector ));
         Y(v,  dot( row<1>(matrix), vector ));
         Z(v,  dot( row<2>(matrix), vector ));
@@ -38,14 +40,139 @@ namespace sqg
         return v;
     }
 
-    template<concepts::read_mat44_type M, concepts::read_vec3_type V>
+    // Contiguous matrices are transposed in registers so the product is one broadcast multiply-add per component
+    template<concepts::simd_mat44_type M, concepts::read_vec4_type V>
     [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> operator*( const M& matrix, const V& vector )
     {
-        const auto view = extend4_view{vector};
-        V v;
-        X(v,  dot( row<0>(matrix), view ));
-        Y(v,  dot( row<1>(matrix), view ));
-        Z(v,  dot( row<2>(matrix), view )); // can skip W component since we would just discard anyway
+        static_assert( std::same_as<mat_scalar<M>,vec_scalar<V>>, "Scalar type must match for this operation" );
+
+        vec_value<V> v;
+        if ( std::is_constant_evaluated() )
+        {
+            X(v,  dot( row<0>(matrix), vector ));
+            Y(v,  dot( row<1>(matrix), vector ));
+            Z(v,  dot( row<2>(matrix), vector ));
+            W(v,  dot( row<3>(matrix), vector ));
+            return v;
+        }
+
+        using scalar = mat_scalar<M>;
+        simd::pack4<scalar> c0, c1, c2, c3;
+        simd::load_cols(matrix, c0, c1, c2, c3);
+
+        auto r = simd::mul(simd::splat(scalar{X(vector)}), c0);
+        r = simd::fmadd(simd::splat(scalar{Y(vector)}), c1, r);
+        r = simd::fmadd(simd::splat(scalar{Z(vector)}), c2, r);
+        r = simd::fmadd(simd::splat(scalar{W(vector)}), c3, r);
+
+        alignas(sizeof(simd::pack4<scalar>)) scalar out[4];
+        simd::store_aligned(out, r);
+        X(v,  out[0]);
+        Y(v,  out[1]);
+        Z(v,  out[2]);
+        W(v,  out[3]);
+        return v;
+    }
+
+    // Transforms a point by an affine matrix, the point has an implied w = 1 so the translation is added directly
+    template<concepts::read_mat44_type M, concepts::read_vec3_type V>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> transform_point( const M& matrix, const V& point )
+    {
+        static_assert( std::same_as<mat_scalar<M>,vec_scalar<V>>, "Scalar type must match for this operation" );
+
+        const auto x = X(point);
+        const auto y = Y(point);
+        const auto z = Z(point);
+
+        vec_value<V> v;
+        X(v,  A00(matrix) * x + A01(matrix) * y + A02(matrix) * z + A03(matrix));
+        Y(v,  A10(matrix) * x + A11(matrix) * y + A12(matrix) * z + A13(matrix));
+        Z(v,  A20(matrix) * x + A21(matrix) * y + A22(matrix) * z + A23(matrix)); // w row is discarded
+        return v;
+    }
+
+    template<concepts::simd_mat44_type M, concepts::read_vec3_type V>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> transform_point( const M& matrix, const V& point )
+    {
+        static_assert( std::same_as<mat_scalar<M>,vec_scalar<V>>, "Scalar type must match for this operation" );
+
+        vec_value<V> v;
+        if ( std::is_constant_evaluated() )
+        {
+            X(v,  A00(matrix) * X(point) + A01(matrix) * Y(point) + A02(matrix) * Z(point) + A03(matrix));
+            Y(v,  A10(matrix) * X(point) + A11(matrix) * Y(point) + A12(matrix) * Z(point) + A13(matrix));
+            Z(v,  A20(matrix) * X(point) + A21(matrix) * Y(point) + A22(matrix) * Z(point) + A23(matrix));
+            return v;
+        }
+
+        using scalar = mat_scalar<M>;
+        simd::pack4<scalar> c0, c1, c2, c3;
+        simd::load_cols(matrix, c0, c1, c2, c3);
+
+        auto r = simd::mul(simd::splat(scalar{X(point)}), c0);
+        r = simd::fmadd(simd::splat(scalar{Y(point)}), c1, r);
+        r = simd::fmadd(simd::splat(scalar{Z(point)}), c2, r);
+        r = simd::add(r, c3);
+
+        alignas(sizeof(simd::pack4<scalar>)) scalar out[4];
+        simd::store_aligned(out, r);
+        X(v,  out[0]);
+        Y(v,  out[1]);
+        Z(v,  out[2]);
+        return v;
+    }
+
+    // Transforms a direction by an affine matrix, the direction has an implied w = 0 so the translation is ignored
+    template<concepts::read_mat44_type M, concepts::read_vec3_type V>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> transform_dir( const M& matrix, const V& direction )
+    {
+        static_assert( std::same_as<mat_scalar<M>,vec_scalar<V>>, "Scalar type must match for this operation" );
+
+        const auto x = X(direction);
+        const auto y = Y(direction);
+        const auto z = Z(direction);
+
+        vec_value<V> v;
+        X(v,  A00(matrix) * x + A01(matrix) * y + A02(matrix) * z);
+        Y(v,  A10(matrix) * x + A11(matrix) * y + A12(matrix) * z);
+        Z(v,  A20(matrix) * x + A21(matrix) * y + A22(matrix) * z);
+        return v;
+    }
+
+    template<concepts::simd_mat44_type M, concepts::read_vec3_type V>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> transform_dir( const M& matrix, const V& direction )
+    {
+        static_assert( std::same_as<mat_scalar<M>,vec_scalar<V>>, "Scalar type must match for this operation" );
+
+        vec_value<V> v;
+        if ( std::is_constant_evaluated() )
+        {
+            X(v,  A00(matrix) * X(direction) + A01(matrix) * Y(direction) + A02(matrix) * Z(direction));
+            Y(v,  A10(matrix) * X(direction) + A11(matrix) * Y(direction) + A12(matrix) * Z(direction));
+            Z(v,  A20(matrix) * X(direction) + A21(matrix) * Y(direction) + A22(matrix) * Z(direction));
+            return v;
+        }
+
+        using scalar = mat_scalar<M>;
+        simd::pack4<scalar> c0, c1, c2, c3;
+        simd::load_cols(matrix, c0, c1, c2, c3);
+
+        auto r = simd::mul(simd::splat(scalar{X(direction)}), c0);
+        r = simd::fmadd(simd::splat(scalar{Y(direction)}), c1, r);
+        r = simd::fmadd(simd::splat(scalar{Z(direction)}), c2, r);
+
+        alignas(sizeof(simd::pack4<scalar>)) scalar out[4];
+        simd::store_aligned(out, r);
+        X(v,  out[0]);
+        Y(v,  out[1]);
+        Z(v,  out[2]);
         return v;
     }
+
+    // vec3 is viewed as a point (w = 1)
+    template<concepts::read_mat44_type M, concepts::read_vec3_type V>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<V> operator*( const M& matrix, const V& vector )
+    {
+        return transform_point(matrix, vector);
+    }
 }
\ No newline at end of file
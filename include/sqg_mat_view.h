@@ -410,8 +410,30 @@ namespace sqg
     {
         return {matrix};
     }
+}
+
+namespace sqg::detail
+{
+    // Element access of a 4x4 matrix or a 3x4 affine matrix, which share the orientation and position views
+    template<typename M>
+    struct affine_traits_of
+    {
+        using type = mat_traits<M>;
+    };
+
+    template<concepts::read_mat34_type M>
+    struct affine_traits_of<M>
+    {
+        using type = mat34_traits<M>;
+    };
+
+    template<typename M>
+    using affine_traits = affine_traits_of<M>::type;
+}
 
-    template<concepts::mat44_type M>
+namespace sqg
+{
+    template<concepts::read_affine_type M>
     struct read_orientation_view
     {
         const M& matrix;
@@ -427,7 +449,7 @@ namespace sqg
         static_assert( concepts::read_mat33_type<read_orientation_view>, "Must Satisfy read mat33 constraints" );
     };
 
-    template<concepts::mat44_type M44>
+    template<concepts::affine_type M44>
     struct orientation_view
     {
         M44& matrix;
@@ -439,6 +461,14 @@ namespace sqg
             return *this;
         }
 
+        // rotation matrix of the quaternion, see sqg_quat_mat.h
+        template<concepts::read_quat_type Q>
+        SQUIGGLE_INLINE constexpr orientation_view& operator=( const Q& quaternion )
+        {
+            assign(*this, quaternion);
+            return *this;
+        }
+
         template<typename R>
         SQUIGGLE_INLINE constexpr operator R() const
         {
@@ -450,46 +480,46 @@ namespace sqg
         static_assert( concepts::mat33_type<orientation_view>, "Must Satisfy mat33 constraints" );
     };
 
-    template<concepts::mat44_type M>
+    template<concepts::affine_type M>
     struct mat_traits<orientation_view<M>>
     {
-        using scalar_type = mat_traits<M>::scalar_type;
+        using scalar_type = detail::affine_traits<M>::scalar_type;
         using type = mat33<scalar_type>;
         using view = orientation_view<M>;
         static constexpr int n_dims = 3;
         
-        template<int row, int col> static SQUIGGLE_INLINE constexpr scalar_type A(const view& m) { return mat_traits<M>::template A<row,col>(m.matrix); }
-        template<int row, int col> static SQUIGGLE_INLINE constexpr scalar_type& A(view& m) { return mat_traits<M>::template A<row,col>(m.matrix); }
+        template<int row, int col> static SQUIGGLE_INLINE constexpr scalar_type A(const view& m) { return detail::affine_traits<M>::template A<row,col>(m.matrix); }
+        template<int row, int col> static SQUIGGLE_INLINE constexpr scalar_type& A(view& m) { return detail::affine_traits<M>::template A<row,col>(m.matrix); }
     };
 
-    template<concepts::mat44_type M44, concepts::read_mat33_type M33>
-    void assign( orientation_view<M44> view, const M33& matrix )
+    template<concepts::affine_type M44, concepts::read_mat33_type M33>
+    SQUIGGLE_INLINE constexpr void assign( orientation_view<M44> view, const M33& matrix )
     {
-        A00(view) = A00(matrix);
-        A01(view) = A01(matrix);
-        A02(view) = A02(matrix);
+        A00(view,  A00(matrix));
+        A01(view,  A01(matrix));
+        A02(view,  A02(matrix));
 
-        A10(view) = A10(matrix);
-        A11(view) = A11(matrix);
-        A12(view) = A12(matrix);
+        A10(view,  A10(matrix));
+        A11(view,  A11(matrix));
+        A12(view,  A12(matrix));
 
-        A20(view) = A20(matrix);
-        A21(view) = A21(matrix);
-        A22(view) = A22(matrix);
+        A20(view,  A20(matrix));
+        A21(view,  A21(matrix));
+        A22(view,  A22(matrix));
     }
 
-    template<concepts::mat44_type M>
+    template<concepts::read_affine_type M>
     struct mat_traits<read_orientation_view<M>>
     {
-        using scalar_type = mat_traits<M>::scalar_type;
+        using scalar_type = detail::affine_traits<M>::scalar_type;
         using type = mat33<scalar_type>;
         using view = read_orientation_view<M>;
         static constexpr int n_dims = 3;
         
-        template<int row, int col> static SQUIGGLE_INLINE constexpr scalar_type A(const view& m) { return mat_traits<M>::template A<row,col>(m.matrix); }
+        template<int row, int col> static SQUIGGLE_INLINE constexpr scalar_type A(const view& m) { return detail::affine_traits<M>::template A<row,col>(m.matrix); }
     };
 
-    template<concepts::mat44_type M>
+    template<concepts::read_affine_type M>
     struct read_position_view
     {
         const M& matrix;
@@ -505,7 +535,7 @@ namespace sqg
         static_assert( concepts::read_vec3_type<read_position_view>, "Must Satisfy read vec3 constraints" );
     };
 
-    template<concepts::mat44_type M44>
+    template<concepts::affine_type M44>
     struct position_view
     {
         M44& matrix;
@@ -528,11 +558,11 @@ namespace sqg
         static_assert( concepts::vec3_type<position_view>, "Must Satisfy read vec3 constraints" );
     };
 
-    template<concepts::read_mat44_type M>
+    template<concepts::read_affine_type M>
     struct vec_traits<read_position_view<M>>
     {
         static constexpr int col = 3;
-        using scalar_type = mat_traits<M>::scalar_type;
+        using scalar_type = detail::affine_traits<M>::scalar_type;
         using type = vec3<scalar_type>;
         using view = read_position_view<M>;
         static constexpr int n_dims = 3;
@@ -542,11 +572,11 @@ namespace sqg
         static SQUIGGLE_INLINE constexpr scalar_type Z(const view& v) { return A<2,col>(v.matrix); }
     };
 
-    template<concepts::mat44_type M>
+    template<concepts::affine_type M>
     struct vec_traits<position_view<M>>
     {
         static constexpr int col = 3;
-        using scalar_type = mat_traits<M>::scalar_type;
+        using scalar_type = detail::affine_traits<M>::scalar_type;
         using type = vec3<scalar_type>;
         using view = position_view<M>;
         static constexpr int n_dims = 3;
@@ -560,25 +590,25 @@ namespace sqg
         static SQUIGGLE_INLINE constexpr void Z(view& v, scalar_type s) { return A<2,col>(v.matrix, s); }
     };
 
-    template<concepts::mat44_type M>
+    template<concepts::read_affine_type M>
     SQUIGGLE_INLINE constexpr read_orientation_view<M> orientation( const M& matrix )
     {
         return {matrix};
     }
 
-    template<concepts::mat44_type M>
+    template<concepts::affine_type M>
     [[nodiscard]] SQUIGGLE_INLINE constexpr orientation_view<M> orientation( M& matrix )
     {
         return {matrix};
     }
 
-    template<concepts::mat44_type M>
+    template<concepts::read_affine_type M>
     [[nodiscard]] SQUIGGLE_INLINE constexpr read_position_view<M> position( const M& matrix )
     {
         return {matrix};
     }
 
-    template<concepts::mat44_type M>
+    template<concepts::affine_type M>
     [[nodiscard]] SQUIGGLE_INLINE constexpr position_view<M> position( M& matrix )
     {
         return {matrix};
@@ -0,0 +1,399 @@
+#pragma once
+#include "sqg_batch.h"
+#include "sqg_concepts.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <execution>
+#include <mutex>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Parallel versions of the span functions in sqg_batch.h. The spans are cut into tiles of about
+// options::tile_bytes and every tile runs the serial function, so each thread still goes through the
+// dispatched kernels. Work runs on an executor, a thread_pool whose threads are started once and reused,
+// a std::execution policy, or any type with concurrency() and bulk(count, f).
+
+namespace sqg::parallel
+{
+    struct options
+    {
+        // bytes read and written per tile, about the size of a core's L2 cache
+        std::size_t tile_bytes = 256 * 1024;
+
+        // spans shorter than this run on the calling thread, where waking the workers costs more than it saves
+        std::size_t cutover = 16 * 1024;
+    };
+}
+
+namespace sqg::concepts
+{
+    // bulk(count, f) calls f(i) once for every i below count, possibly concurrently, and returns when all have finished.
+    // concurrency() is the number of threads bulk can run on, the spans are cut into at least that many tiles.
+    template<typename E>
+    concept executor = requires( E& e, void (*f)(std::size_t) )
+    {
+        { e.concurrency() } -> std::convertible_to<std::size_t>;
+        e.bulk(std::size_t{}, f);
+    };
+}
+
+namespace sqg::parallel
+{
+    // A fixed set of worker threads started by the constructor. bulk hands out indices to the workers and
+    // the calling thread, nothing is allocated or created per call. One bulk runs at a time, a bulk called from
+    // inside a task runs inline on that thread.
+    class thread_pool
+    {
+    public:
+        // threads in total including the calling thread, so threads - 1 workers are started
+        explicit thread_pool( std::size_t threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1) )
+        {
+            workers.reserve(threads > 1 ? threads - 1 : 0);
+            for ( std::size_t i = 1; i < threads; i++ )
+                workers.emplace_back([this]() { work(); });
+        }
+
+        thread_pool( const thread_pool& ) = delete;
+        thread_pool& operator=( const thread_pool& ) = delete;
+
+        ~thread_pool()
+        {
+            {
+                std::lock_guard lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for ( std::thread& worker : workers )
+                worker.join();
+        }
+
+        [[nodiscard]] std::size_t concurrency() const { return workers.size() + 1; }
+
+        // f must not throw
+        template<typename F>
+        void bulk( std::size_t count, F&& f )
+        {
+            if ( workers.empty() || count <= 1 || in_task() )
+            {
+                for ( std::size_t i = 0; i < count; i++ )
+                    f(i);
+                return;
+            }
+
+            std::lock_guard submitting(submit);
+            {
+                std::lock_guard lock(mutex);
+                task = { &f, &invoke<std::remove_reference_t<F>>, count };
+                next.store(0, std::memory_order_relaxed);
+                generation++;
+            }
+            wake.notify_all();
+
+            run(task);
+
+            // the job lives on this stack, wait for every worker to be out of it before returning
+            std::unique_lock lock(mutex);
+            idle.wait(lock, [this]() { return busy == 0; });
+            task = {};
+        }
+
+    private:
+        struct job
+        {
+            const void* f = nullptr;
+            void (*invoke)( const void* f, std::size_t i ) = nullptr;
+            std::size_t count = 0;
+        };
+
+        template<typename F>
+        static void invoke( const void* f, std::size_t i )
+        {
+            ( *static_cast<F*>(const_cast<void*>(f)) )(i);
+        }
+
+        static bool& in_task()
+        {
+            thread_local bool inside = false;
+            return inside;
+        }
+
+        void run( const job& j )
+        {
+            // an empty job must not touch next, the following job may already have reset it
+            if ( j.count == 0 )
+                return;
+
+            in_task() = true;
+            for ( std::size_t i = next.fetch_add(1, std::memory_order_relaxed); i < j.count; i = next.fetch_add(1, std::memory_order_relaxed) )
+                j.invoke(j.f, i);
+            in_task() = false;
+        }
+
+        void work()
+        {
+            std::size_t seen = 0;
+            std::unique_lock lock(mutex);
+            for ( ;; )
+            {
+                wake.wait(lock, [&]() { return stopping || generation != seen; });
+                if ( stopping )
+                    return;
+
+                // copied under the lock, a worker waking after the job finished sees an empty one
+                seen = generation;
+                const job j = task;
+                busy++;
+                lock.unlock();
+
+                run(j);
+
+                lock.lock();
+                if ( --busy == 0 )
+                    idle.notify_all();
+            }
+        }
+
+        std::vector<std::thread> workers;
+        std::mutex submit;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable idle;
+        job task;
+        std::atomic<std::size_t> next{ 0 };
+        std::size_t generation = 0;
+        std::size_t busy = 0;
+        bool stopping = false;
+    };
+
+    // Pool with a thread per hardware thread, started on first use
+    [[nodiscard]] inline thread_pool& default_pool()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+
+    // Runs bulk through a standard parallel algorithm, the threads are the standard library's
+    template<typename Policy>
+    struct policy_executor
+    {
+        static_assert( std::is_execution_policy_v<Policy>, "Must be a std::execution policy" );
+
+        Policy policy;
+
+        [[nodiscard]] std::size_t concurrency() const { return std::max<std::size_t>(std::thread::hardware_concurrency(), 1); }
+
+        template<typename F>
+        void bulk( std::size_t count, F&& f ) const
+        {
+            // the parallel algorithms need forward iterators to real elements, count is the number of tiles and small
+            std::vector<std::size_t> indices(count);
+            std::iota(indices.begin(), indices.end(), std::size_t{0});
+            std::for_each(policy, indices.begin(), indices.end(), [&f]( std::size_t i ) { f(i); });
+        }
+    };
+}
+
+namespace sqg::parallel::detail
+{
+    // executors are used as they are, execution policies are wrapped
+    template<typename E>
+    SQUIGGLE_INLINE decltype(auto) as_executor( E& e )
+    {
+        if constexpr ( std::is_execution_policy_v<std::remove_cvref_t<E>> )
+            return policy_executor<std::remove_cvref_t<E>>{ e };
+        else
+        {
+            static_assert( concepts::executor<E>, "Must be an executor or a std::execution policy" );
+            return ( e );
+        }
+    }
+
+    // Tiles keep a multiple of this many elements so every tile but the last has no kernel tail,
+    // and results match the serial call exactly
+    inline constexpr std::size_t tile_granularity = 64;
+
+    // Calls f(begin, end) for tiles of [0, count) of about tile_bytes, on the calling thread below the cutover
+    // or when the executor has a single thread. Tiles are made smaller when there would be fewer of them
+    // than the executor's threads, so a span of a few tiles still keeps every thread busy.
+    template<typename E, typename F>
+    SQUIGGLE_INLINE void for_tiles( E& executor, std::size_t count, std::size_t element_bytes, const options& opts, F&& f )
+    {
+        if ( count == 0 )
+            return;
+
+        auto&& e = as_executor(executor);
+        const std::size_t threads = e.concurrency();
+        if ( count < opts.cutover || threads <= 1 )
+        {
+            f(std::size_t{0}, count);
+            return;
+        }
+
+        std::size_t tile = std::max<std::size_t>(opts.tile_bytes / element_bytes, 1);
+        tile = std::min(tile, ( count + threads - 1 ) / threads);
+        tile = ( tile + tile_granularity - 1 ) / tile_granularity * tile_granularity;
+        const std::size_t tiles = ( count + tile - 1 ) / tile;
+
+        e.bulk(tiles, [&]( std::size_t t ) {
+            const std::size_t begin = t * tile;
+            f(begin, std::min(begin + tile, count));
+        });
+    }
+
+    // Quaternions and dual quaternions are expanded into a matrix once rather than per tile
+    template<typename M>
+    SQUIGGLE_INLINE auto tile_transform( const M& transform )
+    {
+        if constexpr ( concepts::read_quat_type<M> || concepts::read_dualquat_type<M> )
+            return sqg::detail::transform_value<sqg::detail::transform_scalar<M>>(transform);
+        else
+            return transform;
+    }
+}
+
+namespace sqg::parallel
+{
+    // sqg::transform_points over tiles of points on executor, see sqg_batch.h
+    template<typename E, sqg::detail::vec3_transform M, concepts::vec3_type V>
+    SQUIGGLE_INLINE void transform_points( E&& executor, std::span<const V> points, const M& transform, std::span<V> out, const options& opts = {} )
+    {
+        assert(out.size() >= points.size());
+        const auto t = detail::tile_transform(transform);
+        detail::for_tiles(executor, points.size(), 2 * sizeof(V), opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::transform_points(points.subspan(begin, end - begin), t, out.subspan(begin, end - begin));
+        });
+    }
+
+    template<typename E, sqg::detail::vec3_transform M, concepts::vec3_type V>
+    SQUIGGLE_INLINE void transform_dirs( E&& executor, std::span<const V> directions, const M& transform, std::span<V> out, const options& opts = {} )
+    {
+        assert(out.size() >= directions.size());
+        const auto t = detail::tile_transform(transform);
+        detail::for_tiles(executor, directions.size(), 2 * sizeof(V), opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::transform_dirs(directions.subspan(begin, end - begin), t, out.subspan(begin, end - begin));
+        });
+    }
+
+    template<typename E, concepts::read_quat_type Q, concepts::vec3_type V>
+    SQUIGGLE_INLINE void rotate_many( E&& executor, const Q& quaternion, std::span<V> vectors, const options& opts = {} )
+    {
+        const auto t = detail::tile_transform(quaternion);
+        detail::for_tiles(executor, vectors.size(), 2 * sizeof(V), opts, [&]( std::size_t begin, std::size_t end ) {
+            const std::span<V> tile = vectors.subspan(begin, end - begin);
+            sqg::transform_dirs(std::span<const V>{ tile }, t, tile);
+        });
+    }
+
+    template<typename E, concepts::vec_type V>
+    SQUIGGLE_INLINE void normalize_all( E&& executor, std::span<V> vectors, const options& opts = {} )
+    {
+        detail::for_tiles(executor, vectors.size(), 2 * sizeof(V), opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::normalize_all(vectors.subspan(begin, end - begin));
+        });
+    }
+
+    template<typename E, concepts::vec_type V>
+    SQUIGGLE_INLINE void mag2_all( E&& executor, std::span<const V> vectors, std::span<vec_scalar<V>> out, const options& opts = {} )
+    {
+        assert(out.size() >= vectors.size());
+        detail::for_tiles(executor, vectors.size(), sizeof(V) + sizeof(vec_scalar<V>), opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::mag2_all(vectors.subspan(begin, end - begin), out.subspan(begin, end - begin));
+        });
+    }
+
+    template<typename E, concepts::vec_type V>
+    SQUIGGLE_INLINE void mag_all( E&& executor, std::span<const V> vectors, std::span<vec_scalar<V>> out, const options& opts = {} )
+    {
+        assert(out.size() >= vectors.size());
+        detail::for_tiles(executor, vectors.size(), sizeof(V) + sizeof(vec_scalar<V>), opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::mag_all(vectors.subspan(begin, end - begin), out.subspan(begin, end - begin));
+        });
+    }
+
+    template<typename E, concepts::vec_type V>
+    SQUIGGLE_INLINE void dot_all( E&& executor, std::span<const V> a, std::span<const V> b, std::span<vec_scalar<V>> out, const options& opts = {} )
+    {
+        assert(a.size() == b.size() && out.size() >= a.size());
+        detail::for_tiles(executor, a.size(), 2 * sizeof(V) + sizeof(vec_scalar<V>), opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::dot_all(a.subspan(begin, end - begin), b.subspan(begin, end - begin), out.subspan(begin, end - begin));
+        });
+    }
+
+    template<typename E, concepts::quat_type Q>
+    SQUIGGLE_INLINE void compose_all( E&& executor, std::span<const Q> a, std::span<const Q> b, std::span<Q> out, const options& opts = {} )
+    {
+        assert(a.size() == b.size() && out.size() >= a.size());
+        detail::for_tiles(executor, a.size(), 3 * sizeof(Q), opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::compose_all(a.subspan(begin, end - begin), b.subspan(begin, end - begin), out.subspan(begin, end - begin));
+        });
+    }
+
+    template<typename E, concepts::read_quat_type R, concepts::quat_type Q>
+    SQUIGGLE_INLINE void premultiply_all( E&& executor, const R& quaternion, std::span<Q> quaternions, const options& opts = {} )
+    {
+        detail::for_tiles(executor, quaternions.size(), 2 * sizeof(Q), opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::premultiply_all(quaternion, quaternions.subspan(begin, end - begin));
+        });
+    }
+
+    template<typename E, concepts::read_quat_type Q, sqg::detail::rotation_mat M>
+    SQUIGGLE_INLINE void convert_all( E&& executor, std::span<const Q> quaternions, std::span<M> matrices, const options& opts = {} )
+    {
+        assert(matrices.size() >= quaternions.size());
+        detail::for_tiles(executor, quaternions.size(), sizeof(Q) + sizeof(M), opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::convert_all(quaternions.subspan(begin, end - begin), matrices.subspan(begin, end - begin));
+        });
+    }
+
+    template<typename E, sqg::detail::read_rotation_mat M, concepts::quat_type Q>
+    SQUIGGLE_INLINE void convert_all( E&& executor, std::span<const M> matrices, std::span<Q> quaternions, const options& opts = {} )
+    {
+        assert(quaternions.size() >= matrices.size());
+        detail::for_tiles(executor, matrices.size(), sizeof(Q) + sizeof(M), opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::convert_all(matrices.subspan(begin, end - begin), quaternions.subspan(begin, end - begin));
+        });
+    }
+
+    template<typename E, concepts::dualquat_type D>
+    SQUIGGLE_INLINE void compose_all( E&& executor, std::span<const D> a, std::span<const D> b, std::span<D> out, const options& opts = {} )
+    {
+        assert(a.size() == b.size() && out.size() >= a.size());
+        detail::for_tiles(executor, a.size(), 3 * sizeof(D), opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::compose_all(a.subspan(begin, end - begin), b.subspan(begin, end - begin), out.subspan(begin, end - begin));
+        });
+    }
+
+    template<typename E, concepts::dualquat_type D>
+    SQUIGGLE_INLINE void normalize_all( E&& executor, std::span<D> dualquats, const options& opts = {} )
+    {
+        detail::for_tiles(executor, dualquats.size(), 2 * sizeof(D), opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::normalize_all(dualquats.subspan(begin, end - begin));
+        });
+    }
+
+    template<typename E, concepts::dualquat_type D>
+    SQUIGGLE_INLINE void dlb_all( E&& executor, std::span<const D> a, std::span<const D> b, dualquat_scalar<D> t, std::span<D> out, const options& opts = {} )
+    {
+        assert(a.size() == b.size() && out.size() >= a.size());
+        detail::for_tiles(executor, a.size(), 3 * sizeof(D), opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::dlb_all(a.subspan(begin, end - begin), b.subspan(begin, end - begin), t, out.subspan(begin, end - begin));
+        });
+    }
+
+    template<typename E, concepts::read_dualquat_type D, concepts::affine_type M>
+    SQUIGGLE_INLINE void convert_all( E&& executor, std::span<const D> dualquats, std::span<M> matrices, const options& opts = {} )
+    {
+        assert(matrices.size() >= dualquats.size());
+        detail::for_tiles(executor, dualquats.size(), sizeof(D) + sizeof(M), opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::convert_all(dualquats.subspan(begin, end - begin), matrices.subspan(begin, end - begin));
+        });
+    }
+}
@@ -2,6 +2,8 @@
 #include "sqg_struct.h"
 #include "sqg_concepts.h"
 #include "sqg_vec.h"
+#include "sqg_simd.h"
+#include <type_traits>
 
 namespace sqg
 {
@@ -32,7 +34,7 @@ namespace sqg
         Z(quaternion,  scalar{0});
     }
 
-    template<std::floating_point T>
+    template<concepts::real_scalar T>
     SQUIGGLE_INLINE constexpr quat<T> identity_quat()
     {
         return quat<T>{}; // since sqg::quat is already initialised to identity quaternion
@@ -89,6 +91,49 @@ namespace sqg
         return q;
     }
 
+    template<concepts::simd_quat_type Q>
+    SQUIGGLE_INLINE constexpr vec_value<Q> operator*( const Q& q0, const Q& q1 )
+    {
+        vec_value<Q> q;
+        if ( std::is_constant_evaluated() )
+        {
+            W(q,  W(q0) * W(q1) - X(q0) * X(q1) - Y(q0) * Y(q1) - Z(q0) * Z(q1));
+            X(q,  W(q0) * X(q1) + X(q0) * W(q1) + Y(q0) * Z(q1) - Z(q0) * Y(q1));
+            Y(q,  W(q0) * Y(q1) + Y(q0) * W(q1) + Z(q0) * X(q1) - X(q0) * Z(q1));
+            Z(q,  W(q0) * Z(q1) + Z(q0) * W(q1) + X(q0) * Y(q1) - Y(q0) * X(q1));
+            return q;
+        }
+
+        // Same product as above written per lane of q1, each component of q0 is broadcast
+        // against a signed permutation of q1 so the whole product is four multiply-adds.
+        //
+        // w,x,y,z lanes
+        // q = w0 * ( w1, x1, y1, z1)
+        //   + x0 * (-x1, w1,-z1, y1)
+        //   + y0 * (-y1, z1, w1,-x1)
+        //   + z0 * (-z1,-y1, x1, w1)
+        using scalar = vec_scalar<Q>;
+        const auto b = simd::load_vec(q1);
+
+        auto r = simd::mul(simd::splat(scalar{W(q0)}), b);
+        if constexpr ( vec_traits<Q>::simd_w_lane == 0 )
+        {
+            r = simd::fmadd(simd::splat(scalar{X(q0)}), simd::negate<true,false,true,false>(simd::shuffle<1,0,3,2>(b)), r);
+            r = simd::fmadd(simd::splat(scalar{Y(q0)}), simd::negate<true,false,false,true>(simd::shuffle<2,3,0,1>(b)), r);
+            r = simd::fmadd(simd::splat(scalar{Z(q0)}), simd::negate<true,true,false,false>(simd::shuffle<3,2,1,0>(b)), r);
+        }
+        else
+        {
+            static_assert( vec_traits<Q>::simd_w_lane == 3, "Quaternion lanes must be w,x,y,z or x,y,z,w" );
+            r = simd::fmadd(simd::splat(scalar{X(q0)}), simd::negate<false,true,false,true>(simd::shuffle<3,2,1,0>(b)), r);
+            r = simd::fmadd(simd::splat(scalar{Y(q0)}), simd::negate<false,false,true,true>(simd::shuffle<2,3,0,1>(b)), r);
+            r = simd::fmadd(simd::splat(scalar{Z(q0)}), simd::negate<true,false,false,true>(simd::shuffle<1,0,3,2>(b)), r);
+        }
+
+        simd::store_vec(q, r);
+        return q;
+    }
+
     template<concepts::quat_type Q, concepts::read_vec3_type V>
     SQUIGGLE_INLINE constexpr vec_value<V> operator*( const Q& quaternion, const V& vector )
     {
@@ -141,10 +186,9 @@ namespace sqg
     SQUIGGLE_INLINE constexpr void set_rotx(Q& quaternion, vec_scalar<Q> angle )
     {
         using scalar = vec_scalar<Q>;
+        const auto [sina2, cosa2] = math::sincos(angle / scalar{2});
 
-        W(quaternion,  std::cos(angle / scalar{2}));
-        
-        const auto sina2 = std::sin(angle / scalar{2});
+        W(quaternion,  cosa2);
         X(quaternion,  sina2);
         Y(quaternion,  scalar{0});
         Z(quaternion,  scalar{0});
@@ -154,9 +198,9 @@ namespace sqg
     SQUIGGLE_INLINE constexpr void set_roty(Q& quaternion, vec_scalar<Q> angle )
     {
         using scalar = vec_scalar<Q>;
-        W(quaternion,  std::cos(angle / scalar{2}));
-        
-        const auto sina2 = std::sin(angle / scalar{2});
+        const auto [sina2, cosa2] = math::sincos(angle / scalar{2});
+
+        W(quaternion,  cosa2);
         X(quaternion,  scalar{0});
         Y(quaternion,  sina2);
         Z(quaternion,  scalar{0});
@@ -166,9 +210,9 @@ namespace sqg
     SQUIGGLE_INLINE constexpr void set_rotz(Q& quaternion, vec_scalar<Q> angle )
     {
         using scalar = vec_scalar<Q>;
-        W(quaternion,  std::cos(angle / scalar{2}));
-        
-        const auto sina2 = std::sin(angle / scalar{2});
+        const auto [sina2, cosa2] = math::sincos(angle / scalar{2});
+
+        W(quaternion,  cosa2);
         X(quaternion,  scalar{0});
         Y(quaternion,  scalar{0});
         Z(quaternion,  sina2);
@@ -188,15 +232,15 @@ namespace sqg
         const scalar y = Y(axis);
         const scalar z = Z(axis);
 
-        W(quaternion,   std::cos(angle));
-        
-        const auto sina2 = std::sin(angle);
+        const auto [sina2, cosa2] = math::sincos(angle);
+
+        W(quaternion,   cosa2);
         X(quaternion,   x * sina2);
         Y(quaternion,   y * sina2);
         Z(quaternion,   z * sina2);
     }
 
-    template<std::floating_point T>
+    template<concepts::real_scalar T>
     SQUIGGLE_INLINE constexpr quat<T> rotx_quat( T angle )
     {   
         quat<T> q;        
@@ -204,7 +248,7 @@ namespace sqg
         return q;
     }
 
-    template<std::floating_point T>
+    template<concepts::real_scalar T>
     SQUIGGLE_INLINE constexpr quat<T> roty_quat( T angle )
     {   
         quat<T> q;       
@@ -212,7 +256,7 @@ namespace sqg
         return q;
     }
 
-    template<std::floating_point T>
+    template<concepts::real_scalar T>
     SQUIGGLE_INLINE constexpr quat<T> rotz_quat( T angle )
     {   
         quat<T> q;  
@@ -224,7 +268,7 @@ namespace sqg
     SQUIGGLE_INLINE constexpr quat<vec_scalar<V>> rot_quat( const V& vector, vec_scalar<V> angle )
     {
         quat<vec_scalar<V>> q;
-        set_quat(q, vector, angle);
+        set_rot(q, vector, angle);
         return q;
     }
 }
\ No newline at end of file
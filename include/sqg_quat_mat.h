@@ -0,0 +1,122 @@
+#pragma once
+#include "sqg_concepts.h"
+#include "sqg_mat_view.h"
+#include "sqg_mat33.h"
+#include "sqg_quat.h"
+#include "sqg_scalar.h"
+#include "sqg_traits.h"
+#include <algorithm>
+#include <concepts>
+
+// Conversions between quaternions and rotation matrices, through assign and convert_to like any other
+// pair of types. The matrix of a quaternion rotates a vector the same way, matrix * v == quaternion * v.
+// Both are constexpr, so rotations can be written once as a matrix and the quaternion derived at compile time.
+
+namespace sqg::detail
+{
+    template<typename M, typename Q>
+    SQUIGGLE_INLINE constexpr void quat_to_mat33( M& matrix, const Q& quaternion )
+    {
+        using scalar = vec_scalar<Q>;
+
+        const scalar w = W(quaternion);
+        const scalar x = X(quaternion);
+        const scalar y = Y(quaternion);
+        const scalar z = Z(quaternion);
+
+        const scalar xx = x * x;
+        const scalar yy = y * y;
+        const scalar zz = z * z;
+
+        const scalar xy = x * y;
+        const scalar zw = z * w;
+        const scalar xz = x * z;
+        const scalar yw = y * w;
+        const scalar yz = y * z;
+        const scalar xw = x * w;
+
+        constexpr scalar one{1};
+        constexpr scalar two{2};
+
+        A00(matrix,  one - two * ( yy + zz ));
+        A01(matrix,  two * ( xy - zw ));
+        A02(matrix,  two * ( xz + yw ));
+
+        A10(matrix,  two * ( xy + zw ));
+        A11(matrix,  one - two * ( xx + zz ));
+        A12(matrix,  two * ( yz - xw ));
+
+        A20(matrix,  two * ( xz - yw ));
+        A21(matrix,  two * ( yz + xw ));
+        A22(matrix,  one - two * ( xx + yy ));
+    }
+}
+
+namespace sqg
+{
+    // Rotation matrix of a quaternion, quaternion is expected to be normalised
+    template<concepts::mat33_type M, concepts::read_quat_type Q>
+    SQUIGGLE_INLINE constexpr void assign( M& matrix, const Q& quaternion )
+    {
+        static_assert( std::convertible_to<vec_scalar<Q>, mat_scalar<M>>, "Source Scalar must be convertible to Destination Scalar" );
+        detail::quat_to_mat33(matrix, quaternion);
+    }
+
+    // Writes the orientation of a 4x4 or 3x4 matrix, the translation and last row are left alone
+    template<concepts::affine_type M44, concepts::read_quat_type Q>
+    SQUIGGLE_INLINE constexpr void assign( orientation_view<M44> view, const Q& quaternion )
+    {
+        static_assert( std::convertible_to<vec_scalar<Q>, typename detail::affine_traits<M44>::scalar_type>, "Source Scalar must be convertible to Destination Scalar" );
+        detail::quat_to_mat33(view, quaternion);
+    }
+
+    // Quaternion of a rotation matrix, matrix is expected to be orthonormal with determinant 1.
+    // Shepperd's method, the largest of |w|, |x|, |y| and |z| is found from the trace and diagonal and
+    // taken from a square root, the other three are divided by it. No component comes from the square root
+    // of a small difference so the result keeps full precision for every rotation, including 180 degrees.
+    // The largest component is positive, w >= 0 whenever the rotation is 90 degrees or less.
+    template<concepts::quat_type Q, concepts::read_mat33_type M>
+    SQUIGGLE_INLINE constexpr void assign( Q& quaternion, const M& matrix )
+    {
+        static_assert( std::convertible_to<mat_scalar<M>, vec_scalar<Q>>, "Source Scalar must be convertible to Destination Scalar" );
+        using scalar = mat_scalar<M>;
+
+        constexpr scalar one{1};
+        constexpr scalar half{0.5};
+
+        const scalar d0 = A00(matrix);
+        const scalar d1 = A11(matrix);
+        const scalar d2 = A22(matrix);
+        const scalar trace = d0 + d1 + d2;
+
+        // 4w^2 = 1 + trace and 4x^2 = 1 + 2 * A00 - trace, likewise for y and z
+        const scalar largest = std::max(std::max(trace, d0), std::max(d1, d2));
+        const scalar r = math::sqrt(one + ( largest + largest ) - trace);
+        const scalar h = half * r;
+        const scalar s = half / r;
+
+        const scalar wx = ( A21(matrix) - A12(matrix) ) * s;
+        const scalar wy = ( A02(matrix) - A20(matrix) ) * s;
+        const scalar wz = ( A10(matrix) - A01(matrix) ) * s;
+        const scalar xy = ( A01(matrix) + A10(matrix) ) * s;
+        const scalar xz = ( A02(matrix) + A20(matrix) ) * s;
+        const scalar yz = ( A12(matrix) + A21(matrix) ) * s;
+
+        if ( trace >= largest )
+        {
+            W(quaternion, h);  X(quaternion, wx); Y(quaternion, wy); Z(quaternion, wz);
+        }
+        else if ( d0 >= largest )
+        {
+            W(quaternion, wx); X(quaternion, h);  Y(quaternion, xy); Z(quaternion, xz);
+        }
+        else if ( d1 >= largest )
+        {
+            W(quaternion, wy); X(quaternion, xy); Y(quaternion, h);  Z(quaternion, yz);
+        }
+        else
+        {
+            W(quaternion, wz); X(quaternion, xz); Y(quaternion, yz); Z(quaternion, h);
+        }
+    }
+}
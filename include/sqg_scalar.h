@@ -0,0 +1,145 @@
+#pragma once
+#include "sqg_concepts.h"
+#include "sqg_simd.h"
+#include "sqg_trig.h"
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+namespace sqg::detail
+{
+    // Newton-Raphson square root for constant evaluation, std::sqrt is not constexpr before C++26.
+    // Iterates in a wider type from above the root until it no longer decreases, then rounds once,
+    // which gives the correctly rounded float and matches std::sqrt for double in all but rare cases.
+    template<std::floating_point T>
+    constexpr T constexpr_sqrt( T s )
+    {
+        using wide = std::conditional_t<sizeof(T) < sizeof(double), double, long double>;
+
+        if ( !( s >= T{0} ) )
+            return std::numeric_limits<T>::quiet_NaN();
+        if ( s == T{0} || s == std::numeric_limits<T>::infinity() )
+            return s;
+
+        const wide v = s;
+        wide x = v > wide{1} ? v : wide{1};
+        for ( ;; )
+        {
+            const wide next = wide{0.5} * ( x + v / x );
+            if ( !( next < x ) )
+                return static_cast<T>(x);
+            x = next;
+        }
+    }
+}
+
+namespace sqg
+{
+    // Every sqrt, sin and cos in the library goes through scalar_traits so that scalar types other than
+    // float and double can be used. Specialise it for your own scalar, see sqg_wide.h for an example.
+    //
+    // sincos and rsqrt_estimate are optional, scalars without them use sin and cos separately
+    // and 1 / sqrt wherever an estimate is asked for. atan2 is only needed by sclerp.
+    template<std::floating_point T>
+    struct scalar_traits<T>
+    {
+        using backend = SQUIGGLE_TRIG_BACKEND;
+
+        static SQUIGGLE_INLINE constexpr T sqrt( T s )
+        {
+            if ( std::is_constant_evaluated() )
+                return detail::constexpr_sqrt(s);
+            return std::sqrt(s);
+        }
+
+        static SQUIGGLE_INLINE T sin( T s ) { return backend::sin(s); }
+        static SQUIGGLE_INLINE T cos( T s ) { return backend::cos(s); }
+        static SQUIGGLE_INLINE trig::sincos_result<T> sincos( T s ) { return backend::sincos(s); }
+        static SQUIGGLE_INLINE T atan2( T y, T x ) { return std::atan2(y, x); }
+
+        // hardware estimate with relative error below 1.5 * 2^-12, evaluated in single precision
+        // so s must be in the normal float range
+        static SQUIGGLE_INLINE T rsqrt_estimate( T s )
+        {
+#if defined(SQUIGGLE_SSE2)
+            return static_cast<T>(_mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(static_cast<float>(s)))));
+#else
+            return T{1} / std::sqrt(s);
+#endif
+        }
+    };
+}
+
+namespace sqg::math
+{
+    template<concepts::real_scalar T> [[nodiscard]] SQUIGGLE_INLINE constexpr T sqrt( const T& s ) { return scalar_traits<T>::sqrt(s); }
+    template<concepts::real_scalar T> [[nodiscard]] SQUIGGLE_INLINE constexpr T sin( const T& s ) { return scalar_traits<T>::sin(s); }
+    template<concepts::real_scalar T> [[nodiscard]] SQUIGGLE_INLINE constexpr T cos( const T& s ) { return scalar_traits<T>::cos(s); }
+    template<concepts::real_scalar T> [[nodiscard]] SQUIGGLE_INLINE constexpr T atan2( const T& y, const T& x ) { return scalar_traits<T>::atan2(y, x); }
+
+    // sin and cos of the same angle, in one evaluation when the scalar's backend supports it
+    template<concepts::real_scalar T>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr trig::sincos_result<T> sincos( const T& angle )
+    {
+        if constexpr ( requires { { scalar_traits<T>::sincos(angle) } -> std::convertible_to<trig::sincos_result<T>>; } )
+            return scalar_traits<T>::sincos(angle);
+        else
+            return { scalar_traits<T>::sin(angle), scalar_traits<T>::cos(angle) };
+    }
+
+    // Batch sincos over many angles, sines and cosines must be at least as long as angles.
+    // Backend defaults to the one scalar_traits uses, trig::polynomial has no branches so the loop can vectorise.
+    template<typename Backend = SQUIGGLE_TRIG_BACKEND, std::floating_point T>
+    SQUIGGLE_INLINE void sincos( std::span<const T> angles, std::span<T> sines, std::span<T> cosines )
+    {
+        assert(sines.size() >= angles.size() && cosines.size() >= angles.size());
+        for ( std::size_t i = 0; i < angles.size(); i++ )
+        {
+            const trig::sincos_result<T> r = Backend::sincos(angles[i]);
+            sines[i] = r.sin;
+            cosines[i] = r.cos;
+        }
+    }
+
+    // One Newton-Raphson step for 1 / sqrt(s), roughly doubles the number of correct bits of y
+    template<concepts::real_scalar T>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr T rsqrt_refine( const T& s, const T& y )
+    {
+        const T half = T{0.5} * s;
+        return y * ( T{1.5} - half * y * y );
+    }
+
+    // Approximate 1 / sqrt(s) from the hardware estimate followed by refinements Newton steps.
+    // Max error in ulp, for double the estimate is only single precision so more steps are needed.
+    //
+    //  refinements | float | double
+    //  0           | 6144  | 2^-12 relative
+    //  1           | 4     | 2^-21 relative
+    //  2           | 2     | 256
+    //  3           | 2     | 2
+    //
+    // Exact when constant evaluated or when there is no estimate instruction.
+    template<int refinements = 1, concepts::real_scalar T>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr T rsqrt_fast( const T& s )
+    {
+        static_assert( refinements >= 0 && refinements <= 3, "rsqrt_fast supports 0 to 3 refinements" );
+        if ( std::is_constant_evaluated() )
+            return T{1} / sqrt(s);
+
+        if constexpr ( requires { { scalar_traits<T>::rsqrt_estimate(s) } -> std::convertible_to<T>; } )
+        {
+            T y = scalar_traits<T>::rsqrt_estimate(s);
+            for ( int i = 0; i < refinements; i++ )
+                y = rsqrt_refine(s, y);
+            return y;
+        }
+        else
+        {
+            return T{1} / sqrt(s);
+        }
+    }
+}
@@ -0,0 +1,337 @@
+#pragma once
+#include "sqg_concepts.h"
+#include <concepts>
+#include <cmath>
+
+// Instruction set detection, these follow whatever the consumer compiles with (-march, /arch).
+// Define SQUIGGLE_NO_SIMD to force the portable scalar fallback.
+#if !defined(SQUIGGLE_NO_SIMD)
+#   if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#       define SQUIGGLE_SSE2 1
+#   endif
+#   if defined(SQUIGGLE_SSE2) && ( defined(__SSE4_1__) || defined(__AVX__) )
+#       define SQUIGGLE_SSE41 1
+#   endif
+#   if defined(SQUIGGLE_SSE2) && defined(__AVX__)
+#       define SQUIGGLE_AVX 1
+#   endif
+#   if defined(SQUIGGLE_SSE2) && ( defined(__FMA__) || ( defined(_MSC_VER) && defined(__AVX2__) ) )
+#       define SQUIGGLE_FMA 1
+#   endif
+#endif
+
+#if defined(SQUIGGLE_SSE2)
+#   include <immintrin.h>
+#endif
+
+namespace sqg::simd
+{
+    // Four lanes of T held in registers, the generic version is a plain array
+    // and is used whenever there is no native implementation for T.
+    template<typename T>
+    struct pack4
+    {
+        T v[4];
+    };
+
+    template<typename T> SQUIGGLE_INLINE pack4<T> load( const T* p ) { return { p[0], p[1], p[2], p[3] }; }
+    template<typename T> SQUIGGLE_INLINE pack4<T> load_aligned( const T* p ) { return load(p); }
+    template<typename T> SQUIGGLE_INLINE void store( T* p, pack4<T> a ) { p[0] = a.v[0]; p[1] = a.v[1]; p[2] = a.v[2]; p[3] = a.v[3]; }
+    template<typename T> SQUIGGLE_INLINE void store_aligned( T* p, pack4<T> a ) { store(p, a); }
+    template<typename T> SQUIGGLE_INLINE pack4<T> splat( T s ) { return { s, s, s, s }; }
+
+    template<typename T> SQUIGGLE_INLINE pack4<T> add( pack4<T> a, pack4<T> b ) { return { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] }; }
+    template<typename T> SQUIGGLE_INLINE pack4<T> sub( pack4<T> a, pack4<T> b ) { return { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] }; }
+    template<typename T> SQUIGGLE_INLINE pack4<T> mul( pack4<T> a, pack4<T> b ) { return { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] }; }
+    template<typename T> SQUIGGLE_INLINE pack4<T> div( pack4<T> a, pack4<T> b ) { return { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] }; }
+    template<typename T> SQUIGGLE_INLINE pack4<T> sqrt( pack4<T> a ) { return { std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3]) }; }
+
+    // a * b + c
+    template<typename T> SQUIGGLE_INLINE pack4<T> fmadd( pack4<T> a, pack4<T> b, pack4<T> c ) { return add(mul(a, b), c); }
+
+    // v[0] + v[1] + v[2] + v[3]
+    template<typename T> SQUIGGLE_INLINE T hsum( pack4<T> a ) { return ( a.v[0] + a.v[1] ) + ( a.v[2] + a.v[3] ); }
+
+    // lane 0
+    template<typename T> SQUIGGLE_INLINE T first( pack4<T> a ) { return a.v[0]; }
+
+    // lane i of the result is lane i# of a
+    template<int i0, int i1, int i2, int i3, typename T>
+    SQUIGGLE_INLINE pack4<T> shuffle( pack4<T> a ) { return { a.v[i0], a.v[i1], a.v[i2], a.v[i3] }; }
+
+    // negates lane i when n# is true
+    template<bool n0, bool n1, bool n2, bool n3, typename T>
+    SQUIGGLE_INLINE pack4<T> negate( pack4<T> a ) { return { n0 ? -a.v[0] : a.v[0], n1 ? -a.v[1] : a.v[1], n2 ? -a.v[2] : a.v[2], n3 ? -a.v[3] : a.v[3] }; }
+
+    // transposes the 4x4 block held in r0..r3 in place, rows become columns
+    template<typename T>
+    SQUIGGLE_INLINE void transpose( pack4<T>& r0, pack4<T>& r1, pack4<T>& r2, pack4<T>& r3 )
+    {
+        const pack4<T> c0 = { r0.v[0], r1.v[0], r2.v[0], r3.v[0] };
+        const pack4<T> c1 = { r0.v[1], r1.v[1], r2.v[1], r3.v[1] };
+        const pack4<T> c2 = { r0.v[2], r1.v[2], r2.v[2], r3.v[2] };
+        const pack4<T> c3 = { r0.v[3], r1.v[3], r2.v[3], r3.v[3] };
+        r0 = c0; r1 = c1; r2 = c2; r3 = c3;
+    }
+
+#if defined(SQUIGGLE_SSE2)
+
+    // float - SSE
+    template<>
+    struct pack4<float>
+    {
+        __m128 v;
+    };
+
+    SQUIGGLE_INLINE pack4<float> load( const float* p ) { return { _mm_loadu_ps(p) }; }
+    SQUIGGLE_INLINE pack4<float> load_aligned( const float* p ) { return { _mm_load_ps(p) }; }
+    SQUIGGLE_INLINE void store( float* p, pack4<float> a ) { _mm_storeu_ps(p, a.v); }
+    SQUIGGLE_INLINE void store_aligned( float* p, pack4<float> a ) { _mm_store_ps(p, a.v); }
+    SQUIGGLE_INLINE pack4<float> splat( float s ) { return { _mm_set1_ps(s) }; }
+
+    SQUIGGLE_INLINE pack4<float> add( pack4<float> a, pack4<float> b ) { return { _mm_add_ps(a.v, b.v) }; }
+    SQUIGGLE_INLINE pack4<float> sub( pack4<float> a, pack4<float> b ) { return { _mm_sub_ps(a.v, b.v) }; }
+    SQUIGGLE_INLINE pack4<float> mul( pack4<float> a, pack4<float> b ) { return { _mm_mul_ps(a.v, b.v) }; }
+    SQUIGGLE_INLINE pack4<float> div( pack4<float> a, pack4<float> b ) { return { _mm_div_ps(a.v, b.v) }; }
+    SQUIGGLE_INLINE pack4<float> sqrt( pack4<float> a ) { return { _mm_sqrt_ps(a.v) }; }
+
+    SQUIGGLE_INLINE pack4<float> fmadd( pack4<float> a, pack4<float> b, pack4<float> c )
+    {
+#if defined(SQUIGGLE_FMA)
+        return { _mm_fmadd_ps(a.v, b.v, c.v) };
+#else
+        return { _mm_add_ps(_mm_mul_ps(a.v, b.v), c.v) };
+#endif
+    }
+
+    SQUIGGLE_INLINE float first( pack4<float> a ) { return _mm_cvtss_f32(a.v); }
+
+    SQUIGGLE_INLINE float hsum( pack4<float> a )
+    {
+        const __m128 swapped = _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(2,3,0,1)); // 1 0 3 2
+        const __m128 pairs = _mm_add_ps(a.v, swapped);                          // 0+1 0+1 2+3 2+3
+        const __m128 high = _mm_movehl_ps(swapped, pairs);                      // 2+3
+        return _mm_cvtss_f32(_mm_add_ss(pairs, high));
+    }
+
+    template<int i0, int i1, int i2, int i3>
+    SQUIGGLE_INLINE pack4<float> shuffle( pack4<float> a ) { return { _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(i3,i2,i1,i0)) }; }
+
+    template<bool n0, bool n1, bool n2, bool n3>
+    SQUIGGLE_INLINE pack4<float> negate( pack4<float> a )
+    {
+        const __m128 mask = _mm_set_ps(n3 ? -0.0f : 0.0f, n2 ? -0.0f : 0.0f, n1 ? -0.0f : 0.0f, n0 ? -0.0f : 0.0f);
+        return { _mm_xor_ps(a.v, mask) };
+    }
+
+    SQUIGGLE_INLINE void transpose( pack4<float>& r0, pack4<float>& r1, pack4<float>& r2, pack4<float>& r3 )
+    {
+        _MM_TRANSPOSE4_PS(r0.v, r1.v, r2.v, r3.v);
+    }
+
+#if defined(SQUIGGLE_AVX)
+
+    // double - AVX, all four lanes in one register
+    template<>
+    struct pack4<double>
+    {
+        __m256d v;
+    };
+
+    SQUIGGLE_INLINE pack4<double> load( const double* p ) { return { _mm256_loadu_pd(p) }; }
+    SQUIGGLE_INLINE pack4<double> load_aligned( const double* p ) { return { _mm256_load_pd(p) }; }
+    SQUIGGLE_INLINE void store( double* p, pack4<double> a ) { _mm256_storeu_pd(p, a.v); }
+    SQUIGGLE_INLINE void store_aligned( double* p, pack4<double> a ) { _mm256_store_pd(p, a.v); }
+    SQUIGGLE_INLINE pack4<double> splat( double s ) { return { _mm256_set1_pd(s) }; }
+
+    SQUIGGLE_INLINE pack4<double> add( pack4<double> a, pack4<double> b ) { return { _mm256_add_pd(a.v, b.v) }; }
+    SQUIGGLE_INLINE pack4<double> sub( pack4<double> a, pack4<double> b ) { return { _mm256_sub_pd(a.v, b.v) }; }
+    SQUIGGLE_INLINE pack4<double> mul( pack4<double> a, pack4<double> b ) { return { _mm256_mul_pd(a.v, b.v) }; }
+    SQUIGGLE_INLINE pack4<double> div( pack4<double> a, pack4<double> b ) { return { _mm256_div_pd(a.v, b.v) }; }
+    SQUIGGLE_INLINE pack4<double> sqrt( pack4<double> a ) { return { _mm256_sqrt_pd(a.v) }; }
+
+    SQUIGGLE_INLINE pack4<double> fmadd( pack4<double> a, pack4<double> b, pack4<double> c )
+    {
+#if defined(SQUIGGLE_FMA)
+        return { _mm256_fmadd_pd(a.v, b.v, c.v) };
+#else
+        return { _mm256_add_pd(_mm256_mul_pd(a.v, b.v), c.v) };
+#endif
+    }
+
+    SQUIGGLE_INLINE double first( pack4<double> a ) { return _mm256_cvtsd_f64(a.v); }
+
+    SQUIGGLE_INLINE double hsum( pack4<double> a )
+    {
+        const __m128d low = _mm256_castpd256_pd128(a.v);
+        const __m128d high = _mm256_extractf128_pd(a.v, 1);
+        const __m128d pairs = _mm_add_pd(_mm_unpacklo_pd(low, high), _mm_unpackhi_pd(low, high)); // 0+1 2+3
+        return _mm_cvtsd_f64(_mm_add_sd(pairs, _mm_unpackhi_pd(pairs, pairs)));
+    }
+
+    template<int i0, int i1, int i2, int i3>
+    SQUIGGLE_INLINE pack4<double> shuffle( pack4<double> a )
+    {
+#if defined(__AVX2__)
+        return { _mm256_permute4x64_pd(a.v, _MM_SHUFFLE(i3,i2,i1,i0)) };
+#else
+        const __m128d low = _mm256_castpd256_pd128(a.v);
+        const __m128d high = _mm256_extractf128_pd(a.v, 1);
+        const __m128d r0 = _mm_shuffle_pd(i0 < 2 ? low : high, i1 < 2 ? low : high, (i0 & 1) | ((i1 & 1) << 1));
+        const __m128d r1 = _mm_shuffle_pd(i2 < 2 ? low : high, i3 < 2 ? low : high, (i2 & 1) | ((i3 & 1) << 1));
+        return { _mm256_insertf128_pd(_mm256_castpd128_pd256(r0), r1, 1) };
+#endif
+    }
+
+    template<bool n0, bool n1, bool n2, bool n3>
+    SQUIGGLE_INLINE pack4<double> negate( pack4<double> a )
+    {
+        const __m256d mask = _mm256_set_pd(n3 ? -0.0 : 0.0, n2 ? -0.0 : 0.0, n1 ? -0.0 : 0.0, n0 ? -0.0 : 0.0);
+        return { _mm256_xor_pd(a.v, mask) };
+    }
+
+    SQUIGGLE_INLINE void transpose( pack4<double>& r0, pack4<double>& r1, pack4<double>& r2, pack4<double>& r3 )
+    {
+        const __m256d t0 = _mm256_unpacklo_pd(r0.v, r1.v); // 00 10 02 12
+        const __m256d t1 = _mm256_unpackhi_pd(r0.v, r1.v); // 01 11 03 13
+        const __m256d t2 = _mm256_unpacklo_pd(r2.v, r3.v); // 20 30 22 32
+        const __m256d t3 = _mm256_unpackhi_pd(r2.v, r3.v); // 21 31 23 33
+        r0.v = _mm256_permute2f128_pd(t0, t2, 0x20);
+        r1.v = _mm256_permute2f128_pd(t1, t3, 0x20);
+        r2.v = _mm256_permute2f128_pd(t0, t2, 0x31);
+        r3.v = _mm256_permute2f128_pd(t1, t3, 0x31);
+    }
+
+#else
+
+    // double - SSE2, lanes 0,1 in low and 2,3 in high
+    template<>
+    struct pack4<double>
+    {
+        __m128d low;
+        __m128d high;
+    };
+
+    SQUIGGLE_INLINE pack4<double> load( const double* p ) { return { _mm_loadu_pd(p), _mm_loadu_pd(p + 2) }; }
+    SQUIGGLE_INLINE pack4<double> load_aligned( const double* p ) { return { _mm_load_pd(p), _mm_load_pd(p + 2) }; }
+    SQUIGGLE_INLINE void store( double* p, pack4<double> a ) { _mm_storeu_pd(p, a.low); _mm_storeu_pd(p + 2, a.high); }
+    SQUIGGLE_INLINE void store_aligned( double* p, pack4<double> a ) { _mm_store_pd(p, a.low); _mm_store_pd(p + 2, a.high); }
+    SQUIGGLE_INLINE pack4<double> splat( double s ) { return { _mm_set1_pd(s), _mm_set1_pd(s) }; }
+
+    SQUIGGLE_INLINE pack4<double> add( pack4<double> a, pack4<double> b ) { return { _mm_add_pd(a.low, b.low), _mm_add_pd(a.high, b.high) }; }
+    SQUIGGLE_INLINE pack4<double> sub( pack4<double> a, pack4<double> b ) { return { _mm_sub_pd(a.low, b.low), _mm_sub_pd(a.high, b.high) }; }
+    SQUIGGLE_INLINE pack4<double> mul( pack4<double> a, pack4<double> b ) { return { _mm_mul_pd(a.low, b.low), _mm_mul_pd(a.high, b.high) }; }
+    SQUIGGLE_INLINE pack4<double> div( pack4<double> a, pack4<double> b ) { return { _mm_div_pd(a.low, b.low), _mm_div_pd(a.high, b.high) }; }
+    SQUIGGLE_INLINE pack4<double> sqrt( pack4<double> a ) { return { _mm_sqrt_pd(a.low), _mm_sqrt_pd(a.high) }; }
+
+    SQUIGGLE_INLINE pack4<double> fmadd( pack4<double> a, pack4<double> b, pack4<double> c )
+    {
+#if defined(SQUIGGLE_FMA)
+        return { _mm_fmadd_pd(a.low, b.low, c.low), _mm_fmadd_pd(a.high, b.high, c.high) };
+#else
+        return add(mul(a, b), c);
+#endif
+    }
+
+    SQUIGGLE_INLINE double first( pack4<double> a ) { return _mm_cvtsd_f64(a.low); }
+
+    SQUIGGLE_INLINE double hsum( pack4<double> a )
+    {
+        const __m128d pairs = _mm_add_pd(_mm_unpacklo_pd(a.low, a.high), _mm_unpackhi_pd(a.low, a.high)); // 0+1 2+3
+        return _mm_cvtsd_f64(_mm_add_sd(pairs, _mm_unpackhi_pd(pairs, pairs)));
+    }
+
+    template<int i0, int i1, int i2, int i3>
+    SQUIGGLE_INLINE pack4<double> shuffle( pack4<double> a )
+    {
+        return {
+            _mm_shuffle_pd(i0 < 2 ? a.low : a.high, i1 < 2 ? a.low : a.high, (i0 & 1) | ((i1 & 1) << 1)),
+            _mm_shuffle_pd(i2 < 2 ? a.low : a.high, i3 < 2 ? a.low : a.high, (i2 & 1) | ((i3 & 1) << 1))
+        };
+    }
+
+    template<bool n0, bool n1, bool n2, bool n3>
+    SQUIGGLE_INLINE pack4<double> negate( pack4<double> a )
+    {
+        const __m128d low = _mm_set_pd(n1 ? -0.0 : 0.0, n0 ? -0.0 : 0.0);
+        const __m128d high = _mm_set_pd(n3 ? -0.0 : 0.0, n2 ? -0.0 : 0.0);
+        return { _mm_xor_pd(a.low, low), _mm_xor_pd(a.high, high) };
+    }
+
+    SQUIGGLE_INLINE void transpose( pack4<double>& r0, pack4<double>& r1, pack4<double>& r2, pack4<double>& r3 )
+    {
+        const pack4<double> c0 = { _mm_unpacklo_pd(r0.low, r1.low), _mm_unpacklo_pd(r2.low, r3.low) };
+        const pack4<double> c1 = { _mm_unpackhi_pd(r0.low, r1.low), _mm_unpackhi_pd(r2.low, r3.low) };
+        const pack4<double> c2 = { _mm_unpacklo_pd(r0.high, r1.high), _mm_unpacklo_pd(r2.high, r3.high) };
+        const pack4<double> c3 = { _mm_unpackhi_pd(r0.high, r1.high), _mm_unpackhi_pd(r2.high, r3.high) };
+        r0 = c0; r1 = c1; r2 = c2; r3 = c3;
+    }
+
+#endif // SQUIGGLE_AVX
+#endif // SQUIGGLE_SSE2
+
+    // ( v[0] + v[1] ) + v[2], same order as the scalar 3 dimension dot so the padding lane is ignored
+    template<typename T>
+    SQUIGGLE_INLINE T hsum3( pack4<T> a )
+    {
+        return first(add(add(a, shuffle<1,1,1,1>(a)), shuffle<2,2,2,2>(a)));
+    }
+
+    // ( ( v[i0] + v[i1] ) + v[i2] ) + v[i3], a running sum in the given lane order so a 4 dimension dot rounds
+    // the same as the scalar W, X, Y, Z order whichever lane holds W
+    template<int i0, int i1, int i2, int i3, typename T>
+    SQUIGGLE_INLINE T hsum_ordered( pack4<T> a )
+    {
+        const pack4<T> sum = add(add(add(shuffle<i0,i0,i0,i0>(a), shuffle<i1,i1,i1,i1>(a)), shuffle<i2,i2,i2,i2>(a)), shuffle<i3,i3,i3,i3>(a));
+        return first(sum);
+    }
+
+    // Loads/stores a vector whose traits expose contiguous storage, aligned storage uses aligned moves
+    template<concepts::simd_vec_type V>
+    SQUIGGLE_INLINE pack4<vec_scalar<V>> load_vec( const V& vector )
+    {
+        if constexpr ( alignof(V) % sizeof(pack4<vec_scalar<V>>) == 0 )
+            return load_aligned(vec_traits<V>::data(vector));
+        else
+            return load(vec_traits<V>::data(vector));
+    }
+
+    template<concepts::simd_vec_type V>
+    SQUIGGLE_INLINE void store_vec( V& vector, pack4<vec_scalar<V>> a )
+    {
+        if constexpr ( alignof(V) % sizeof(pack4<vec_scalar<V>>) == 0 )
+            store_aligned(vec_traits<V>::data(vector), a);
+        else
+            store(vec_traits<V>::data(vector), a);
+    }
+
+    // Loads/stores one row of a contiguous row major 4x4 matrix
+    template<concepts::simd_mat44_type M>
+    SQUIGGLE_INLINE pack4<mat_scalar<M>> load_row( const M& matrix, int row )
+    {
+        if constexpr ( alignof(M) % sizeof(pack4<mat_scalar<M>>) == 0 )
+            return load_aligned(mat_traits<M>::data(matrix) + 4 * row);
+        else
+            return load(mat_traits<M>::data(matrix) + 4 * row);
+    }
+
+    // Loads the columns of a contiguous row major 4x4 matrix, rows are loaded and transposed in registers
+    template<concepts::simd_mat44_type M>
+    SQUIGGLE_INLINE void load_cols( const M& matrix, pack4<mat_scalar<M>>& c0, pack4<mat_scalar<M>>& c1, pack4<mat_scalar<M>>& c2, pack4<mat_scalar<M>>& c3 )
+    {
+        c0 = load_row(matrix, 0);
+        c1 = load_row(matrix, 1);
+        c2 = load_row(matrix, 2);
+        c3 = load_row(matrix, 3);
+        transpose(c0, c1, c2, c3);
+    }
+
+    template<concepts::simd_mat44_type M>
+    SQUIGGLE_INLINE void store_row( M& matrix, int row, pack4<mat_scalar<M>> a )
+    {
+        if constexpr ( alignof(M) % sizeof(pack4<mat_scalar<M>>) == 0 )
+            store_aligned(mat_traits<M>::data(matrix) + 4 * row, a);
+        else
+            store(mat_traits<M>::data(matrix) + 4 * row, a);
+    }
+}
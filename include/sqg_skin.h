@@ -0,0 +1,204 @@
+#pragma once
+#include "sqg_batch.h"
+#include "sqg_concepts.h"
+#include "sqg_dispatch.h"
+#include "sqg_mat34.h"
+#include "sqg_parallel.h"
+#include "sqg_soa.h"
+#include "sqg_struct.h"
+#include "sqg_vec.h"
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace sqg
+{
+    // Bone indices and weights of every vertex for linear blend skinning, a fixed number of influences per vertex.
+    // Stored influence by influence, bones(k) and weights(k) are contiguous arrays with one element per vertex,
+    // so the skinning kernels load the weights of a register of vertices at once. New influences are bone 0 with
+    // weight 0, which adds nothing.
+    template<typename T>
+    class skin_weights
+    {
+    public:
+        using scalar_type = T;
+        using size_type = std::size_t;
+
+        skin_weights() = default;
+        skin_weights( size_type vertices, int influences )
+            : vertices_(vertices), influences_(influences), bones_(vertices * influences, 0), weights_(vertices * influences, T{0})
+        {
+            assert(influences >= 0);
+        }
+
+        [[nodiscard]] SQUIGGLE_INLINE size_type size() const { return vertices_; }
+        [[nodiscard]] SQUIGGLE_INLINE bool empty() const { return vertices_ == 0; }
+        [[nodiscard]] SQUIGGLE_INLINE int influences() const { return influences_; }
+
+        SQUIGGLE_INLINE void set( size_type vertex, int influence, std::uint32_t bone, T weight )
+        {
+            assert(vertex < vertices_ && influence < influences_);
+            bones_[element(vertex, influence)] = bone;
+            weights_[element(vertex, influence)] = weight;
+        }
+
+        [[nodiscard]] SQUIGGLE_INLINE std::uint32_t bone( size_type vertex, int influence ) const { return bones_[element(vertex, influence)]; }
+        [[nodiscard]] SQUIGGLE_INLINE T weight( size_type vertex, int influence ) const { return weights_[element(vertex, influence)]; }
+
+        // Influence k of every vertex, size() long
+        [[nodiscard]] SQUIGGLE_INLINE std::span<std::uint32_t> bones( int influence ) { return std::span<std::uint32_t>{ bones_ }.subspan(influence * vertices_, vertices_); }
+        [[nodiscard]] SQUIGGLE_INLINE std::span<T> weights( int influence ) { return std::span<T>{ weights_ }.subspan(influence * vertices_, vertices_); }
+        [[nodiscard]] SQUIGGLE_INLINE std::span<const std::uint32_t> bones( int influence ) const { return std::span<const std::uint32_t>{ bones_ }.subspan(influence * vertices_, vertices_); }
+        [[nodiscard]] SQUIGGLE_INLINE std::span<const T> weights( int influence ) const { return std::span<const T>{ weights_ }.subspan(influence * vertices_, vertices_); }
+
+        // Scales the weights of each vertex to sum to 1, vertices whose weights sum to 0 are left as they are
+        void normalize()
+        {
+            for ( size_type vertex = 0; vertex < vertices_; vertex++ )
+            {
+                T total{0};
+                for ( int k = 0; k < influences_; k++ )
+                    total += weight(vertex, k);
+                if ( total == T{0} )
+                    continue;
+
+                const T inverse_total = T{1} / total;
+                for ( int k = 0; k < influences_; k++ )
+                    weights_[element(vertex, k)] *= inverse_total;
+            }
+        }
+
+    private:
+        [[nodiscard]] SQUIGGLE_INLINE size_type element( size_type vertex, int influence ) const { return influence * vertices_ + vertex; }
+
+        size_type vertices_ = 0;
+        int influences_ = 0;
+        std::vector<std::uint32_t> bones_;
+        std::vector<T> weights_;
+    };
+}
+
+namespace sqg::detail
+{
+    // Weighted sum of the bones of a vertex as 3x4 matrices, the last row of a 4x4 bone is dropped
+    template<concepts::read_affine_type M, typename T>
+    SQUIGGLE_INLINE constexpr mat34<T> blend_bones( std::span<const M> bones, const skin_weights<T>& weights, std::size_t vertex )
+    {
+        mat34<T> m;
+        for ( int k = 0; k < weights.influences(); k++ )
+        {
+            assert(weights.bone(vertex, k) < bones.size());
+            mat34<T> bone;
+            assign(bone, bones[weights.bone(vertex, k)]);
+
+            const T weight = weights.weight(vertex, k);
+            for ( int row = 0; row < 3; row++ )
+            {
+                for ( int col = 0; col < 4; col++ )
+                    m.a[row][col] = weight * bone.a[row][col] + m.a[row][col];
+            }
+        }
+        return m;
+    }
+
+    // Vertices begin to end, normals and out_normals are null to skin only the positions
+    template<concepts::read_affine_type M, typename T>
+    SQUIGGLE_INLINE void skin_range( std::span<const M> bones, const skin_weights<T>& weights, const vec3_soa<T>& positions, const vec3_soa<T>* normals,
+                                     vec3_soa<T>& out_positions, vec3_soa<T>* out_normals, std::size_t begin, std::size_t end )
+    {
+        static_assert( std::same_as<typename affine_traits<M>::scalar_type, T>, "Scalar type must match for this operation" );
+
+        if constexpr ( packed_affine<M> )
+        {
+            constexpr int rows = concepts::mat34_type<M> ? 3 : 4;
+            const T* in[6] = { positions.x().data(), positions.y().data(), positions.z().data(), nullptr, nullptr, nullptr };
+            T* out[6] = { out_positions.x().data(), out_positions.y().data(), out_positions.z().data(), nullptr, nullptr, nullptr };
+            if ( normals )
+            {
+                in[3] = normals->x().data(); in[4] = normals->y().data(); in[5] = normals->z().data();
+                out[3] = out_normals->x().data(); out[4] = out_normals->y().data(); out[5] = out_normals->z().data();
+            }
+
+            const std::size_t count = end - begin;
+            const std::size_t stride = weights.size();
+            for ( int c = 0; c < 6; c++ )
+            {
+                if ( in[c] )
+                {
+                    in[c] += begin;
+                    out[c] += begin;
+                }
+            }
+            const T* bone_data = bones.empty() ? nullptr : &bones[0].a[0][0];
+            const std::uint32_t* indices = weights.influences() == 0 ? nullptr : weights.bones(0).data() + begin;
+            const T* weight_data = weights.influences() == 0 ? nullptr : weights.weights(0).data() + begin;
+            dispatch::skin_vertices<rows>(bone_data, indices, weight_data, weights.influences(), stride, in, out, count);
+        }
+        else
+        {
+            for ( std::size_t i = begin; i < end; i++ )
+            {
+                const mat34<T> m = blend_bones(bones, weights, i);
+                out_positions[i] = transform_point(m, positions[i]);
+                if ( normals )
+                    ( *out_normals )[i] = normalized(transform_dir(m, ( *normals )[i]));
+            }
+        }
+    }
+}
+
+namespace sqg
+{
+    // Linear blend skinning, each vertex is moved by the weighted sum of its bones as 3x4 matrices. Bones are mat44
+    // or mat34 skinning matrices, world * inverse bind pose, of which only the top three rows are read. Normals go
+    // through the blended 3x3 without its translation and are normalised, which is exact for rigid bones and
+    // uniform scale. weights must have one entry per vertex with every bone index below bones.size(), the outputs
+    // must be at least as long as the inputs and may be the inputs. float and double mat44 and mat34 spans go
+    // through the skin_vertices kernel, each lane skins its own vertex.
+    template<concepts::read_affine_type M, typename T>
+    SQUIGGLE_INLINE void skin_vertices( std::span<const M> bones, const skin_weights<T>& weights, const vec3_soa<T>& positions, const vec3_soa<T>& normals,
+                                        vec3_soa<T>& out_positions, vec3_soa<T>& out_normals )
+    {
+        assert(weights.size() == positions.size() && normals.size() == positions.size());
+        assert(out_positions.size() >= positions.size() && out_normals.size() >= normals.size());
+        detail::skin_range(bones, weights, positions, &normals, out_positions, &out_normals, 0, positions.size());
+    }
+
+    // Positions only
+    template<concepts::read_affine_type M, typename T>
+    SQUIGGLE_INLINE void skin_vertices( std::span<const M> bones, const skin_weights<T>& weights, const vec3_soa<T>& positions, vec3_soa<T>& out_positions )
+    {
+        assert(weights.size() == positions.size() && out_positions.size() >= positions.size());
+        detail::skin_range<M,T>(bones, weights, positions, nullptr, out_positions, nullptr, 0, positions.size());
+    }
+}
+
+namespace sqg::parallel
+{
+    // sqg::skin_vertices over tiles of vertices on executor
+    template<typename E, concepts::read_affine_type M, typename T>
+    SQUIGGLE_INLINE void skin_vertices( E&& executor, std::span<const M> bones, const skin_weights<T>& weights, const vec3_soa<T>& positions, const vec3_soa<T>& normals,
+                                        vec3_soa<T>& out_positions, vec3_soa<T>& out_normals, const options& opts = {} )
+    {
+        assert(weights.size() == positions.size() && normals.size() == positions.size());
+        assert(out_positions.size() >= positions.size() && out_normals.size() >= normals.size());
+        const std::size_t element_bytes = 12 * sizeof(T) + weights.influences() * ( sizeof(T) + sizeof(std::uint32_t) );
+        detail::for_tiles(executor, positions.size(), element_bytes, opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::detail::skin_range(bones, weights, positions, &normals, out_positions, &out_normals, begin, end);
+        });
+    }
+
+    template<typename E, concepts::read_affine_type M, typename T>
+    SQUIGGLE_INLINE void skin_vertices( E&& executor, std::span<const M> bones, const skin_weights<T>& weights, const vec3_soa<T>& positions, vec3_soa<T>& out_positions,
+                                        const options& opts = {} )
+    {
+        assert(weights.size() == positions.size() && out_positions.size() >= positions.size());
+        const std::size_t element_bytes = 6 * sizeof(T) + weights.influences() * ( sizeof(T) + sizeof(std::uint32_t) );
+        detail::for_tiles(executor, positions.size(), element_bytes, opts, [&]( std::size_t begin, std::size_t end ) {
+            sqg::detail::skin_range<M,T>(bones, weights, positions, nullptr, out_positions, nullptr, begin, end);
+        });
+    }
+}
@@ -0,0 +1,330 @@
+#pragma once
+#include "sqg_concepts.h"
+#include "sqg_struct.h"
+#include "sqg_traits.h"
+#include "sqg_vec3.h"
+#include "sqg_vec4.h"
+#include "sqg_wide.h"
+#include <cassert>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace sqg::detail
+{
+    // V with its scalar swapped for S, vec3<float> becomes vec3<wide<float,8>>
+    template<typename V, typename S>
+    struct rebind_scalar;
+
+    template<template<typename> typename V, typename T, typename S>
+    struct rebind_scalar<V<T>,S>
+    {
+        using type = V<S>;
+    };
+}
+
+namespace sqg
+{
+    template<typename C> struct soa_view;
+    template<typename C> struct read_soa_view;
+    template<typename C, typename R> class soa_iterator;
+
+    // Structure of arrays, each component of V is held in its own contiguous array so component wise
+    // passes only stream the data they use. Elements are reached through soa_view which satisfies
+    // the same vec/quat concepts as V, so every free function works on them directly.
+    template<typename V>
+    class soa
+    {
+    public:
+        using value_type = V;
+        using scalar_type = vec_scalar<V>;
+        using size_type = std::size_t;
+        using reference = soa_view<soa>;
+        using const_reference = read_soa_view<soa>;
+        using iterator = soa_iterator<soa, reference>;
+        using const_iterator = soa_iterator<const soa, const_reference>;
+
+        static constexpr int n_dims = vec_traits<V>::n_dims;
+        static_assert( n_dims == 3 || n_dims == 4, "soa holds 3 or 4 dimension vectors" );
+
+        // N consecutive elements as one vector of wide scalars
+        template<int N>
+        using wide_type = detail::rebind_scalar<V, wide<scalar_type,N>>::type;
+
+        soa() = default;
+        explicit soa( size_type count ) { resize(count); }
+
+        [[nodiscard]] SQUIGGLE_INLINE size_type size() const { return x_.size(); }
+        [[nodiscard]] SQUIGGLE_INLINE bool empty() const { return x_.empty(); }
+
+        // new elements are default initialised V, zero for vectors and identity for quaternions
+        void resize( size_type count )
+        {
+            const V init{};
+            x_.resize(count, X(init));
+            y_.resize(count, Y(init));
+            z_.resize(count, Z(init));
+            if constexpr ( n_dims == 4 )
+                w_.resize(count, W(init));
+        }
+
+        void reserve( size_type count )
+        {
+            x_.reserve(count);
+            y_.reserve(count);
+            z_.reserve(count);
+            if constexpr ( n_dims == 4 )
+                w_.reserve(count);
+        }
+
+        void clear()
+        {
+            x_.clear();
+            y_.clear();
+            z_.clear();
+            w_.clear();
+        }
+
+        template<concepts::vec_type R>
+        void push_back( const R& vector )
+        {
+            static_assert( vec_traits<R>::n_dims == n_dims, "Number of dimensions must match" );
+            x_.push_back(X(vector));
+            y_.push_back(Y(vector));
+            z_.push_back(Z(vector));
+            if constexpr ( n_dims == 4 )
+                w_.push_back(W(vector));
+        }
+
+        [[nodiscard]] SQUIGGLE_INLINE reference operator[]( size_type i ) { return { *this, i }; }
+        [[nodiscard]] SQUIGGLE_INLINE const_reference operator[]( size_type i ) const { return { *this, i }; }
+
+        [[nodiscard]] SQUIGGLE_INLINE iterator begin() { return { *this, 0 }; }
+        [[nodiscard]] SQUIGGLE_INLINE iterator end() { return { *this, size() }; }
+        [[nodiscard]] SQUIGGLE_INLINE const_iterator begin() const { return { *this, 0 }; }
+        [[nodiscard]] SQUIGGLE_INLINE const_iterator end() const { return { *this, size() }; }
+
+        // contiguous component arrays, size() long
+        [[nodiscard]] SQUIGGLE_INLINE std::span<scalar_type> x() { return x_; }
+        [[nodiscard]] SQUIGGLE_INLINE std::span<scalar_type> y() { return y_; }
+        [[nodiscard]] SQUIGGLE_INLINE std::span<scalar_type> z() { return z_; }
+        [[nodiscard]] SQUIGGLE_INLINE std::span<scalar_type> w() requires ( n_dims == 4 ) { return w_; }
+
+        [[nodiscard]] SQUIGGLE_INLINE std::span<const scalar_type> x() const { return x_; }
+        [[nodiscard]] SQUIGGLE_INLINE std::span<const scalar_type> y() const { return y_; }
+        [[nodiscard]] SQUIGGLE_INLINE std::span<const scalar_type> z() const { return z_; }
+        [[nodiscard]] SQUIGGLE_INLINE std::span<const scalar_type> w() const requires ( n_dims == 4 ) { return w_; }
+
+        // component I of element i in X, Y, Z, W order, the element views read and write through this
+        template<int I>
+        [[nodiscard]] SQUIGGLE_INLINE scalar_type& component( size_type i ) { return components<I>(*this)[i]; }
+
+        template<int I>
+        [[nodiscard]] SQUIGGLE_INLINE scalar_type component( size_type i ) const { return components<I>(*this)[i]; }
+
+        // Reads elements i to i + N - 1 into one vector of wide scalars, each lane is one element
+        template<int N>
+        [[nodiscard]] SQUIGGLE_INLINE wide_type<N> load( size_type i ) const
+        {
+            assert(i + N <= size());
+            wide_type<N> v;
+            X(v,  load_lanes<N>(x_.data() + i));
+            Y(v,  load_lanes<N>(y_.data() + i));
+            Z(v,  load_lanes<N>(z_.data() + i));
+            if constexpr ( n_dims == 4 )
+                W(v,  load_lanes<N>(w_.data() + i));
+            return v;
+        }
+
+        template<int N>
+        SQUIGGLE_INLINE void store( size_type i, const wide_type<N>& v )
+        {
+            assert(i + N <= size());
+            store_lanes<N>(x_.data() + i, X(v));
+            store_lanes<N>(y_.data() + i, Y(v));
+            store_lanes<N>(z_.data() + i, Z(v));
+            if constexpr ( n_dims == 4 )
+                store_lanes<N>(w_.data() + i, W(v));
+        }
+
+    private:
+        template<int I, typename S>
+        static SQUIGGLE_INLINE auto& components( S& self )
+        {
+            static_assert( I < n_dims, "Component out of range" );
+            if constexpr ( I == 0 )
+                return self.x_;
+            else if constexpr ( I == 1 )
+                return self.y_;
+            else if constexpr ( I == 2 )
+                return self.z_;
+            else
+                return self.w_;
+        }
+
+        template<int N>
+        static SQUIGGLE_INLINE wide<scalar_type,N> load_lanes( const scalar_type* p )
+        {
+            wide<scalar_type,N> s;
+            for ( int j = 0; j < N; j++ )
+                s.lane[j] = p[j];
+            return s;
+        }
+
+        template<int N>
+        static SQUIGGLE_INLINE void store_lanes( scalar_type* p, const wide<scalar_type,N>& s )
+        {
+            for ( int j = 0; j < N; j++ )
+                p[j] = s.lane[j];
+        }
+
+        std::vector<scalar_type> x_;
+        std::vector<scalar_type> y_;
+        std::vector<scalar_type> z_;
+        std::vector<scalar_type> w_;
+    };
+
+    template<typename T> using vec3_soa = soa<vec3<T>>;
+    template<typename T> using vec4_soa = soa<vec4<T>>;
+    template<typename T> using quat_soa = soa<quat<T>>;
+
+    // Element index of a const soa or block container, a shallow reference like read_row_view
+    template<typename C>
+    struct read_soa_view
+    {
+        const C& container;
+        std::size_t index;
+
+        template<typename R>
+        SQUIGGLE_INLINE constexpr operator R() const
+        {
+            R r;
+            assign(r, *this);
+            return r;
+        }
+    };
+
+    // Element index of a soa or block container, assigning to it writes through to the container
+    template<typename C>
+    struct soa_view
+    {
+        C& container;
+        std::size_t index;
+
+        template<concepts::vec_type V>
+        SQUIGGLE_INLINE constexpr soa_view& operator=( const V& vector )
+        {
+            assign(*this, vector);
+            return *this;
+        }
+
+        // element wise copy, not a rebind, so a[i] = a[j] copies the value
+        SQUIGGLE_INLINE constexpr soa_view& operator=( const soa_view& other )
+        {
+            assign(*this, other);
+            return *this;
+        }
+
+        template<typename R>
+        SQUIGGLE_INLINE constexpr operator R() const
+        {
+            R r;
+            assign(r, *this);
+            return r;
+        }
+    };
+
+    template<typename C>
+    struct vec_traits<read_soa_view<C>>
+    {
+        using scalar_type = C::scalar_type;
+        using type = C::value_type;
+        using view = read_soa_view<C>;
+        static constexpr int n_dims = C::n_dims;
+
+        static SQUIGGLE_INLINE constexpr scalar_type X(const view& v) { return v.container.template component<0>(v.index); }
+        static SQUIGGLE_INLINE constexpr scalar_type Y(const view& v) { return v.container.template component<1>(v.index); }
+        static SQUIGGLE_INLINE constexpr scalar_type Z(const view& v) { return v.container.template component<2>(v.index); }
+        static SQUIGGLE_INLINE constexpr scalar_type W(const view& v) requires ( n_dims == 4 ) { return v.container.template component<3>(v.index); }
+    };
+
+    template<typename C>
+    struct vec_traits<soa_view<C>>
+    {
+        using scalar_type = C::scalar_type;
+        using type = C::value_type;
+        using view = soa_view<C>;
+        static constexpr int n_dims = C::n_dims;
+
+        static SQUIGGLE_INLINE constexpr scalar_type X(const view& v) { return v.container.template component<0>(v.index); }
+        static SQUIGGLE_INLINE constexpr scalar_type Y(const view& v) { return v.container.template component<1>(v.index); }
+        static SQUIGGLE_INLINE constexpr scalar_type Z(const view& v) { return v.container.template component<2>(v.index); }
+        static SQUIGGLE_INLINE constexpr scalar_type W(const view& v) requires ( n_dims == 4 ) { return v.container.template component<3>(v.index); }
+
+        static SQUIGGLE_INLINE constexpr scalar_type& X(view& v) { return v.container.template component<0>(v.index); }
+        static SQUIGGLE_INLINE constexpr scalar_type& Y(view& v) { return v.container.template component<1>(v.index); }
+        static SQUIGGLE_INLINE constexpr scalar_type& Z(view& v) { return v.container.template component<2>(v.index); }
+        static SQUIGGLE_INLINE constexpr scalar_type& W(view& v) requires ( n_dims == 4 ) { return v.container.template component<3>(v.index); }
+    };
+
+    // Random access by index. Dereferencing yields a view so the legacy category is only input iterator
+    template<typename C, typename R>
+    class soa_iterator
+    {
+    public:
+        using value_type = C::value_type;
+        using reference = R;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::input_iterator_tag;
+        using iterator_concept = std::random_access_iterator_tag;
+
+        soa_iterator() = default;
+        SQUIGGLE_INLINE soa_iterator( C& container, std::size_t index ) : container_(&container), index_(index) {}
+
+        [[nodiscard]] SQUIGGLE_INLINE reference operator*() const { return { *container_, index_ }; }
+        [[nodiscard]] SQUIGGLE_INLINE reference operator[]( difference_type n ) const { return { *container_, index_ + n }; }
+
+        SQUIGGLE_INLINE soa_iterator& operator++() { index_++; return *this; }
+        SQUIGGLE_INLINE soa_iterator& operator--() { index_--; return *this; }
+        SQUIGGLE_INLINE soa_iterator operator++(int) { soa_iterator r = *this; index_++; return r; }
+        SQUIGGLE_INLINE soa_iterator operator--(int) { soa_iterator r = *this; index_--; return r; }
+        SQUIGGLE_INLINE soa_iterator& operator+=( difference_type n ) { index_ += n; return *this; }
+        SQUIGGLE_INLINE soa_iterator& operator-=( difference_type n ) { index_ -= n; return *this; }
+
+        [[nodiscard]] friend SQUIGGLE_INLINE soa_iterator operator+( soa_iterator it, difference_type n ) { return it += n; }
+        [[nodiscard]] friend SQUIGGLE_INLINE soa_iterator operator+( difference_type n, soa_iterator it ) { return it += n; }
+        [[nodiscard]] friend SQUIGGLE_INLINE soa_iterator operator-( soa_iterator it, difference_type n ) { return it -= n; }
+        [[nodiscard]] friend SQUIGGLE_INLINE difference_type operator-( const soa_iterator& a, const soa_iterator& b )
+        {
+            return static_cast<difference_type>(a.index_) - static_cast<difference_type>(b.index_);
+        }
+
+        [[nodiscard]] friend SQUIGGLE_INLINE bool operator==( const soa_iterator& a, const soa_iterator& b ) { return a.index_ == b.index_; }
+        [[nodiscard]] friend SQUIGGLE_INLINE auto operator<=>( const soa_iterator& a, const soa_iterator& b ) { return a.index_ <=> b.index_; }
+
+    private:
+        C* container_ = nullptr;
+        std::size_t index_ = 0;
+    };
+}
+
+// Views and V share V as their common reference so soa_iterator models std::random_access_iterator
+template<typename C, typename V, template<typename> typename TQual, template<typename> typename UQual>
+    requires std::same_as<V, typename C::value_type>
+struct std::basic_common_reference<sqg::soa_view<C>, V, TQual, UQual> { using type = V; };
+
+template<typename V, typename C, template<typename> typename TQual, template<typename> typename UQual>
+    requires std::same_as<V, typename C::value_type>
+struct std::basic_common_reference<V, sqg::soa_view<C>, TQual, UQual> { using type = V; };
+
+template<typename C, typename V, template<typename> typename TQual, template<typename> typename UQual>
+    requires std::same_as<V, typename C::value_type>
+struct std::basic_common_reference<sqg::read_soa_view<C>, V, TQual, UQual> { using type = V; };
+
+template<typename V, typename C, template<typename> typename TQual, template<typename> typename UQual>
+    requires std::same_as<V, typename C::value_type>
+struct std::basic_common_reference<V, sqg::read_soa_view<C>, TQual, UQual> { using type = V; };
@@ -0,0 +1,57 @@
+#pragma once
+#include "sqg_concepts.h"
+#include "sqg_struct.h"
+#include "sqg_traits.h"
+#include "sqg_vec_view.h"
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <version>
+
+#if __has_include(<mdspan>)
+#   include <mdspan>
+#endif
+
+// Vectors and matrices held in memory squiggle does not own, such as packets, shared memory or another
+// library's arrays. The extents are part of the type so the traits index the buffer directly and the
+// views satisfy the vec/mat concepts without a copy. Const element types are read only.
+
+namespace sqg
+{
+    // N contiguous scalars as a vector, span_vec<const float,3> is a read only vec3.
+    // Assigning to it writes through to the span, see detail::component_view.
+    template<typename T, std::size_t N>
+        requires ( N >= 2 && N <= 4 && std::is_arithmetic_v<std::remove_const_t<T>> )
+    struct span_vec : detail::component_view<span_vec<T,N>, std::span<T,N>, T>
+    {
+        using detail::component_view<span_vec<T,N>, std::span<T,N>, T>::operator=;
+    };
+
+    template<typename T, std::size_t N>
+    span_vec( std::span<T,N> ) -> span_vec<T,N>;
+
+    template<typename T, std::size_t N>
+    struct vec_traits<span_vec<T,N>> : detail::component_vec_traits<span_vec<T,N>, T, static_cast<int>(N)> {};
+
+#if defined(__cpp_lib_mdspan)
+    // N x N scalars as a matrix. layout_right is row major like mat44::a, layout_left is column major
+    // and layout_stride takes runtime strides, for example to skip padding between rows.
+    // Assigning one mdspan to another rebinds it as usual, use assign to copy the values.
+    template<typename T, std::size_t N, typename Layout = std::layout_right>
+    using span_mat = std::mdspan<T, std::extents<std::size_t,N,N>, Layout>;
+
+    template<typename T, typename Index, std::size_t N, typename Layout, typename Accessor>
+        requires ( N >= 2 && N <= 4 && std::is_arithmetic_v<std::remove_const_t<T>> && std::same_as<typename Accessor::reference, T&> )
+    struct mat_traits<std::mdspan<T, std::extents<Index,N,N>, Layout, Accessor>>
+    {
+        using scalar_type = std::remove_const_t<T>;
+        using type = detail::mat_type_dims<scalar_type,N>::mat_type;
+        using view = std::mdspan<T, std::extents<Index,N,N>, Layout, Accessor>;
+        static constexpr int n_dims = N;
+
+        template<int row, int col> static SQUIGGLE_INLINE constexpr scalar_type A(const view& m) { return m[row, col]; }
+        template<int row, int col> static SQUIGGLE_INLINE constexpr scalar_type& A(view& m) requires ( !std::is_const_v<T> ) { return m[row, col]; }
+    };
+#endif
+}
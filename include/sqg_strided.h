@@ -0,0 +1,137 @@
+#pragma once
+#include "sqg_concepts.h"
+#include "sqg_struct.h"
+#include "sqg_traits.h"
+#include "sqg_vec_view.h"
+#include <cassert>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <type_traits>
+
+namespace sqg
+{
+    // One vector of N contiguous components inside a larger element, such as the position of a vertex.
+    // Assigning to it writes through, see detail::component_view.
+    template<typename T, int N>
+    struct strided_element : detail::component_view<strided_element<T,N>, T*, T>
+    {
+        using detail::component_view<strided_element<T,N>, T*, T>::operator=;
+    };
+
+    template<typename T, int N>
+    struct vec_traits<strided_element<T,N>> : detail::component_vec_traits<strided_element<T,N>, T, N> {};
+
+    // Steps through a buffer stride bytes at a time. Keeps the element index rather than a moving pointer so
+    // the distance between iterators does not divide by the stride, which is zero for a default or one element view.
+    template<typename T, int N>
+    class strided_iterator
+    {
+        using byte = std::conditional_t<std::is_const_v<T>, const std::byte, std::byte>;
+
+    public:
+        using value_type = detail::vec_type_dims<std::remove_const_t<T>,N>::vec_type;
+        using reference = strided_element<T,N>;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::input_iterator_tag;
+        using iterator_concept = std::random_access_iterator_tag;
+
+        strided_iterator() = default;
+        SQUIGGLE_INLINE strided_iterator( byte* base, difference_type index, std::ptrdiff_t stride ) : base_(base), index_(index), stride_(stride) {}
+
+        [[nodiscard]] SQUIGGLE_INLINE reference operator*() const { return { reinterpret_cast<T*>(base_ + index_ * stride_) }; }
+        [[nodiscard]] SQUIGGLE_INLINE reference operator[]( difference_type n ) const { return { reinterpret_cast<T*>(base_ + ( index_ + n ) * stride_) }; }
+
+        SQUIGGLE_INLINE strided_iterator& operator++() { index_++; return *this; }
+        SQUIGGLE_INLINE strided_iterator& operator--() { index_--; return *this; }
+        SQUIGGLE_INLINE strided_iterator operator++(int) { strided_iterator r = *this; index_++; return r; }
+        SQUIGGLE_INLINE strided_iterator operator--(int) { strided_iterator r = *this; index_--; return r; }
+        SQUIGGLE_INLINE strided_iterator& operator+=( difference_type n ) { index_ += n; return *this; }
+        SQUIGGLE_INLINE strided_iterator& operator-=( difference_type n ) { index_ -= n; return *this; }
+
+        [[nodiscard]] friend SQUIGGLE_INLINE strided_iterator operator+( strided_iterator it, difference_type n ) { return it += n; }
+        [[nodiscard]] friend SQUIGGLE_INLINE strided_iterator operator+( difference_type n, strided_iterator it ) { return it += n; }
+        [[nodiscard]] friend SQUIGGLE_INLINE strided_iterator operator-( strided_iterator it, difference_type n ) { return it -= n; }
+        [[nodiscard]] friend SQUIGGLE_INLINE difference_type operator-( const strided_iterator& a, const strided_iterator& b )
+        {
+            assert(a.base_ == b.base_);
+            return a.index_ - b.index_;
+        }
+
+        [[nodiscard]] friend SQUIGGLE_INLINE bool operator==( const strided_iterator& a, const strided_iterator& b ) { return a.index_ == b.index_; }
+        [[nodiscard]] friend SQUIGGLE_INLINE auto operator<=>( const strided_iterator& a, const strided_iterator& b ) { return a.index_ <=> b.index_; }
+
+    private:
+        byte* base_ = nullptr;
+        difference_type index_ = 0;
+        std::ptrdiff_t stride_ = 0;
+    };
+
+    // count vectors of N components of T, the first offset bytes into base and each stride bytes after the
+    // previous, so one attribute of an interleaved vertex or particle buffer is used in place without copying.
+    // Like std::span it does not own the buffer, and strided_vec_view<const T,N> is read only.
+    template<typename T, int N>
+    class strided_vec_view
+    {
+        static_assert( N >= 2 && N <= 4, "strided_vec_view holds 2, 3 or 4 dimension vectors" );
+        using byte = std::conditional_t<std::is_const_v<T>, const std::byte, std::byte>;
+        using void_type = std::conditional_t<std::is_const_v<T>, const void, void>;
+
+    public:
+        using value_type = detail::vec_type_dims<std::remove_const_t<T>,N>::vec_type;
+        using scalar_type = std::remove_const_t<T>;
+        using size_type = std::size_t;
+        using reference = strided_element<T,N>;
+        using iterator = strided_iterator<T,N>;
+
+        static constexpr int n_dims = N;
+
+        strided_vec_view() = default;
+
+        SQUIGGLE_INLINE strided_vec_view( void_type* base, size_type count, size_type stride, size_type offset = 0 )
+            : base_(static_cast<byte*>(base) + offset), count_(count), stride_(stride)
+        {
+            assert(stride >= N * sizeof(T) || count <= 1);
+            assert(offset % alignof(T) == 0 && stride % alignof(T) == 0);
+        }
+
+        // One member of every element of a span of structs, offset is usually offsetof(Element, member)
+        template<typename E>
+            requires std::is_convertible_v<E*, void_type*>
+        SQUIGGLE_INLINE strided_vec_view( std::span<E> elements, size_type offset )
+            : strided_vec_view(elements.data(), elements.size(), sizeof(E), offset)
+        {
+            assert(offset + N * sizeof(T) <= sizeof(E));
+        }
+
+        [[nodiscard]] SQUIGGLE_INLINE size_type size() const { return count_; }
+        [[nodiscard]] SQUIGGLE_INLINE bool empty() const { return count_ == 0; }
+        [[nodiscard]] SQUIGGLE_INLINE size_type stride() const { return stride_; }
+
+        [[nodiscard]] SQUIGGLE_INLINE reference operator[]( size_type i ) const
+        {
+            assert(i < count_);
+            return { reinterpret_cast<T*>(base_ + i * stride_) };
+        }
+
+        [[nodiscard]] SQUIGGLE_INLINE iterator begin() const { return { base_, 0, static_cast<std::ptrdiff_t>(stride_) }; }
+        [[nodiscard]] SQUIGGLE_INLINE iterator end() const { return { base_, static_cast<std::ptrdiff_t>(count_), static_cast<std::ptrdiff_t>(stride_) }; }
+
+    private:
+        byte* base_ = nullptr;
+        size_type count_ = 0;
+        size_type stride_ = 0;
+    };
+}
+
+// Elements and their value type share the value type as their common reference so strided_iterator
+// models std::random_access_iterator
+template<typename T, int N, typename V, template<typename> typename TQual, template<typename> typename UQual>
+    requires std::same_as<V, sqg::vec_value<sqg::strided_element<T,N>>>
+struct std::basic_common_reference<sqg::strided_element<T,N>, V, TQual, UQual> { using type = V; };
+
+template<typename V, typename T, int N, template<typename> typename TQual, template<typename> typename UQual>
+    requires std::same_as<V, sqg::vec_value<sqg::strided_element<T,N>>>
+struct std::basic_common_reference<V, sqg::strided_element<T,N>, TQual, UQual> { using type = V; };
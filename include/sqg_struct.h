@@ -1,5 +1,6 @@
 #pragma once
 #include "sqg_concepts.h"
+#include "sqg_scalar.h"
 namespace sqg
 {
     // ========== Structures ========== //
@@ -75,6 +76,20 @@ namespace sqg
         }
     };
 
+    // affine 3x4, the top three rows of a mat44 whose last row is 0 0 0 1, see sqg_mat34.h
+    template<typename T>
+    struct mat34
+    {
+        T a[3][4]{};
+
+        template<typename R>
+        SQUIGGLE_INLINE constexpr explicit operator R() const {
+            R r;
+            assign(r, *this);
+            return r;
+        }
+    };
+
     template<typename T>
     struct vec4
     {
@@ -93,7 +108,7 @@ namespace sqg
 
     // quaternion - same as vec4 essentially
 
-    template<std::floating_point T>
+    template<concepts::real_scalar T>
     struct quat
     {   // Initialise to identity
         T w{1};
@@ -109,6 +124,85 @@ namespace sqg
         }
     };
 
+    // real + eps dual, a rotation and a translation in 8 scalars, see sqg_dualquat.h
+    template<concepts::real_scalar T>
+    struct dualquat
+    {   // Initialise to identity
+        quat<T> real;
+        quat<T> dual{ T{0}, T{0}, T{0}, T{0} };
+
+        template<typename R>
+        SQUIGGLE_INLINE constexpr explicit operator R() const {
+            R r;
+            assign(r, *this);
+            return r;
+        }
+    };
+
+    // aligned 4 dimensions - a single simd register wide, vec_traits expose the storage to the simd kernels
+
+    // padded to four lanes so it loads in one move, the padding lane is kept zero and never exposed by vec_traits
+    template<std::floating_point T>
+    struct alignas(4 * sizeof(T)) vec3a
+    {
+        T x{0};
+        T y{0};
+        T z{0};
+        T pad{0};
+
+        template<typename R>
+        SQUIGGLE_INLINE constexpr explicit operator R() const {
+            R r;
+            assign(r, *this);
+            return r;
+        }
+    };
+
+    template<std::floating_point T>
+    struct alignas(4 * sizeof(T)) vec4a
+    {
+        T x{};
+        T y{};
+        T z{};
+        T w{};
+
+        template<typename R>
+        SQUIGGLE_INLINE constexpr explicit operator R() const {
+            R r;
+            assign(r, *this);
+            return r;
+        }
+    };
+
+    template<std::floating_point T>
+    struct alignas(4 * sizeof(T)) mat44a
+    {
+        T a[4][4]{};
+
+        template<typename R>
+        SQUIGGLE_INLINE constexpr explicit operator R() const {
+            R r;
+            assign(r, *this);
+            return r;
+        }
+    };
+
+    template<std::floating_point T>
+    struct alignas(4 * sizeof(T)) quata
+    {   // Initialise to identity
+        T w{1};
+        T x{0};
+        T y{0};
+        T z{0};
+
+        template<typename R>
+        SQUIGGLE_INLINE constexpr explicit operator R() const {
+            R r;
+            assign(r, *this);
+            return r;
+        }
+    };
+
     using vec2d = vec2<double>;
     using vec2f = vec2<float>;
     using vec2i = vec2<int>;
@@ -139,9 +233,27 @@ namespace sqg
     using mat44i = mat44<int>;
     using mat44u = mat44<unsigned int>;
 
+    using mat34d = mat34<double>;
+    using mat34f = mat34<float>;
+
     using quatd = quat<double>;
     using quatf = quat<float>;
 
+    using dualquatd = dualquat<double>;
+    using dualquatf = dualquat<float>;
+
+    using vec3ad = vec3a<double>;
+    using vec3af = vec3a<float>;
+
+    using vec4ad = vec4a<double>;
+    using vec4af = vec4a<float>;
+
+    using quatad = quata<double>;
+    using quataf = quata<float>;
+
+    using mat44ad = mat44a<double>;
+    using mat44af = mat44a<float>;
+
     // ========== Traits ========== //
 
     // 2 dimensions
@@ -208,6 +320,22 @@ namespace sqg
 
         template<int row, int col> static SQUIGGLE_INLINE constexpr scalar_type A(const type& m) { return m.a[row][col]; }
         template<int row, int col> static SQUIGGLE_INLINE constexpr scalar_type& A(type& m) { return m.a[row][col]; }
+
+        static SQUIGGLE_INLINE constexpr const scalar_type* data(const type& m) { return &m.a[0][0]; }
+        static SQUIGGLE_INLINE constexpr scalar_type* data(type& m) { return &m.a[0][0]; }
+    };
+
+    template<typename T>
+    struct mat34_traits<mat34<T>>
+    {
+        using scalar_type = T;
+        using type = mat34<T>;
+
+        template<int row, int col> static SQUIGGLE_INLINE constexpr scalar_type A(const type& m) { return m.a[row][col]; }
+        template<int row, int col> static SQUIGGLE_INLINE constexpr scalar_type& A(type& m) { return m.a[row][col]; }
+
+        static SQUIGGLE_INLINE constexpr const scalar_type* data(const type& m) { return &m.a[0][0]; }
+        static SQUIGGLE_INLINE constexpr scalar_type* data(type& m) { return &m.a[0][0]; }
     };
 
     template<typename T>
@@ -247,6 +375,99 @@ namespace sqg
         static SQUIGGLE_INLINE constexpr scalar_type& Z(type& v) { return v.z; }
     };
 
+    // dual quaternion
+    template<concepts::real_scalar T>
+    struct dualquat_traits<dualquat<T>>
+    {
+        using scalar_type = T;
+        using type = dualquat<T>;
+
+        static SQUIGGLE_INLINE constexpr const quat<T>& real(const type& q) { return q.real; }
+        static SQUIGGLE_INLINE constexpr const quat<T>& dual(const type& q) { return q.dual; }
+
+        static SQUIGGLE_INLINE constexpr quat<T>& real(type& q) { return q.real; }
+        static SQUIGGLE_INLINE constexpr quat<T>& dual(type& q) { return q.dual; }
+    };
+
+    // aligned
+    template<typename T>
+    struct vec_traits<vec3a<T>>
+    {
+        using scalar_type = T;
+        using type = vec3a<T>;
+        static constexpr int n_dims = 3;
+        static constexpr int simd_w_lane = 3; // padding lane
+
+        static SQUIGGLE_INLINE constexpr scalar_type X(const type& v) { return v.x; }
+        static SQUIGGLE_INLINE constexpr scalar_type Y(const type& v) { return v.y; }
+        static SQUIGGLE_INLINE constexpr scalar_type Z(const type& v) { return v.z; }
+
+        static SQUIGGLE_INLINE constexpr scalar_type& X(type& v) { return v.x; }
+        static SQUIGGLE_INLINE constexpr scalar_type& Y(type& v) { return v.y; }
+        static SQUIGGLE_INLINE constexpr scalar_type& Z(type& v) { return v.z; }
+
+        static SQUIGGLE_INLINE constexpr const scalar_type* data(const type& v) { return &v.x; }
+        static SQUIGGLE_INLINE constexpr scalar_type* data(type& v) { return &v.x; }
+    };
+
+    template<typename T>
+    struct vec_traits<vec4a<T>>
+    {
+        using scalar_type = T;
+        using type = vec4a<T>;
+        static constexpr int n_dims = 4;
+        static constexpr int simd_w_lane = 3;
+
+        static SQUIGGLE_INLINE constexpr scalar_type X(const type& v) { return v.x; }
+        static SQUIGGLE_INLINE constexpr scalar_type Y(const type& v) { return v.y; }
+        static SQUIGGLE_INLINE constexpr scalar_type Z(const type& v) { return v.z; }
+        static SQUIGGLE_INLINE constexpr scalar_type W(const type& v) { return v.w; }
+
+        static SQUIGGLE_INLINE constexpr scalar_type& X(type& v) { return v.x; }
+        static SQUIGGLE_INLINE constexpr scalar_type& Y(type& v) { return v.y; }
+        static SQUIGGLE_INLINE constexpr scalar_type& Z(type& v) { return v.z; }
+        static SQUIGGLE_INLINE constexpr scalar_type& W(type& v) { return v.w; }
+
+        static SQUIGGLE_INLINE constexpr const scalar_type* data(const type& v) { return &v.x; }
+        static SQUIGGLE_INLINE constexpr scalar_type* data(type& v) { return &v.x; }
+    };
+
+    template<typename T>
+    struct mat_traits<mat44a<T>>
+    {
+        using scalar_type = T;
+        using type = mat44a<T>;
+        static constexpr int n_dims = 4;
+
+        template<int row, int col> static SQUIGGLE_INLINE constexpr scalar_type A(const type& m) { return m.a[row][col]; }
+        template<int row, int col> static SQUIGGLE_INLINE constexpr scalar_type& A(type& m) { return m.a[row][col]; }
+
+        static SQUIGGLE_INLINE constexpr const scalar_type* data(const type& m) { return &m.a[0][0]; }
+        static SQUIGGLE_INLINE constexpr scalar_type* data(type& m) { return &m.a[0][0]; }
+    };
+
+    template<typename T>
+    struct vec_traits<quata<T>>
+    {
+        using scalar_type = T;
+        using type = quata<T>;
+        static constexpr int n_dims = 4;
+        static constexpr int simd_w_lane = 0;
+
+        static SQUIGGLE_INLINE constexpr scalar_type W(const type& v) { return v.w; }
+        static SQUIGGLE_INLINE constexpr scalar_type X(const type& v) { return v.x; }
+        static SQUIGGLE_INLINE constexpr scalar_type Y(const type& v) { return v.y; }
+        static SQUIGGLE_INLINE constexpr scalar_type Z(const type& v) { return v.z; }
+
+        static SQUIGGLE_INLINE constexpr scalar_type& W(type& v) { return v.w; }
+        static SQUIGGLE_INLINE constexpr scalar_type& X(type& v) { return v.x; }
+        static SQUIGGLE_INLINE constexpr scalar_type& Y(type& v) { return v.y; }
+        static SQUIGGLE_INLINE constexpr scalar_type& Z(type& v) { return v.z; }
+
+        static SQUIGGLE_INLINE constexpr const scalar_type* data(const type& v) { return &v.w; }
+        static SQUIGGLE_INLINE constexpr scalar_type* data(type& v) { return &v.w; }
+    };
+
     // Setup Deduction for Return Types
     // Select native vec2 over other vectors
 
@@ -26,6 +26,34 @@ namespace sqg
         mat_traits<T>::template A<row,col>(v) = s; 
     }
 
+    // Real and dual quaternion parts of a dual quaternion
+    template<concepts::read_dualquat_type T>
+    SQUIGGLE_INLINE constexpr decltype(auto) real(const T& q) { return dualquat_traits<T>::real(q); }
+
+    template<concepts::dualquat_type T>
+    SQUIGGLE_INLINE constexpr decltype(auto) real(T& q) { return dualquat_traits<T>::real(q); }
+
+    template<concepts::read_dualquat_type T>
+    SQUIGGLE_INLINE constexpr decltype(auto) dual(const T& q) { return dualquat_traits<T>::dual(q); }
+
+    template<concepts::dualquat_type T>
+    SQUIGGLE_INLINE constexpr decltype(auto) dual(T& q) { return dualquat_traits<T>::dual(q); }
+
+    // 3x4 affine matrices, rows 0 to 2
+    template<int row, int col, concepts::read_mat34_type T>
+    SQUIGGLE_INLINE constexpr typename mat34_traits<T>::scalar_type A(const T& m)
+    {
+        static_assert( row < 3 && col < 4, "row must be less than 3 and col less than 4" );
+        return mat34_traits<T>::template A<row,col>(m);
+    }
+
+    template<int row, int col, concepts::mat34_type T>
+    SQUIGGLE_INLINE constexpr void A(T& m, typename mat34_traits<T>::scalar_type s)
+    {
+        static_assert( row < 3 && col < 4, "row must be less than 3 and col less than 4" );
+        mat34_traits<T>::template A<row,col>(m) = s;
+    }
+
     template<concepts::mat_type T> SQUIGGLE_INLINE constexpr typename mat_traits<T>::scalar_type A00(const T& v) { return mat_traits<T>::template A<0,0>(v); } 
     template<concepts::mat_type T> SQUIGGLE_INLINE constexpr typename mat_traits<T>::scalar_type A01(const T& v) { return mat_traits<T>::template A<0,1>(v); } 
     template<concepts::mat_type T> SQUIGGLE_INLINE constexpr typename mat_traits<T>::scalar_type A02(const T& v) { return mat_traits<T>::template A<0,2>(v); } 
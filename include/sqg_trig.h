@@ -0,0 +1,101 @@
+#pragma once
+#include "sqg_concepts.h"
+#include <cmath>
+#include <concepts>
+
+// Trig backends, scalar_traits forwards sin, cos and sincos of float and double to SQUIGGLE_TRIG_BACKEND.
+// The default is the standard library, define SQUIGGLE_TRIG_BACKEND before including squiggle to swap it
+// for sqg::trig::polynomial or your own type with the same static functions. Every translation unit
+// must see the same backend.
+
+namespace sqg::trig
+{
+    template<typename T>
+    struct sincos_result
+    {
+        T sin;
+        T cos;
+    };
+
+    struct standard
+    {
+        template<std::floating_point T> static SQUIGGLE_INLINE T sin( T angle ) { return std::sin(angle); }
+        template<std::floating_point T> static SQUIGGLE_INLINE T cos( T angle ) { return std::cos(angle); }
+
+        // compilers merge these into a single sincos call where the platform has one
+        template<std::floating_point T>
+        static SQUIGGLE_INLINE sincos_result<T> sincos( T angle )
+        {
+            return { std::sin(angle), std::cos(angle) };
+        }
+    };
+
+    // Minimax polynomials on [-pi/4, pi/4] (cephes coefficients) after reducing the angle by multiples of pi/2.
+    // Max error for double is 2 ulp with |angle| < 8192. For float it is 2 ulp with |angle| < pi, beyond that
+    // results near zero lose relative accuracy but the absolute error stays below 2^-23 up to |angle| < 8192.
+    // Larger angles run out of bits of pi in the reduction.
+    // Branch free so loops over it vectorise, and constexpr.
+    struct polynomial
+    {
+        template<std::floating_point T>
+        static SQUIGGLE_INLINE constexpr sincos_result<T> sincos( T angle )
+        {
+            const T quadrant = round(angle * T{0.636619772367581343076}); // 2 / pi
+            const long long q = static_cast<long long>(quadrant);
+
+            // angle - quadrant * pi / 2 with pi / 2 split in three parts to keep the bits lost to cancellation
+            T r;
+            if constexpr ( sizeof(T) == sizeof(float) )
+            {
+                r = angle - quadrant * T{1.5703125};
+                r = r - quadrant * T{4.837512969970703125e-4};
+                r = r - quadrant * T{7.54978995489188216e-8};
+            }
+            else
+            {
+                r = angle - quadrant * T{1.57079625129699707031};
+                r = r - quadrant * T{7.54978941586159635336e-8};
+                r = r - quadrant * T{5.39030285815811905290e-15};
+            }
+
+            const T z = r * r;
+            T s;
+            T c;
+            if constexpr ( sizeof(T) == sizeof(float) )
+            {
+                s = r + r * z * ( ( T{-1.9515295891e-4} * z + T{8.3321608736e-3} ) * z + T{-1.6666654611e-1} );
+                c = T{1} - T{0.5} * z + z * z * ( ( T{2.443315711809948e-5} * z + T{-1.388731625493765e-3} ) * z + T{4.166664568298827e-2} );
+            }
+            else
+            {
+                s = r + r * z * ( ( ( ( ( T{1.58962301576546568060e-10} * z + T{-2.50507477628578072866e-8} ) * z
+                    + T{2.75573136213857245213e-6} ) * z + T{-1.98412698295895385996e-4} ) * z
+                    + T{8.33333333332211858878e-3} ) * z + T{-1.66666666666666307295e-1} );
+                c = T{1} - T{0.5} * z + z * z * ( ( ( ( ( T{-1.13585365213876817300e-11} * z + T{2.08757008419747316778e-9} ) * z
+                    + T{-2.75573141792967388112e-7} ) * z + T{2.48015872888517045348e-5} ) * z
+                    + T{-1.38888888888730564116e-3} ) * z + T{4.16666666666665929218e-2} );
+            }
+
+            // quadrant 1 is (c, -s), 2 is (-s, -c) and 3 is (-c, s)
+            const bool swap = q & 1;
+            const T sin = swap ? c : s;
+            const T cos = swap ? s : c;
+            return { ( q & 2 ) ? -sin : sin, ( ( q + 1 ) & 2 ) ? -cos : cos };
+        }
+
+        template<std::floating_point T> static SQUIGGLE_INLINE constexpr T sin( T angle ) { return sincos(angle).sin; }
+        template<std::floating_point T> static SQUIGGLE_INLINE constexpr T cos( T angle ) { return sincos(angle).cos; }
+
+    private:
+        // round half away from zero, std::round is not constexpr
+        template<std::floating_point T>
+        static SQUIGGLE_INLINE constexpr T round( T x )
+        {
+            return static_cast<T>(static_cast<long long>(x < T{0} ? x - T{0.5} : x + T{0.5}));
+        }
+    };
+}
+
+#if !defined(SQUIGGLE_TRIG_BACKEND)
+#   define SQUIGGLE_TRIG_BACKEND ::sqg::trig::standard
+#endif
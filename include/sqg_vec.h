@@ -6,6 +6,7 @@
 #include "sqg_vec3.h"
 #include "sqg_vec4.h"
 #include <cassert>
+#include <concepts>
 
 namespace sqg
 {
@@ -56,23 +57,7 @@ namespace sqg
     template<concepts::vec_type T>
     [[nodiscard]] SQUIGGLE_INLINE constexpr vec_traits<T>::scalar_type mag( const T& vector )
     {
-        return std::sqrt(mag2(vector));
-    }
-
-    template<concepts::vec_type T>
-    SQUIGGLE_INLINE constexpr void normalize( T& vector )
-    {
-        const auto length2 = mag2(vector);
-        assert(length2 != decltype(length2){0});
-        vector *= vec_scalar<T>{1} / std::sqrt(length2);
-    }
-
-    template<concepts::vec_type T>
-    SQUIGGLE_INLINE constexpr vec_value<T> normalized( const T& vector )
-    {
-        vec_value<T> v = vector;
-        normalize(v);
-        return v;
+        return math::sqrt(mag2(vector));
     }
 
     template<concepts::vec_type T>
@@ -114,4 +99,39 @@ namespace sqg
     {
         return ! ( a == b );
     }
-}
\ No newline at end of file
+
+    // after the compound operators so that user types found without ADL can use them
+    template<concepts::vec_type T>
+    SQUIGGLE_INLINE constexpr void normalize( T& vector )
+    {
+        const auto length2 = mag2(vector);
+        assert(length2 != decltype(length2){0});
+        vector *= vec_scalar<T>{1} / math::sqrt(length2);
+    }
+
+    template<concepts::vec_type T>
+    SQUIGGLE_INLINE constexpr vec_value<T> normalized( const T& vector )
+    {
+        vec_value<T> v = vector;
+        normalize(v);
+        return v;
+    }
+
+    // Approximate normalize using math::rsqrt_fast, refinements trades speed for accuracy and the max error
+    // of each is listed there. Works for quaternions too, the usual use being renormalisation after integration.
+    template<int refinements = 1, concepts::vec_type T>
+    SQUIGGLE_INLINE constexpr void normalize_fast( T& vector )
+    {
+        const auto length2 = mag2(vector);
+        assert(length2 != decltype(length2){0});
+        vector *= math::rsqrt_fast<refinements>(length2);
+    }
+
+    template<int refinements = 1, concepts::vec_type T>
+    SQUIGGLE_INLINE constexpr vec_value<T> normalized_fast( const T& vector )
+    {
+        vec_value<T> v = vector;
+        normalize_fast<refinements>(v);
+        return v;
+    }
+}
@@ -1,6 +1,10 @@
 #pragma once
 #include "sqg_concepts.h"
+#include "sqg_scalar.h"
+#include "sqg_simd.h"
 #include <cmath>
+#include <cassert>
+#include <type_traits>
 namespace sqg
 {
     template<concepts::vec3_type V1, concepts::read_vec3_type V2>
@@ -104,5 +108,97 @@ namespace sqg
             Y(a) == Y(b) &&
             Z(a) == Z(b);
     }
-}
 
+    // Padded vectors, the padding lane stays zero through all of these (0 + 0, 0 * 0 - 0 * 0)
+
+    template<concepts::simd_vec3_type V1, concepts::simd_vec3_type V2>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value2<V1,V2> cross( const V1& a, const V2& b )
+    {
+        static_assert( std::same_as<vec_scalar<V1>,vec_scalar<V2>>, "Scalar type must match for this operation" );
+
+        vec_value2<V1,V2> v;
+        if ( std::is_constant_evaluated() )
+        {
+            X(v,  Y(a) * Z(b) - Z(a) * Y(b));
+            Y(v,  Z(a) * X(b) - X(a) * Z(b));
+            Z(v,  X(a) * Y(b) - Y(a) * X(b));
+            return v;
+        }
+
+        // a * b.yzx - a.yzx * b gives z,x,y then one shuffle puts it back in x,y,z order
+        const auto pa = simd::load_vec(a);
+        const auto pb = simd::load_vec(b);
+        const auto r = simd::sub(
+            simd::mul(pa, simd::shuffle<1,2,0,3>(pb)),
+            simd::mul(simd::shuffle<1,2,0,3>(pa), pb)
+        );
+        simd::store_vec(v, simd::shuffle<1,2,0,3>(r));
+        return v;
+    }
+
+    template<concepts::simd_vec3_type V1, concepts::simd_vec3_type V2>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_scalar2<V1,V2> dot( const V1&a, const V2& b )
+    {
+        static_assert( std::same_as<vec_scalar<V1>,vec_scalar<V2>>, "Scalar type must match for this operation" );
+
+        if ( std::is_constant_evaluated() )
+            return X(a) * X(b) + Y(a) * Y(b) + Z(a) * Z(b);
+
+        return simd::hsum3(simd::mul(simd::load_vec(a), simd::load_vec(b)));
+    }
+
+    template<concepts::simd_vec3_type V1, concepts::simd_vec3_type V2>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value2<V1,V2> operator+( const V1& a, const V2& b )
+    {
+        static_assert( std::same_as<vec_scalar<V1>,vec_scalar<V2>>, "Scalar type must match for this operation" );
+
+        vec_value2<V1,V2> v;
+        if ( std::is_constant_evaluated() )
+        {
+            X(v,  X(a) + X(b));
+            Y(v,  Y(a) + Y(b));
+            Z(v,  Z(a) + Z(b));
+            return v;
+        }
+
+        simd::store_vec(v, simd::add(simd::load_vec(a), simd::load_vec(b)));
+        return v;
+    }
+
+    template<concepts::simd_vec3_type V1, concepts::simd_vec3_type V2>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value2<V1,V2> operator-( const V1& a, const V2& b )
+    {
+        static_assert( std::same_as<vec_scalar<V1>,vec_scalar<V2>>, "Scalar type must match for this operation" );
+
+        vec_value2<V1,V2> v;
+        if ( std::is_constant_evaluated() )
+        {
+            X(v,  X(a) - X(b));
+            Y(v,  Y(a) - Y(b));
+            Z(v,  Z(a) - Z(b));
+            return v;
+        }
+
+        simd::store_vec(v, simd::sub(simd::load_vec(a), simd::load_vec(b)));
+        return v;
+    }
+
+    template<concepts::simd_vec3_type T>
+    SQUIGGLE_INLINE constexpr void normalize( T& vector )
+    {
+        using scalar = vec_scalar<T>;
+        if ( std::is_constant_evaluated() )
+        {
+            const scalar inverse = scalar{1} / math::sqrt(dot(vector, vector));
+            X(vector,  inverse * X(vector));
+            Y(vector,  inverse * Y(vector));
+            Z(vector,  inverse * Z(vector));
+            return;
+        }
+
+        const auto p = simd::load_vec(vector);
+        const scalar length2 = simd::hsum3(simd::mul(p, p));
+        assert(length2 != scalar{0});
+        simd::store_vec(vector, simd::mul(simd::splat(scalar{1} / math::sqrt(length2)), p));
+    }
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include "sqg_concepts.h"
+#include "sqg_simd.h"
 #include <cmath>
+#include <type_traits>
 
 namespace sqg
 {
@@ -42,6 +44,20 @@ namespace sqg
         return aw * bw + ax * bx + ay * by + az * bz;
     }
 
+    template<concepts::simd_vec4_type T>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_scalar<T> dot( const T& a, const T& b )
+    {
+        if ( std::is_constant_evaluated() )
+            return W(a) * W(b) + X(a) * X(b) + Y(a) * Y(b) + Z(a) * Z(b);
+
+        // summed W, X, Y, Z like the scalar dot, so the result does not depend on the storage type
+        const auto products = simd::mul(simd::load_vec(a), simd::load_vec(b));
+        if constexpr ( vec_traits<T>::simd_w_lane == 0 )
+            return simd::hsum_ordered<0,1,2,3>(products);
+        else
+            return simd::hsum_ordered<3,0,1,2>(products);
+    }
+
     template<concepts::read_vec4_type T>
     [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<T> operator-( const T& vector )
     {
@@ -66,6 +82,23 @@ namespace sqg
         return v;
     }
 
+    template<concepts::simd_vec4_type T>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<T> operator+( const T& a, const T& b )
+    {
+        vec_value<T> v;
+        if ( std::is_constant_evaluated() )
+        {
+            W(v,  W(a) + W(b));
+            X(v,  X(a) + X(b));
+            Y(v,  Y(a) + Y(b));
+            Z(v,  Z(a) + Z(b));
+            return v;
+        }
+
+        simd::store_vec(v, simd::add(simd::load_vec(a), simd::load_vec(b)));
+        return v;
+    }
+
     template<concepts::read_vec4_type V1, concepts::read_vec4_type V2>
     [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value2<V1,V2> operator-( const V1& a, const V2& b )
     {
@@ -79,6 +112,23 @@ namespace sqg
         return v;
     }
 
+    template<concepts::simd_vec4_type T>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<T> operator-( const T& a, const T& b )
+    {
+        vec_value<T> v;
+        if ( std::is_constant_evaluated() )
+        {
+            W(v,  W(a) - W(b));
+            X(v,  X(a) - X(b));
+            Y(v,  Y(a) - Y(b));
+            Z(v,  Z(a) - Z(b));
+            return v;
+        }
+
+        simd::store_vec(v, simd::sub(simd::load_vec(a), simd::load_vec(b)));
+        return v;
+    }
+
     template<concepts::read_vec4_type T>
     [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<T> operator*( vec_scalar<T> scalar, const T& vector )
     {
@@ -90,6 +140,23 @@ namespace sqg
         return v;
     }
 
+    template<concepts::simd_vec4_type T>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<T> operator*( vec_scalar<T> scalar, const T& vector )
+    {
+        vec_value<T> v;
+        if ( std::is_constant_evaluated() )
+        {
+            W(v,  scalar * W(vector));
+            X(v,  scalar * X(vector));
+            Y(v,  scalar * Y(vector));
+            Z(v,  scalar * Z(vector));
+            return v;
+        }
+
+        simd::store_vec(v, simd::mul(simd::splat(scalar), simd::load_vec(vector)));
+        return v;
+    }
+
     template<concepts::read_vec4_type T>
     [[nodiscard]] SQUIGGLE_INLINE constexpr vec_value<T> operator/( const T& vector, vec_scalar<T> scalar )
     {
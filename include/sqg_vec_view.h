@@ -2,6 +2,7 @@
 #include "sqg_vec4.h"
 #include "sqg_struct.h"
 #include "sqg_traits.h"
+#include <type_traits>
 
 namespace sqg
 {
@@ -60,4 +61,56 @@ namespace sqg
         static SQUIGGLE_INLINE constexpr scalar_type Z(const view& v) { return sqg::Z(v.vector); }
         static SQUIGGLE_INLINE constexpr scalar_type W(const view& v) { return scalar_type{1}; }
     };
-}
\ No newline at end of file
+}
+
+namespace sqg::detail
+{
+    // Shared body of span_vec and strided_element, N scalars starting at components, a pointer or fixed size span
+    // into memory squiggle does not own. A shallow reference like row_view, T is const for read only access.
+    template<typename Derived, typename Components, typename T>
+    struct component_view
+    {
+        Components components;
+
+        template<concepts::vec_type V>
+        SQUIGGLE_INLINE constexpr Derived& operator=( const V& vector ) requires ( !std::is_const_v<T> )
+        {
+            assign(static_cast<Derived&>(*this), vector);
+            return static_cast<Derived&>(*this);
+        }
+
+        // element wise copy, not a rebind, so a[i] = a[j] copies the value
+        SQUIGGLE_INLINE constexpr component_view& operator=( const component_view& other ) requires ( !std::is_const_v<T> )
+        {
+            assign(static_cast<Derived&>(*this), static_cast<const Derived&>(other));
+            return *this;
+        }
+
+        template<typename R>
+        SQUIGGLE_INLINE constexpr operator R() const
+        {
+            R r;
+            assign(r, static_cast<const Derived&>(*this));
+            return r;
+        }
+    };
+
+    template<typename View, typename T, int N>
+    struct component_vec_traits
+    {
+        using scalar_type = std::remove_const_t<T>;
+        using type = vec_type_dims<scalar_type,N>::vec_type;
+        using view = View;
+        static constexpr int n_dims = N;
+
+        static SQUIGGLE_INLINE constexpr scalar_type X(const view& v) { return v.components[0]; }
+        static SQUIGGLE_INLINE constexpr scalar_type Y(const view& v) { return v.components[1]; }
+        static SQUIGGLE_INLINE constexpr scalar_type Z(const view& v) requires ( N > 2 ) { return v.components[2]; }
+        static SQUIGGLE_INLINE constexpr scalar_type W(const view& v) requires ( N > 3 ) { return v.components[3]; }
+
+        static SQUIGGLE_INLINE constexpr scalar_type& X(view& v) requires ( !std::is_const_v<T> ) { return v.components[0]; }
+        static SQUIGGLE_INLINE constexpr scalar_type& Y(view& v) requires ( !std::is_const_v<T> ) { return v.components[1]; }
+        static SQUIGGLE_INLINE constexpr scalar_type& Z(view& v) requires ( !std::is_const_v<T> && N > 2 ) { return v.components[2]; }
+        static SQUIGGLE_INLINE constexpr scalar_type& W(view& v) requires ( !std::is_const_v<T> && N > 3 ) { return v.components[3]; }
+    };
+}
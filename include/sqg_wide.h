@@ -0,0 +1,190 @@
+#pragma once
+#include "sqg_concepts.h"
+#include "sqg_scalar.h"
+#include "sqg_simd.h"
+#include <cmath>
+#include <concepts>
+#include <type_traits>
+
+namespace sqg
+{
+    // N independent lanes of T which behave as a single scalar. Vectors, quaternions and matrices of wide
+    // scalars run every algorithm on N values at once, vec3<wide<float,8>> is 8 vec3 stored as SoA.
+    //
+    // Arithmetic is per lane, == and != compare the whole value like std::array so that
+    // vector comparisons and asserts behave the same as they do for a plain scalar.
+    template<std::floating_point T, int N>
+    struct alignas(N % 4 == 0 ? 4 * sizeof(T) : alignof(T)) wide
+    {
+        static_assert( N > 0, "wide must have at least one lane" );
+        static constexpr int lanes = N;
+
+        T lane[N]{};
+
+        constexpr wide() = default;
+
+        // broadcast
+        SQUIGGLE_INLINE constexpr wide( T s )
+        {
+            for ( int i = 0; i < N; i++ )
+                lane[i] = s;
+        }
+
+        SQUIGGLE_INLINE constexpr T operator[]( int i ) const { return lane[i]; }
+        SQUIGGLE_INLINE constexpr T& operator[]( int i ) { return lane[i]; }
+    };
+
+    using wide4f = wide<float,4>;
+    using wide8f = wide<float,8>;
+    using wide16f = wide<float,16>;
+
+    using wide2d = wide<double,2>;
+    using wide4d = wide<double,4>;
+    using wide8d = wide<double,8>;
+}
+
+namespace sqg::detail
+{
+    // Applies op to each lane, when the lanes split into aligned groups of four they go through pack_op instead
+    template<typename T, int N, typename Op, typename PackOp>
+    SQUIGGLE_INLINE constexpr wide<T,N> wide_apply( const wide<T,N>& a, Op op, PackOp pack_op )
+    {
+        wide<T,N> r;
+        if constexpr ( N % 4 == 0 )
+        {
+            if ( ! std::is_constant_evaluated() )
+            {
+                for ( int i = 0; i < N; i += 4 )
+                    simd::store_aligned(r.lane + i, pack_op(simd::load_aligned(a.lane + i)));
+                return r;
+            }
+        }
+
+        for ( int i = 0; i < N; i++ )
+            r.lane[i] = op(a.lane[i]);
+        return r;
+    }
+
+    template<typename T, int N, typename Op, typename PackOp>
+    SQUIGGLE_INLINE constexpr wide<T,N> wide_apply( const wide<T,N>& a, const wide<T,N>& b, Op op, PackOp pack_op )
+    {
+        wide<T,N> r;
+        if constexpr ( N % 4 == 0 )
+        {
+            if ( ! std::is_constant_evaluated() )
+            {
+                for ( int i = 0; i < N; i += 4 )
+                    simd::store_aligned(r.lane + i, pack_op(simd::load_aligned(a.lane + i), simd::load_aligned(b.lane + i)));
+                return r;
+            }
+        }
+
+        for ( int i = 0; i < N; i++ )
+            r.lane[i] = op(a.lane[i], b.lane[i]);
+        return r;
+    }
+}
+
+namespace sqg
+{
+    template<typename T, int N>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr wide<T,N> operator+( const wide<T,N>& a, const wide<T,N>& b )
+    {
+        return detail::wide_apply(a, b, []( T x, T y ) { return x + y; }, []( auto x, auto y ) { return simd::add(x, y); });
+    }
+
+    template<typename T, int N>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr wide<T,N> operator-( const wide<T,N>& a, const wide<T,N>& b )
+    {
+        return detail::wide_apply(a, b, []( T x, T y ) { return x - y; }, []( auto x, auto y ) { return simd::sub(x, y); });
+    }
+
+    template<typename T, int N>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr wide<T,N> operator*( const wide<T,N>& a, const wide<T,N>& b )
+    {
+        return detail::wide_apply(a, b, []( T x, T y ) { return x * y; }, []( auto x, auto y ) { return simd::mul(x, y); });
+    }
+
+    template<typename T, int N>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr wide<T,N> operator/( const wide<T,N>& a, const wide<T,N>& b )
+    {
+        return detail::wide_apply(a, b, []( T x, T y ) { return x / y; }, []( auto x, auto y ) { return simd::div(x, y); });
+    }
+
+    template<typename T, int N>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr wide<T,N> operator-( const wide<T,N>& a )
+    {
+        return detail::wide_apply(a, []( T x ) { return -x; }, []( auto x ) { return simd::negate<true,true,true,true>(x); });
+    }
+
+    // mixed with a plain scalar, which is broadcast to every lane
+    template<typename T, int N> [[nodiscard]] SQUIGGLE_INLINE constexpr wide<T,N> operator+( const wide<T,N>& a, std::type_identity_t<T> b ) { return a + wide<T,N>{b}; }
+    template<typename T, int N> [[nodiscard]] SQUIGGLE_INLINE constexpr wide<T,N> operator-( const wide<T,N>& a, std::type_identity_t<T> b ) { return a - wide<T,N>{b}; }
+    template<typename T, int N> [[nodiscard]] SQUIGGLE_INLINE constexpr wide<T,N> operator*( const wide<T,N>& a, std::type_identity_t<T> b ) { return a * wide<T,N>{b}; }
+    template<typename T, int N> [[nodiscard]] SQUIGGLE_INLINE constexpr wide<T,N> operator/( const wide<T,N>& a, std::type_identity_t<T> b ) { return a / wide<T,N>{b}; }
+
+    template<typename T, int N> [[nodiscard]] SQUIGGLE_INLINE constexpr wide<T,N> operator+( std::type_identity_t<T> a, const wide<T,N>& b ) { return wide<T,N>{a} + b; }
+    template<typename T, int N> [[nodiscard]] SQUIGGLE_INLINE constexpr wide<T,N> operator-( std::type_identity_t<T> a, const wide<T,N>& b ) { return wide<T,N>{a} - b; }
+    template<typename T, int N> [[nodiscard]] SQUIGGLE_INLINE constexpr wide<T,N> operator*( std::type_identity_t<T> a, const wide<T,N>& b ) { return wide<T,N>{a} * b; }
+    template<typename T, int N> [[nodiscard]] SQUIGGLE_INLINE constexpr wide<T,N> operator/( std::type_identity_t<T> a, const wide<T,N>& b ) { return wide<T,N>{a} / b; }
+
+    template<typename T, int N> SQUIGGLE_INLINE constexpr wide<T,N>& operator+=( wide<T,N>& a, const wide<T,N>& b ) { a = a + b; return a; }
+    template<typename T, int N> SQUIGGLE_INLINE constexpr wide<T,N>& operator-=( wide<T,N>& a, const wide<T,N>& b ) { a = a - b; return a; }
+    template<typename T, int N> SQUIGGLE_INLINE constexpr wide<T,N>& operator*=( wide<T,N>& a, const wide<T,N>& b ) { a = a * b; return a; }
+    template<typename T, int N> SQUIGGLE_INLINE constexpr wide<T,N>& operator/=( wide<T,N>& a, const wide<T,N>& b ) { a = a / b; return a; }
+
+    template<typename T, int N>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr bool operator==( const wide<T,N>& a, const wide<T,N>& b )
+    {
+        for ( int i = 0; i < N; i++ )
+        {
+            if ( a.lane[i] != b.lane[i] )
+                return false;
+        }
+        return true;
+    }
+
+    template<typename T, int N>
+    [[nodiscard]] SQUIGGLE_INLINE constexpr bool operator!=( const wide<T,N>& a, const wide<T,N>& b )
+    {
+        return ! ( a == b );
+    }
+
+    // sqrt uses the packed instruction, trig is evaluated per lane with the scalar traits of T
+    template<typename T, int N>
+    struct scalar_traits<wide<T,N>>
+    {
+        static SQUIGGLE_INLINE wide<T,N> sqrt( const wide<T,N>& s )
+        {
+            return detail::wide_apply(s, []( T x ) { return scalar_traits<T>::sqrt(x); }, []( auto x ) { return simd::sqrt(x); });
+        }
+
+        static SQUIGGLE_INLINE wide<T,N> sin( const wide<T,N>& s )
+        {
+            wide<T,N> r;
+            for ( int i = 0; i < N; i++ )
+                r.lane[i] = scalar_traits<T>::sin(s.lane[i]);
+            return r;
+        }
+
+        static SQUIGGLE_INLINE wide<T,N> cos( const wide<T,N>& s )
+        {
+            wide<T,N> r;
+            for ( int i = 0; i < N; i++ )
+                r.lane[i] = scalar_traits<T>::cos(s.lane[i]);
+            return r;
+        }
+
+        static SQUIGGLE_INLINE trig::sincos_result<wide<T,N>> sincos( const wide<T,N>& s )
+        {
+            trig::sincos_result<wide<T,N>> r;
+            for ( int i = 0; i < N; i++ )
+            {
+                const trig::sincos_result<T> lane = scalar_traits<T>::sincos(s.lane[i]);
+                r.sin.lane[i] = lane.sin;
+                r.cos.lane[i] = lane.cos;
+            }
+            return r;
+        }
+    };
+}
@@ -0,0 +1,452 @@
+#include <sqg.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <span>
+#include <vector>
+
+using Catch::Matchers::WithinAbsMatcher;
+
+template<typename V1, typename V2>
+void require_near( const V1& a, const V2& b )
+{
+    using T = sqg::vec_scalar<V1>;
+    REQUIRE_THAT( sqg::X(a), WithinAbsMatcher( sqg::X(b), sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( sqg::Y(a), WithinAbsMatcher( sqg::Y(b), sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( sqg::Z(a), WithinAbsMatcher( sqg::Z(b), sqg_test::tolerance<T>() ) );
+}
+
+template<typename T>
+struct transforms
+{
+    sqg::mat44<T> m44;
+    sqg::mat33<T> m33;
+    sqg::quat<T> q;
+
+    explicit transforms( std::mt19937& generator )
+    {
+        std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+        for ( int row = 0; row < 4; row++ )
+        {
+            for ( int col = 0; col < 4; col++ )
+                m44.a[row][col] = distribution(generator);
+        }
+        m33 = sqg::orientation(m44);
+        sqg::set_rot(q, sqg::normalized(sqg::vec3<T>{ distribution(generator), distribution(generator), distribution(generator) }), distribution(generator));
+    }
+};
+
+// spans of V, V is copied to and from vec3<T> to build the expected values
+template<typename V>
+void test_transform_span( std::mt19937& generator )
+{
+    using T = sqg::vec_scalar<V>;
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+    const transforms<T> t(generator);
+
+    // not a multiple of any kernel width so every tail runs
+    std::vector<V> in(37);
+    for ( V& v : in )
+    {
+        sqg::X(v, distribution(generator));
+        sqg::Y(v, distribution(generator));
+        sqg::Z(v, distribution(generator));
+    }
+    std::vector<V> out(in.size());
+    const std::span<const V> points{ in };
+
+    SECTION("mat44 points")
+    {
+        sqg::transform_points(points, t.m44, std::span<V>{ out });
+        for ( std::size_t i = 0; i < in.size(); i++ )
+            require_near(out[i], sqg::transform_point(t.m44, in[i]));
+    }
+
+    SECTION("mat44 dirs")
+    {
+        sqg::transform_dirs(points, t.m44, std::span<V>{ out });
+        for ( std::size_t i = 0; i < in.size(); i++ )
+            require_near(out[i], sqg::transform_dir(t.m44, in[i]));
+    }
+
+    SECTION("mat33")
+    {
+        sqg::transform_points(points, t.m33, std::span<V>{ out });
+        for ( std::size_t i = 0; i < in.size(); i++ )
+            require_near(out[i], t.m33 * sqg::vec3<T>(sqg::X(in[i]), sqg::Y(in[i]), sqg::Z(in[i])));
+    }
+
+    SECTION("mat33 view")
+    {
+        sqg::transform_dirs(points, sqg::transposed(t.m33), std::span<V>{ out });
+        for ( std::size_t i = 0; i < in.size(); i++ )
+            require_near(out[i], sqg::transposed(t.m33) * sqg::vec3<T>(sqg::X(in[i]), sqg::Y(in[i]), sqg::Z(in[i])));
+    }
+
+    SECTION("quat")
+    {
+        sqg::transform_points(points, t.q, std::span<V>{ out });
+        for ( std::size_t i = 0; i < in.size(); i++ )
+            require_near(out[i], t.q * sqg::vec3<T>(sqg::X(in[i]), sqg::Y(in[i]), sqg::Z(in[i])));
+    }
+
+    SECTION("in place")
+    {
+        out = in;
+        sqg::transform_points(std::span<const V>{ out }, t.m44, std::span<V>{ out });
+        for ( std::size_t i = 0; i < in.size(); i++ )
+            require_near(out[i], sqg::transform_point(t.m44, in[i]));
+    }
+}
+
+template<typename T>
+void test_transform_soa( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+    const transforms<T> t(generator);
+
+    sqg::vec3_soa<T> in;
+    for ( int i = 0; i < 37; i++ )
+        in.push_back(sqg::vec3<T>{ distribution(generator), distribution(generator), distribution(generator) });
+    sqg::vec3_soa<T> out(in.size());
+
+    SECTION("mat44 points")
+    {
+        sqg::transform_points(in, t.m44, out);
+        for ( std::size_t i = 0; i < in.size(); i++ )
+            require_near(out[i], sqg::transform_point(t.m44, sqg::vec3<T>(in[i])));
+    }
+
+    SECTION("mat44 dirs")
+    {
+        sqg::transform_dirs(in, t.m44, out);
+        for ( std::size_t i = 0; i < in.size(); i++ )
+            require_near(out[i], sqg::transform_dir(t.m44, sqg::vec3<T>(in[i])));
+    }
+
+    SECTION("mat33")
+    {
+        sqg::transform_points(in, t.m33, out);
+        for ( std::size_t i = 0; i < in.size(); i++ )
+            require_near(out[i], t.m33 * sqg::vec3<T>(in[i]));
+    }
+
+    SECTION("quat")
+    {
+        sqg::transform_dirs(in, t.q, out);
+        for ( std::size_t i = 0; i < in.size(); i++ )
+            require_near(out[i], t.q * sqg::vec3<T>(in[i]));
+    }
+
+    SECTION("in place")
+    {
+        const sqg::vec3_soa<T> original = in;
+        sqg::transform_points(in, t.m44, in);
+        for ( std::size_t i = 0; i < in.size(); i++ )
+            require_near(in[i], sqg::transform_point(t.m44, sqg::vec3<T>(original[i])));
+    }
+}
+
+template<typename V>
+void test_rotate_many( std::mt19937& generator )
+{
+    using T = sqg::vec_scalar<V>;
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+    const transforms<T> t(generator);
+
+    std::vector<V> vectors(37);
+    for ( V& v : vectors )
+    {
+        sqg::X(v, distribution(generator));
+        sqg::Y(v, distribution(generator));
+        sqg::Z(v, distribution(generator));
+    }
+
+    const std::vector<V> original = vectors;
+    sqg::rotate_many(t.q, std::span<V>{ vectors });
+    for ( std::size_t i = 0; i < vectors.size(); i++ )
+        require_near(vectors[i], t.q * sqg::vec3<T>(sqg::X(original[i]), sqg::Y(original[i]), sqg::Z(original[i])));
+}
+
+template<typename T>
+void test_rotate_many_soa( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+    const transforms<T> t(generator);
+
+    sqg::vec3_soa<T> vectors;
+    for ( int i = 0; i < 37; i++ )
+        vectors.push_back(sqg::vec3<T>{ distribution(generator), distribution(generator), distribution(generator) });
+
+    const sqg::vec3_soa<T> original = vectors;
+    sqg::rotate_many(t.q, vectors);
+    for ( std::size_t i = 0; i < vectors.size(); i++ )
+        require_near(vectors[i], t.q * sqg::vec3<T>(original[i]));
+}
+
+template<typename V1, typename V2>
+void require_near_n( const V1& a, const V2& b, sqg::vec_scalar<V1> tolerance )
+{
+    using sqg::operator-;
+    REQUIRE( sqg::mag(a - b) <= tolerance );
+}
+
+template<typename V>
+void test_reductions( std::mt19937& generator )
+{
+    using T = sqg::vec_scalar<V>;
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+
+    std::vector<V> a(37);
+    std::vector<V> b(a.size());
+    for ( std::size_t i = 0; i < a.size(); i++ )
+    {
+        sqg::X(a[i], distribution(generator)); sqg::Y(a[i], distribution(generator));
+        sqg::X(b[i], distribution(generator)); sqg::Y(b[i], distribution(generator));
+        if constexpr ( sqg::vec_traits<V>::n_dims > 2 )
+        {
+            sqg::Z(a[i], distribution(generator));
+            sqg::Z(b[i], distribution(generator));
+        }
+        if constexpr ( sqg::vec_traits<V>::n_dims > 3 )
+        {
+            sqg::W(a[i], distribution(generator));
+            sqg::W(b[i], distribution(generator));
+        }
+    }
+    const std::span<const V> vectors{ a };
+    std::vector<T> out(a.size());
+
+    SECTION("normalize")
+    {
+        std::vector<V> normalized = a;
+        sqg::normalize_all(std::span<V>{ normalized });
+        for ( std::size_t i = 0; i < a.size(); i++ )
+            require_near_n(normalized[i], sqg::normalized(a[i]), sqg_test::tolerance<T>());
+    }
+
+    SECTION("mag")
+    {
+        sqg::mag2_all(vectors, std::span<T>{ out });
+        for ( std::size_t i = 0; i < a.size(); i++ )
+            REQUIRE_THAT( out[i], WithinAbsMatcher( sqg::mag2(a[i]), sqg_test::tolerance<T>() ) );
+
+        sqg::mag_all(vectors, std::span<T>{ out });
+        for ( std::size_t i = 0; i < a.size(); i++ )
+            REQUIRE_THAT( out[i], WithinAbsMatcher( sqg::mag(a[i]), sqg_test::tolerance<T>() ) );
+    }
+
+    SECTION("dot")
+    {
+        sqg::dot_all(vectors, std::span<const V>{ b }, std::span<T>{ out });
+        for ( std::size_t i = 0; i < a.size(); i++ )
+            REQUIRE_THAT( out[i], WithinAbsMatcher( sqg::dot(a[i], b[i]), sqg_test::tolerance<T>() ) );
+    }
+
+    SECTION("sum")
+    {
+        using sqg::operator+;
+        using sqg::operator-;
+        using sqg::operator/;
+        sqg::vec_value<V> expected;
+        sqg::set_zero(expected);
+        for ( const V& v : a )
+            expected = expected + v;
+
+        // deterministic is exactly the running sum
+        const sqg::vec_value<V> deterministic = sqg::sum(vectors);
+        REQUIRE( sqg::mag(expected - deterministic) == T{0} );
+
+        const T tolerance = sqg_test::tolerance<T>() * static_cast<T>(a.size());
+        require_near_n(sqg::sum<sqg::reduction::fast>(vectors), expected, tolerance);
+        require_near_n(sqg::centroid(vectors), expected / static_cast<T>(a.size()), sqg_test::tolerance<T>());
+        require_near_n(sqg::centroid<sqg::reduction::fast>(vectors), expected / static_cast<T>(a.size()), sqg_test::tolerance<T>());
+
+        REQUIRE( sqg::mag(sqg::sum<sqg::reduction::fast>(std::span<const V>{})) == T{0} );
+        REQUIRE( sqg::mag(sqg::sum(vectors.first(1)) - a[0]) == T{0} );
+    }
+}
+
+template<typename Q>
+void require_near_quat( const Q& a, const sqg::quat<sqg::vec_scalar<Q>>& b )
+{
+    using T = sqg::vec_scalar<Q>;
+    REQUIRE_THAT( sqg::W(a), WithinAbsMatcher( b.w, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( sqg::X(a), WithinAbsMatcher( b.x, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( sqg::Y(a), WithinAbsMatcher( b.y, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( sqg::Z(a), WithinAbsMatcher( b.z, sqg_test::tolerance<T>() ) );
+}
+
+template<typename T>
+sqg::quat<T> random_rotation( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+    sqg::quat<T> q;
+    sqg::set_rot(q, sqg::normalized(sqg::vec3<T>{ distribution(generator), distribution(generator), distribution(generator) }), distribution(generator));
+    return q;
+}
+
+template<typename Q>
+void test_compose_span( std::mt19937& generator )
+{
+    using T = sqg::vec_scalar<Q>;
+    std::vector<Q> a(37), b(a.size()), out(a.size());
+    for ( std::size_t i = 0; i < a.size(); i++ )
+    {
+        a[i] = Q(random_rotation<T>(generator));
+        b[i] = Q(random_rotation<T>(generator));
+    }
+    const sqg::quat<T> q = random_rotation<T>(generator);
+
+    SECTION("compose")
+    {
+        sqg::compose_all(std::span<const Q>{ a }, std::span<const Q>{ b }, std::span<Q>{ out });
+        for ( std::size_t i = 0; i < a.size(); i++ )
+            require_near_quat(out[i], sqg::quat<T>(a[i] * b[i]));
+    }
+
+    SECTION("premultiply")
+    {
+        out = b;
+        sqg::premultiply_all(q, std::span<Q>{ out });
+        for ( std::size_t i = 0; i < a.size(); i++ )
+            require_near_quat(out[i], sqg::quat<T>(Q(q) * b[i]));
+    }
+}
+
+template<typename C>
+void test_compose_container( std::mt19937& generator )
+{
+    using T = C::scalar_type;
+    C a, b;
+    for ( int i = 0; i < 37; i++ )
+    {
+        a.push_back(random_rotation<T>(generator));
+        b.push_back(random_rotation<T>(generator));
+    }
+    const sqg::quat<T> q = random_rotation<T>(generator);
+
+    SECTION("compose")
+    {
+        C out(a.size());
+        sqg::compose_all(a, b, out);
+        for ( std::size_t i = 0; i < a.size(); i++ )
+            require_near_quat(out[i], sqg::quat<T>(a[i]) * sqg::quat<T>(b[i]));
+    }
+
+    SECTION("premultiply")
+    {
+        const C original = b;
+        sqg::premultiply_all(q, b);
+        for ( std::size_t i = 0; i < b.size(); i++ )
+            require_near_quat(b[i], q * sqg::quat<T>(original[i]));
+    }
+}
+
+TEST_CASE("transform points")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("vec3") { test_transform_span<sqg::vec3f>(generator); }
+    SECTION("vec3 double") { test_transform_span<sqg::vec3d>(generator); }
+    SECTION("vec3a") { test_transform_span<sqg::vec3af>(generator); }
+    SECTION("user") { test_transform_span<sqg_test::vector<double,3>>(generator); }
+    SECTION("soa") { test_transform_soa<float>(generator); }
+    SECTION("soa double") { test_transform_soa<double>(generator); }
+}
+
+TEST_CASE("rotate many")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("vec3") { test_rotate_many<sqg::vec3f>(generator); }
+    SECTION("vec3 double") { test_rotate_many<sqg::vec3d>(generator); }
+    SECTION("vec3a") { test_rotate_many<sqg::vec3af>(generator); }
+    SECTION("user") { test_rotate_many<sqg_test::vector<float,3>>(generator); }
+    SECTION("soa") { test_rotate_many_soa<float>(generator); }
+    SECTION("soa double") { test_rotate_many_soa<double>(generator); }
+}
+
+TEST_CASE("batch reductions")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("vec2") { test_reductions<sqg::vec2f>(generator); }
+    SECTION("vec3") { test_reductions<sqg::vec3f>(generator); }
+    SECTION("vec3 double") { test_reductions<sqg::vec3d>(generator); }
+    SECTION("vec3a") { test_reductions<sqg::vec3af>(generator); }
+    SECTION("vec4") { test_reductions<sqg::vec4<double>>(generator); }
+    SECTION("vec4a") { test_reductions<sqg::vec4af>(generator); }
+    SECTION("quat") { test_reductions<sqg::quatf>(generator); }
+    SECTION("user") { test_reductions<sqg_test::vector<double,3>>(generator); }
+}
+
+TEST_CASE("compose quaternions")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("quat") { test_compose_span<sqg::quatf>(generator); }
+    SECTION("quat double") { test_compose_span<sqg::quatd>(generator); }
+    SECTION("quata") { test_compose_span<sqg::quataf>(generator); }
+    SECTION("soa") { test_compose_container<sqg::quat_soa<float>>(generator); }
+    SECTION("soa double") { test_compose_container<sqg::quat_soa<double>>(generator); }
+    SECTION("block") { test_compose_container<sqg::quat_block<float>>(generator); }
+    SECTION("block double") { test_compose_container<sqg::quat_block<double,4>>(generator); }
+}
+
+template<typename Q, typename M>
+void test_convert_all( std::mt19937& generator )
+{
+    using T = sqg::vec_scalar<Q>;
+    std::vector<Q> quaternions(37), back(quaternions.size());
+    for ( auto& q : quaternions )
+        q = Q(random_rotation<T>(generator));
+
+    std::vector<M> matrices(quaternions.size());
+    if constexpr ( sqg::concepts::mat44_type<M> )
+    {
+        for ( auto& m : matrices )
+        {
+            sqg::set_identity(m);
+            sqg::A<0,3>(m, T(5));
+        }
+    }
+
+    sqg::convert_all(std::span<const Q>{ quaternions }, std::span<M>{ matrices });
+    for ( std::size_t i = 0; i < quaternions.size(); i++ )
+    {
+        const sqg::mat33<T> expected = sqg::convert_to<sqg::mat33<T>>(quaternions[i]);
+        sqg::mat33<T> actual;
+        if constexpr ( sqg::concepts::mat44_type<M> )
+            actual = sqg::convert_to<sqg::mat33<T>>(sqg::orientation(matrices[i]));
+        else
+            actual = sqg::convert_to<sqg::mat33<T>>(matrices[i]);
+        for ( int row = 0; row < 3; row++ )
+        {
+            for ( int col = 0; col < 3; col++ )
+                REQUIRE_THAT( actual.a[row][col], WithinAbsMatcher( expected.a[row][col], sqg_test::tolerance<T>() ) );
+        }
+        if constexpr ( sqg::concepts::mat44_type<M> )
+        {
+            REQUIRE( sqg::A<0,3>(matrices[i]) == T(5) );
+            REQUIRE( sqg::A<3,3>(matrices[i]) == T(1) );
+        }
+    }
+
+    sqg::convert_all(std::span<const M>{ matrices }, std::span<Q>{ back });
+    for ( std::size_t i = 0; i < quaternions.size(); i++ )
+    {
+        // the largest component comes back positive, q and -q are the same rotation
+        const sqg::quat<T> q = sqg::quat<T>(quaternions[i]);
+        const T sign = sqg::dot(q, sqg::quat<T>(back[i])) < 0 ? T{-1} : T{1};
+        require_near_quat(back[i], sqg::quat<T>{ sign * q.w, sign * q.x, sign * q.y, sign * q.z });
+    }
+}
+
+TEST_CASE("convert quaternions and matrices")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("mat33") { test_convert_all<sqg::quatf, sqg::mat33f>(generator); }
+    SECTION("mat33 double") { test_convert_all<sqg::quatd, sqg::mat33d>(generator); }
+    SECTION("mat44") { test_convert_all<sqg::quatf, sqg::mat44f>(generator); }
+    SECTION("mat44 double") { test_convert_all<sqg::quatd, sqg::mat44d>(generator); }
+    SECTION("quata") { test_convert_all<sqg::quataf, sqg::mat33f>(generator); }
+    SECTION("user") { test_convert_all<sqg::quatd, sqg_test::matrix<double,3,3>>(generator); }
+}
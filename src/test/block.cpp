@@ -0,0 +1,137 @@
+#include <sqg.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+using Catch::Matchers::WithinAbsMatcher;
+
+static_assert( sqg::concepts::vec3_type<sqg::vec3_block<float>::reference> );
+static_assert( sqg::concepts::read_vec3_type<sqg::vec3_block<float>::const_reference> );
+static_assert( !sqg::concepts::vec3_type<sqg::vec3_block<float>::const_reference> );
+static_assert( sqg::concepts::vec4_type<sqg::vec4_block<double,4>::reference> );
+static_assert( sqg::concepts::quat_type<sqg::quat_block<float>::reference> );
+static_assert( std::random_access_iterator<sqg::vec3_block<float>::iterator> );
+static_assert( std::same_as<sqg::vec3_block<float>::wide_type, sqg::vec3<sqg::wide8f>> );
+static_assert( sizeof(sqg::vec3_block<float>::wide_type) == 3 * 8 * sizeof(float) );
+
+template<typename T>
+void test_block( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+
+    // not a multiple of the block width so the last block is partly used
+    std::vector<sqg::vec3<T>> aos(21);
+    sqg::vec3_block<T> vectors;
+    for ( auto& v : aos )
+    {
+        v = sqg_test::random_vec3(distribution, generator);
+        vectors.push_back(v);
+    }
+    REQUIRE( vectors.size() == aos.size() );
+    REQUIRE( vectors.block_count() == 3 );
+
+    SECTION("components")
+    {
+        for ( std::size_t i = 0; i < aos.size(); i++ )
+        {
+            REQUIRE( vectors.blocks()[i / 8].x[i % 8] == aos[i].x );
+            REQUIRE( vectors.blocks()[i / 8].y[i % 8] == aos[i].y );
+            REQUIRE( vectors.blocks()[i / 8].z[i % 8] == aos[i].z );
+            REQUIRE( sqg::vec3<T>(vectors[i]) == aos[i] );
+        }
+    }
+
+    SECTION("free functions")
+    {
+        const sqg::vec3_block<T>& read = vectors;
+        for ( std::size_t i = 0; i + 1 < aos.size(); i++ )
+        {
+            REQUIRE( sqg::dot(read[i], vectors[i + 1]) == sqg::dot(aos[i], aos[i + 1]) );
+            REQUIRE( sqg::cross(vectors[i], read[i + 1]) == sqg::cross(aos[i], aos[i + 1]) );
+            REQUIRE( sqg::normalized(read[i]) == sqg::normalized(aos[i]) );
+        }
+    }
+
+    SECTION("write through")
+    {
+        auto element = vectors[3];
+        sqg::normalize(element);
+        REQUIRE( sqg::vec3<T>(vectors[3]) == sqg::normalized(aos[3]) );
+
+        vectors[4] = vectors[17];
+        REQUIRE( sqg::vec3<T>(vectors[4]) == aos[17] );
+
+        vectors[9] = sqg::vec3<T>{ T{1}, T{2}, T{3} };
+        REQUIRE( vectors.blocks()[1].y[1] == T{2} );
+    }
+
+    SECTION("iterators")
+    {
+        std::size_t i = 0;
+        for ( auto v : vectors )
+        {
+            v = v * T{2};
+            REQUIRE( sqg::vec3<T>(v) == aos[i] * T{2} );
+            i++;
+        }
+        REQUIRE( i == aos.size() );
+        REQUIRE( std::distance(vectors.begin(), vectors.end()) == static_cast<std::ptrdiff_t>(aos.size()) );
+        REQUIRE( sqg::vec3<T>(vectors.begin()[7]) == aos[7] * T{2} );
+    }
+
+    SECTION("blocks")
+    {
+        for ( auto& b : vectors.blocks() )
+            b = b * sqg::wide<T,8>{ T{2} };
+
+        for ( std::size_t i = 0; i < aos.size(); i++ )
+            REQUIRE( sqg::vec3<T>(vectors[i]) == aos[i] * T{2} );
+
+        // padding lanes of the last block stay zero
+        for ( int j = 21 % 8; j < 8; j++ )
+            REQUIRE( sqg::X(vectors.blocks()[2]).lane[j] == T{0} );
+    }
+
+    SECTION("resize")
+    {
+        vectors.resize(10);
+        REQUIRE( vectors.block_count() == 2 );
+        vectors.resize(21);
+        for ( std::size_t i = 0; i < 10; i++ )
+            REQUIRE( sqg::vec3<T>(vectors[i]) == aos[i] );
+        for ( std::size_t i = 10; i < 21; i++ )
+            REQUIRE( sqg::vec3<T>(vectors[i]) == sqg::vec3<T>{} );
+
+        vectors.clear();
+        REQUIRE( vectors.empty() );
+        REQUIRE( vectors.block_count() == 0 );
+    }
+
+    SECTION("quaternions")
+    {
+        sqg::quat_block<T,4> rotations(aos.size());
+        REQUIRE( rotations.block_count() == 6 );
+        REQUIRE( sqg::quat<T>(rotations[0]) == sqg::quat<T>{} );
+        REQUIRE( sqg::W(rotations.blocks()[5]).lane[3] == T{1} );
+
+        for ( std::size_t i = 0; i < aos.size(); i++ )
+        {
+            auto rotation = rotations[i];
+            sqg::set_rot(rotation, sqg::normalized(aos[i]), distribution(generator));
+            const sqg::quat<T> q = rotations[i];
+            REQUIRE( rotations[i] * aos[i] == q * aos[i] );
+            REQUIRE( sqg::W(rotations[i]) == rotations.blocks()[i / 4].w[i % 4] );
+        }
+    }
+}
+
+TEST_CASE("block")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("float") { test_block<float>(generator); }
+    SECTION("double") { test_block<double>(generator); }
+}
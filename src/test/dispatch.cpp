@@ -0,0 +1,391 @@
+#include <sqg.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <limits>
+#include <vector>
+
+using Catch::Matchers::WithinAbsMatcher;
+
+// the kernels read vec3 arrays as interleaved x,y,z
+static_assert( sizeof(sqg::vec3<float>) == 3 * sizeof(float) );
+static_assert( sizeof(sqg::vec3<double>) == 3 * sizeof(double) );
+
+template<typename T>
+void require_near( const sqg::vec3<T>& a, const sqg::vec3<T>& b )
+{
+    REQUIRE_THAT( a.x, WithinAbsMatcher( b.x, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( a.y, WithinAbsMatcher( b.y, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( a.z, WithinAbsMatcher( b.z, sqg_test::tolerance<T>() ) );
+}
+
+template<typename T>
+void test_dispatch( std::mt19937& generator, sqg::dispatch::level l )
+{
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+
+    REQUIRE( sqg::dispatch::force_level(l) == l );
+    REQUIRE( sqg::dispatch::active_level() == l );
+
+    // not a multiple of any level width so every kernel runs its tail
+    constexpr std::size_t count = 37;
+    std::vector<sqg::vec3<T>> in(count);
+    std::vector<sqg::vec3<T>> out(count);
+    for ( auto& v : in )
+        v = sqg_test::random_vec3(distribution, generator);
+
+    sqg::mat44<T> m;
+    for ( int row = 0; row < 4; row++ )
+    {
+        for ( int col = 0; col < 4; col++ )
+            m.a[row][col] = distribution(generator);
+    }
+
+    SECTION("transform points")
+    {
+        sqg::dispatch::transform_points(&in[0].x, &out[0].x, count, &m.a[0][0]);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_near(out[i], sqg::transform_point(m, in[i]));
+    }
+
+    SECTION("transform dirs")
+    {
+        sqg::dispatch::transform_dirs(&in[0].x, &out[0].x, count, &m.a[0][0]);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_near(out[i], sqg::transform_dir(m, in[i]));
+    }
+
+    SECTION("transform soa")
+    {
+        std::vector<T> x(count), y(count), z(count);
+        for ( std::size_t i = 0; i < count; i++ )
+        {
+            x[i] = in[i].x;
+            y[i] = in[i].y;
+            z[i] = in[i].z;
+        }
+
+        // in place, each output array is its input
+        sqg::dispatch::transform_soa(x.data(), y.data(), z.data(), x.data(), y.data(), z.data(), count, &m.a[0][0]);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_near(sqg::vec3<T>{ x[i], y[i], z[i] }, sqg::transform_point(m, in[i]));
+    }
+
+    SECTION("normalize")
+    {
+        sqg::dispatch::normalize(&in[0].x, &out[0].x, count);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_near(out[i], sqg::normalized(in[i]));
+    }
+
+    SECTION("normalize fast")
+    {
+        // rsqrt estimate plus one Newton step, 2^-21 relative for either type
+        const T tolerance = T{1.0e-6};
+        sqg::dispatch::normalize_fast<1>(&in[0].x, &out[0].x, count);
+        for ( std::size_t i = 0; i < count; i++ )
+        {
+            const auto exact = sqg::normalized(in[i]);
+            REQUIRE_THAT( out[i].x, WithinAbsMatcher( exact.x, tolerance ) );
+            REQUIRE_THAT( out[i].y, WithinAbsMatcher( exact.y, tolerance ) );
+            REQUIRE_THAT( out[i].z, WithinAbsMatcher( exact.z, tolerance ) );
+        }
+    }
+
+    SECTION("normalize4 fast")
+    {
+        std::vector<sqg::quat<T>> quaternions(count);
+        for ( auto& q : quaternions )
+            q = { distribution(generator), distribution(generator), distribution(generator), distribution(generator) };
+
+        std::vector<sqg::quat<T>> result(count);
+        sqg::dispatch::normalize4_fast<3>(&quaternions[0].w, &result[0].w, count);
+        for ( std::size_t i = 0; i < count; i++ )
+        {
+            const auto exact = sqg::normalized(quaternions[i]);
+            REQUIRE_THAT( result[i].w, WithinAbsMatcher( exact.w, 4 * std::numeric_limits<T>::epsilon() ) );
+            REQUIRE_THAT( result[i].x, WithinAbsMatcher( exact.x, 4 * std::numeric_limits<T>::epsilon() ) );
+            REQUIRE_THAT( result[i].y, WithinAbsMatcher( exact.y, 4 * std::numeric_limits<T>::epsilon() ) );
+            REQUIRE_THAT( result[i].z, WithinAbsMatcher( exact.z, 4 * std::numeric_limits<T>::epsilon() ) );
+        }
+    }
+
+    SECTION("mag")
+    {
+        std::vector<T> lengths(count);
+        sqg::dispatch::mag2(&in[0].x, lengths.data(), count);
+        for ( std::size_t i = 0; i < count; i++ )
+            REQUIRE_THAT( lengths[i], WithinAbsMatcher( sqg::mag2(in[i]), sqg_test::tolerance<T>() ) );
+
+        sqg::dispatch::mag(&in[0].x, lengths.data(), count);
+        for ( std::size_t i = 0; i < count; i++ )
+            REQUIRE_THAT( lengths[i], WithinAbsMatcher( sqg::mag(in[i]), sqg_test::tolerance<T>() ) );
+
+        sqg::dispatch::dot(&in[0].x, &in[1].x, lengths.data(), count - 1);
+        for ( std::size_t i = 0; i + 1 < count; i++ )
+            REQUIRE_THAT( lengths[i], WithinAbsMatcher( sqg::dot(in[i], in[i + 1]), sqg_test::tolerance<T>() ) );
+    }
+
+    SECTION("sum")
+    {
+        sqg::vec3<T> expected{};
+        for ( const auto& v : in )
+            expected = expected + v;
+
+        sqg::vec3<T> total;
+        sqg::dispatch::sum<3>(&in[0].x, count, &total.x);
+        require_near(total, expected);
+
+        // the same data as 2 and 4 component vectors, the flat sums match
+        T flat[4];
+        sqg::dispatch::sum<4>(&in[0].x, count * 3 / 4, flat);
+        T sum4 = 0;
+        for ( std::size_t i = 0; i < count * 3 / 4 * 4; i++ )
+            sum4 += ( &in[0].x )[i];
+        REQUIRE_THAT( flat[0] + flat[1] + flat[2] + flat[3], WithinAbsMatcher( sum4, sqg_test::tolerance<T>() * count ) );
+
+        sqg::dispatch::sum<2>(&in[0].x, count, flat);
+        T even = 0;
+        for ( std::size_t i = 0; i < count; i++ )
+            even += ( &in[0].x )[2 * i];
+        REQUIRE_THAT( flat[0], WithinAbsMatcher( even, sqg_test::tolerance<T>() * count ) );
+    }
+
+    SECTION("compose")
+    {
+        std::vector<sqg::quat<T>> a(count), b(count), result(count);
+        for ( std::size_t i = 0; i < count; i++ )
+        {
+            sqg::set_rot(a[i], sqg::normalized(sqg_test::random_vec3(distribution, generator)), distribution(generator));
+            sqg::set_rot(b[i], sqg::normalized(sqg_test::random_vec3(distribution, generator)), distribution(generator));
+        }
+
+        auto require_quat = [&]( const sqg::quat<T>& r, const sqg::quat<T>& expected ) {
+            REQUIRE_THAT( r.w, WithinAbsMatcher( expected.w, sqg_test::tolerance<T>() ) );
+            REQUIRE_THAT( r.x, WithinAbsMatcher( expected.x, sqg_test::tolerance<T>() ) );
+            REQUIRE_THAT( r.y, WithinAbsMatcher( expected.y, sqg_test::tolerance<T>() ) );
+            REQUIRE_THAT( r.z, WithinAbsMatcher( expected.z, sqg_test::tolerance<T>() ) );
+        };
+
+        sqg::dispatch::compose(&a[0].w, &b[0].w, &result[0].w, count);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_quat(result[i], a[i] * b[i]);
+
+        sqg::dispatch::premultiply(&a[0].w, &b[0].w, &result[0].w, count);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_quat(result[i], a[0] * b[i]);
+
+        // the soa kernels read component arrays, split a and b into them
+        std::vector<T> components(8 * count);
+        for ( std::size_t i = 0; i < count; i++ )
+        {
+            for ( int c = 0; c < 4; c++ )
+            {
+                components[c * count + i] = ( &a[i].w )[c];
+                components[( 4 + c ) * count + i] = ( &b[i].w )[c];
+            }
+        }
+        const T* pa[4] = { &components[0], &components[count], &components[2 * count], &components[3 * count] };
+        const T* pb[4] = { &components[4 * count], &components[5 * count], &components[6 * count], &components[7 * count] };
+        std::vector<T> out(4 * count);
+        T* po[4] = { &out[0], &out[count], &out[2 * count], &out[3 * count] };
+
+        sqg::dispatch::compose_soa(pa, pb, po, count);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_quat(sqg::quat<T>{ po[0][i], po[1][i], po[2][i], po[3][i] }, a[i] * b[i]);
+
+        sqg::dispatch::premultiply_soa(&a[0].w, pb, po, count);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_quat(sqg::quat<T>{ po[0][i], po[1][i], po[2][i], po[3][i] }, a[0] * b[i]);
+
+        // blocks of 4 lanes, the padding lanes of the last block must be left alone
+        constexpr std::size_t block_width = 4;
+        const std::size_t padded = ( count + block_width - 1 ) / block_width * block_width;
+        auto lane = [&]( std::size_t i, int c ) { return i / block_width * 4 * block_width + c * block_width + i % block_width; };
+        std::vector<T> block_a(4 * padded), block_b(4 * padded), block_out(4 * padded, T(7));
+        for ( std::size_t i = 0; i < count; i++ )
+        {
+            for ( int c = 0; c < 4; c++ )
+            {
+                block_a[lane(i, c)] = ( &a[i].w )[c];
+                block_b[lane(i, c)] = ( &b[i].w )[c];
+            }
+        }
+        auto block_quat = [&]( std::size_t i ) {
+            return sqg::quat<T>{ block_out[lane(i, 0)], block_out[lane(i, 1)], block_out[lane(i, 2)], block_out[lane(i, 3)] };
+        };
+
+        sqg::dispatch::compose_blocks(block_a.data(), block_b.data(), block_out.data(), count, block_width);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_quat(block_quat(i), a[i] * b[i]);
+        for ( std::size_t i = count; i < padded; i++ )
+            REQUIRE( block_out[lane(i, 0)] == T(7) );
+
+        sqg::dispatch::premultiply_blocks(&a[0].w, block_b.data(), block_out.data(), count, block_width);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_quat(block_quat(i), a[0] * b[i]);
+    }
+
+    SECTION("rotation")
+    {
+        std::vector<sqg::quat<T>> q(count), back(count);
+        for ( std::size_t i = 0; i < count; i++ )
+            sqg::set_rot(q[i], sqg::normalized(sqg_test::random_vec3(distribution, generator)), distribution(generator) * T(3));
+
+        auto require_mat = [&]( const auto& r, const sqg::mat33<T>& expected ) {
+            for ( int row = 0; row < 3; row++ )
+            {
+                for ( int col = 0; col < 3; col++ )
+                    REQUIRE_THAT( r.a[row][col], WithinAbsMatcher( expected.a[row][col], sqg_test::tolerance<T>() ) );
+            }
+        };
+        auto require_quat = [&]( const sqg::quat<T>& r, const sqg::quat<T>& expected ) {
+            REQUIRE_THAT( r.w, WithinAbsMatcher( expected.w, sqg_test::tolerance<T>() ) );
+            REQUIRE_THAT( r.x, WithinAbsMatcher( expected.x, sqg_test::tolerance<T>() ) );
+            REQUIRE_THAT( r.y, WithinAbsMatcher( expected.y, sqg_test::tolerance<T>() ) );
+            REQUIRE_THAT( r.z, WithinAbsMatcher( expected.z, sqg_test::tolerance<T>() ) );
+        };
+
+        std::vector<sqg::mat33<T>> m3(count);
+        sqg::dispatch::quat_to_mat(&q[0].w, &m3[0].a[0][0], count);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_mat(m3[i], sqg::convert_to<sqg::mat33<T>>(q[i]));
+
+        sqg::dispatch::mat_to_quat(&m3[0].a[0][0], &back[0].w, count);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_quat(back[i], sqg::convert_to<sqg::quat<T>>(m3[i]));
+
+        // the translation and last row of the 4x4 matrices must be left alone
+        std::vector<sqg::mat44<T>> m4(count);
+        for ( auto& matrix : m4 )
+            for ( auto& row : matrix.a )
+                for ( auto& element : row )
+                    element = T(7);
+        sqg::dispatch::quat_to_mat<4>(&q[0].w, &m4[0].a[0][0], count);
+        for ( std::size_t i = 0; i < count; i++ )
+        {
+            require_mat(sqg::convert_to<sqg::mat33<T>>(sqg::orientation(m4[i])), m3[i]);
+            REQUIRE( m4[i].a[0][3] == T(7) );
+            REQUIRE( m4[i].a[1][3] == T(7) );
+            REQUIRE( m4[i].a[2][3] == T(7) );
+            for ( int col = 0; col < 4; col++ )
+                REQUIRE( m4[i].a[3][col] == T(7) );
+        }
+
+        sqg::dispatch::mat_to_quat<4>(&m4[0].a[0][0], &back[0].w, count);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_quat(back[i], sqg::convert_to<sqg::quat<T>>(m3[i]));
+    }
+
+    SECTION("multiply parents")
+    {
+        // node 0 is the root, nodes 1 to count - 1 are its children and the last node is also written
+        std::vector<sqg::mat44<T>> local(count), world(count), expected(count);
+        std::vector<std::uint32_t> parents(count, 0), nodes(count - 1);
+        for ( std::size_t i = 0; i < count; i++ )
+        {
+            for ( auto& row : local[i].a )
+                for ( auto& element : row )
+                    element = distribution(generator);
+        }
+        world[0] = local[0];
+        for ( std::size_t i = 1; i < count; i++ )
+        {
+            nodes[i - 1] = static_cast<std::uint32_t>(count - i);
+            expected[i] = world[0] * local[i];
+        }
+
+        sqg::dispatch::multiply_parents(&world[0].a[0][0], &local[0].a[0][0], parents.data(), nodes.data(), nodes.size());
+        for ( std::size_t i = 1; i < count; i++ )
+        {
+            for ( int row = 0; row < 4; row++ )
+            {
+                for ( int col = 0; col < 4; col++ )
+                    REQUIRE_THAT( world[i].a[row][col], WithinAbsMatcher( expected[i].a[row][col], sqg_test::tolerance<T>() * 4 ) );
+            }
+        }
+    }
+
+    SECTION("dual quaternions")
+    {
+        std::vector<sqg::dualquat<T>> a(count), b(count), out(count);
+        for ( std::size_t i = 0; i < count; i++ )
+        {
+            a[i] = sqg::rigid_dualquat(sqg::rot_quat(sqg::normalized(sqg_test::random_vec3(distribution, generator)), distribution(generator)), sqg_test::random_vec3(distribution, generator));
+            b[i] = sqg::rigid_dualquat(sqg::rot_quat(sqg::normalized(sqg_test::random_vec3(distribution, generator)), distribution(generator)), in[i]);
+        }
+        auto require_dualquat = [&]( const sqg::dualquat<T>& r, const sqg::dualquat<T>& expected ) {
+            const T* pr = &r.real.w;
+            const T* pe = &expected.real.w;
+            for ( int c = 0; c < 8; c++ )
+                REQUIRE_THAT( pr[c], WithinAbsMatcher( pe[c], sqg_test::tolerance<T>() * 4 ) );
+        };
+
+        sqg::dispatch::compose_dualquats(&a[0].real.w, &b[0].real.w, &out[0].real.w, count);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_dualquat(out[i], a[i] * b[i]);
+
+        // every other b is on the far side of a
+        for ( std::size_t i = 0; i < count; i += 2 )
+            b[i] = -b[i];
+        sqg::dispatch::blend_dualquats(&a[0].real.w, &b[0].real.w, T{0.75}, &out[0].real.w, count);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_dualquat(out[i], sqg::dlb(a[i], b[i], T{0.75}));
+
+        for ( std::size_t i = 0; i < count; i++ )
+            b[i] = b[i] * distribution(generator);
+        sqg::dispatch::normalize_dualquats(&b[0].real.w, &out[0].real.w, count);
+        for ( std::size_t i = 0; i < count; i++ )
+            require_dualquat(out[i], sqg::normalized(b[i]));
+
+        std::vector<sqg::mat34<T>> m34(count);
+        std::vector<sqg::mat44<T>> m44(count);
+        sqg::dispatch::dualquat_to_mat<3>(&a[0].real.w, &m34[0].a[0][0], count);
+        sqg::dispatch::dualquat_to_mat<4>(&a[0].real.w, &m44[0].a[0][0], count);
+        for ( std::size_t i = 0; i < count; i++ )
+        {
+            const sqg::mat44<T> expected = sqg::mat44<T>(a[i]);
+            for ( int row = 0; row < 4; row++ )
+            {
+                for ( int col = 0; col < 4; col++ )
+                {
+                    REQUIRE_THAT( m44[i].a[row][col], WithinAbsMatcher( expected.a[row][col], sqg_test::tolerance<T>() * 4 ) );
+                    if ( row < 3 )
+                        REQUIRE( m34[i].a[row][col] == m44[i].a[row][col] );
+                }
+            }
+        }
+    }
+
+    SECTION("short")
+    {
+        sqg::dispatch::normalize(&in[0].x, &out[0].x, 1);
+        require_near(out[0], sqg::normalized(in[0]));
+        sqg::dispatch::transform_points(&in[0].x, &out[0].x, 0, &m.a[0][0]);
+    }
+
+    sqg::dispatch::reset_level();
+}
+
+TEST_CASE("dispatch")
+{
+    std::mt19937 generator(Catch::getSeed());
+
+    const auto detected = sqg::dispatch::detected_level();
+    for ( int i = 0; i <= static_cast<int>(detected); i++ )
+    {
+        const auto l = static_cast<sqg::dispatch::level>(i);
+        DYNAMIC_SECTION(sqg::dispatch::level_name(l) << " float") { test_dispatch<float>(generator, l); }
+        DYNAMIC_SECTION(sqg::dispatch::level_name(l) << " double") { test_dispatch<double>(generator, l); }
+    }
+
+    SECTION("force level")
+    {
+        REQUIRE( sqg::dispatch::force_level(sqg::dispatch::level::avx512) == detected );
+        REQUIRE( sqg::dispatch::force_level(sqg::dispatch::level::scalar) == sqg::dispatch::level::scalar );
+        REQUIRE( sqg::dispatch::active_level() == sqg::dispatch::level::scalar );
+        sqg::dispatch::reset_level();
+        REQUIRE( sqg::dispatch::active_level() == detected );
+    }
+}
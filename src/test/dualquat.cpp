@@ -0,0 +1,215 @@
+#include <sqg.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vector>
+
+using Catch::Matchers::WithinAbsMatcher;
+
+static_assert( sizeof(sqg::dualquatf) == 8 * sizeof(float) );
+static_assert( sqg::concepts::dualquat_type<sqg::dualquatd> && !sqg::concepts::dualquat_type<sqg::quatd> );
+
+static_assert( [] {
+    constexpr sqg::dualquat<double> dq = sqg::rigid_dualquat(sqg::quat<double>{}, sqg::vec3<double>{ 1, 2, 3 });
+    return sqg::translation(dq) == sqg::vec3<double>{ 1, 2, 3 } && dq * sqg::vec3<double>{ 1, 1, 1 } == sqg::vec3<double>{ 2, 3, 4 } &&
+        dq * sqg::conjugate(dq) == sqg::identity_dualquat<double>();
+}() );
+
+template<typename T>
+void require_near( const sqg::vec3<T>& a, const sqg::vec3<T>& b )
+{
+    REQUIRE_THAT( a.x, WithinAbsMatcher( b.x, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( a.y, WithinAbsMatcher( b.y, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( a.z, WithinAbsMatcher( b.z, sqg_test::tolerance<T>() ) );
+}
+
+template<typename T>
+void require_near( const sqg::quat<T>& a, const sqg::quat<T>& b )
+{
+    REQUIRE_THAT( a.w, WithinAbsMatcher( b.w, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( a.x, WithinAbsMatcher( b.x, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( a.y, WithinAbsMatcher( b.y, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( a.z, WithinAbsMatcher( b.z, sqg_test::tolerance<T>() ) );
+}
+
+template<typename T>
+void require_near( const sqg::dualquat<T>& a, const sqg::dualquat<T>& b )
+{
+    require_near(a.real, b.real);
+    require_near(a.dual, b.dual);
+}
+
+template<typename T, typename M>
+void require_near_mat( const M& a, const sqg::mat44<T>& b, int rows )
+{
+    for ( int row = 0; row < rows; row++ )
+    {
+        for ( int col = 0; col < 4; col++ )
+            REQUIRE_THAT( a.a[row][col], WithinAbsMatcher( b.a[row][col], sqg_test::tolerance<T>() ) );
+    }
+}
+
+template<typename T>
+void test_dualquat( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+    auto random_quat = [&]() { return sqg::rot_quat(sqg::normalized(sqg_test::random_vec3(distribution, generator)), distribution(generator)); };
+    auto random_dualquat = [&]() { return sqg::rigid_dualquat(random_quat(), sqg_test::random_vec3(distribution, generator)); };
+
+    SECTION("rigid")
+    {
+        const sqg::quat<T> q = random_quat();
+        const sqg::vec3<T> t = sqg_test::random_vec3(distribution, generator);
+        const sqg::dualquat<T> dq = sqg::rigid_dualquat(q, t);
+
+        REQUIRE( sqg::rotation(dq) == q );
+        require_near(sqg::translation(dq), t);
+
+        const sqg::vec3<T> v = sqg_test::random_vec3(distribution, generator);
+        require_near(sqg::transform_point(dq, v), q * v + t);
+        require_near(sqg::transform_dir(dq, v), q * v);
+        require_near(dq * v, q * v + t);
+
+        sqg::dualquat<T> identity;
+        sqg::set_identity(identity);
+        REQUIRE( identity == sqg::identity_dualquat<T>() );
+        REQUIRE( identity != dq );
+    }
+
+    SECTION("matches mat44")
+    {
+        for ( int i = 0; i < 100; i++ )
+        {
+            const sqg::dualquat<T> a = random_dualquat();
+            const sqg::dualquat<T> b = random_dualquat();
+            const sqg::mat44<T> ma = sqg::mat44<T>(a);
+            const sqg::mat44<T> mb = sqg::mat44<T>(b);
+
+            require_near_mat<T>(sqg::mat44<T>(a * b), ma * mb, 4);
+            require_near_mat<T>(sqg::mat34<T>(a * b), ma * mb, 3);
+            require_near_mat<T>(sqg::mat44<T>(sqg::inverse(a)), sqg::rigid_inverse(ma), 4);
+
+            const sqg::vec3<T> v = sqg_test::random_vec3(distribution, generator);
+            require_near(a * v, sqg::transform_point(ma, v));
+            require_near(sqg::transform_dir(a, v), sqg::transform_dir(ma, v));
+        }
+    }
+
+    SECTION("from matrix")
+    {
+        const sqg::dualquat<T> dq = random_dualquat();
+        sqg::dualquat<T> from44, from34;
+        sqg::assign(from44, sqg::mat44<T>(dq));
+        sqg::assign(from34, sqg::mat34<T>(dq));
+
+        // the matrix does not know the sign of the quaternion
+        const T sign = sqg::dot(from44.real, dq.real) < T{0} ? T{-1} : T{1};
+        require_near(from44, dq * sign);
+        require_near(from34, dq * sign);
+    }
+
+    SECTION("normalize")
+    {
+        const sqg::dualquat<T> dq = random_dualquat();
+        sqg::dualquat<T> scaled = dq * T{3};
+        scaled.dual.w += T{0.25};
+        sqg::normalize(scaled);
+
+        REQUIRE_THAT( sqg::mag(scaled.real), WithinAbsMatcher( T{1}, sqg_test::tolerance<T>() ) );
+        REQUIRE_THAT( sqg::dot(scaled.real, scaled.dual), WithinAbsMatcher( T{0}, sqg_test::tolerance<T>() ) );
+        require_near(scaled.real, dq.real);
+    }
+
+    SECTION("sclerp")
+    {
+        const sqg::dualquat<T> a = random_dualquat();
+        const sqg::dualquat<T> b = random_dualquat();
+        const sqg::vec3<T> v = sqg_test::random_vec3(distribution, generator);
+
+        require_near(sqg::sclerp(a, b, T{0}) * v, a * v);
+        require_near(sqg::sclerp(a, b, T{1}) * v, b * v);
+        require_near(sqg::sclerp(a, -b, T{1}) * v, b * v);
+
+        // constant speed, two half steps make the whole step
+        const sqg::dualquat<T> half = sqg::sclerp(a, b, T{0.5});
+        require_near(( half * sqg::conjugate(a) * half ) * v, b * v);
+        require_near(sqg::sclerp(a, b, T{0.25}) * v, sqg::sclerp(a, half, T{0.5}) * v);
+
+        // the blends agree half way
+        require_near(sqg::dlb(a, b, T{0.5}) * v, half * v);
+        require_near(sqg::dlb(a, -b, T{0.5}) * v, half * v);
+
+        // a pure translation moves in a straight line
+        const sqg::dualquat<T> t = sqg::rigid_dualquat(a.real, sqg::translation(a) + sqg::vec3<T>{ 2, 0, 0 });
+        require_near(sqg::translation(sqg::sclerp(a, t, T{0.25})), sqg::translation(a) + sqg::vec3<T>{ T{0.5}, 0, 0 });
+    }
+
+    SECTION("dlb")
+    {
+        const std::vector<sqg::dualquat<T>> dqs = { random_dualquat(), random_dualquat(), random_dualquat() };
+        const std::vector<T> weights = { T{0.5}, T{0.3}, T{0.2} };
+        const sqg::dualquat<T> blend = sqg::dlb(std::span<const sqg::dualquat<T>>{ dqs }, std::span<const T>{ weights });
+        REQUIRE_THAT( sqg::mag(blend.real), WithinAbsMatcher( T{1}, sqg_test::tolerance<T>() ) );
+
+        const std::vector<sqg::dualquat<T>> pair = { dqs[0], -dqs[1] };
+        const std::vector<T> halves = { T{0.5}, T{0.5} };
+        require_near(sqg::dlb(std::span<const sqg::dualquat<T>>{ pair }, std::span<const T>{ halves }), sqg::dlb(dqs[0], dqs[1], T{0.5}));
+
+        const std::vector<T> single = { T{2} };
+        require_near(sqg::dlb(std::span<const sqg::dualquat<T>>{ dqs }.first(1), std::span<const T>{ single }), dqs[0]);
+    }
+
+    SECTION("batch")
+    {
+        constexpr std::size_t count = 37;
+        std::vector<sqg::dualquat<T>> a(count), b(count), out(count);
+        for ( std::size_t i = 0; i < count; i++ )
+        {
+            a[i] = random_dualquat();
+            b[i] = random_dualquat();
+        }
+        const std::span<const sqg::dualquat<T>> ca{ a }, cb{ b };
+
+        sqg::compose_all(ca, cb, std::span<sqg::dualquat<T>>{ out });
+        for ( std::size_t i = 0; i < count; i++ )
+            require_near(out[i], a[i] * b[i]);
+
+        sqg::dlb_all(ca, cb, T{0.3}, std::span<sqg::dualquat<T>>{ out });
+        for ( std::size_t i = 0; i < count; i++ )
+            require_near(out[i], sqg::dlb(a[i], b[i], T{0.3}));
+
+        for ( std::size_t i = 0; i < count; i++ )
+            out[i] = a[i] * T{2};
+        sqg::normalize_all(std::span<sqg::dualquat<T>>{ out });
+        for ( std::size_t i = 0; i < count; i++ )
+            require_near(out[i], a[i]);
+
+        std::vector<sqg::mat44<T>> m44(count);
+        std::vector<sqg::mat34<T>> m34(count);
+        sqg::convert_all(ca, std::span<sqg::mat44<T>>{ m44 });
+        sqg::convert_all(ca, std::span<sqg::mat34<T>>{ m34 });
+        for ( std::size_t i = 0; i < count; i++ )
+        {
+            require_near_mat<T>(m44[i], sqg::mat44<T>(a[i]), 4);
+            require_near_mat<T>(m34[i], sqg::mat44<T>(a[i]), 3);
+        }
+
+        std::vector<sqg::vec3<T>> points(count), expected(count), actual(count);
+        for ( auto& p : points )
+            p = sqg_test::random_vec3(distribution, generator);
+        sqg::transform_points(std::span<const sqg::vec3<T>>{ points }, a[0], std::span<sqg::vec3<T>>{ actual });
+        for ( std::size_t i = 0; i < count; i++ )
+            require_near(actual[i], a[0] * points[i]);
+        sqg::transform_dirs(std::span<const sqg::vec3<T>>{ points }, a[0], std::span<sqg::vec3<T>>{ actual });
+        for ( std::size_t i = 0; i < count; i++ )
+            require_near(actual[i], sqg::transform_dir(a[0], points[i]));
+    }
+}
+
+TEST_CASE("dualquat")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("float") { test_dualquat<float>(generator); }
+    SECTION("double") { test_dualquat<double>(generator); }
+}
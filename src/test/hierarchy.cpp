@@ -0,0 +1,215 @@
+#include <sqg.h>
+#include <sqg_hierarchy.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <vector>
+
+using Catch::Matchers::WithinAbsMatcher;
+
+template<typename T>
+void require_near_mat( const sqg::mat44<T>& a, const sqg::mat44<T>& b )
+{
+    for ( int row = 0; row < 4; row++ )
+    {
+        for ( int col = 0; col < 4; col++ )
+            REQUIRE_THAT( a.a[row][col], WithinAbsMatcher( b.a[row][col], sqg_test::tolerance<T>() ) );
+    }
+}
+
+// parents before children, mostly shallow with a few long chains
+std::vector<std::uint32_t> random_parents( std::mt19937& generator, std::size_t count )
+{
+    std::vector<std::uint32_t> parents(count);
+    for ( std::size_t i = 0; i < count; i++ )
+    {
+        if ( i < 3 )
+            parents[i] = sqg::transform_hierarchy<float>::no_parent;
+        else if ( i % 50 == 0 )
+            parents[i] = static_cast<std::uint32_t>(i - 1);
+        else
+            parents[i] = std::uniform_int_distribution<std::uint32_t>{ 0, static_cast<std::uint32_t>(i - 1) }(generator);
+    }
+    return parents;
+}
+
+template<typename T>
+void test_hierarchy( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> distribution{ T{-1}, T{1} };
+    const std::vector<std::uint32_t> parents = random_parents(generator, 3000);
+    sqg::transform_hierarchy<T> hierarchy(parents);
+
+    for ( std::size_t node = 0; node < hierarchy.size(); node++ )
+    {
+        sqg::quat<T> q;
+        sqg::set_rot(q, sqg::normalized(sqg::vec3<T>{ distribution(generator), distribution(generator), distribution(generator) }), distribution(generator));
+        hierarchy.set_local(node, sqg::vec3<T>{ distribution(generator), distribution(generator), distribution(generator) }, q);
+    }
+
+    // parents come first so the worlds can be built in node order
+    std::vector<sqg::mat44<T>> expected(hierarchy.size());
+    for ( std::size_t node = 0; node < hierarchy.size(); node++ )
+    {
+        const std::uint32_t parent = hierarchy.parent(node);
+        expected[node] = parent == hierarchy.no_parent ? hierarchy.local(node) : expected[parent] * hierarchy.local(node);
+    }
+
+    auto require_worlds = [&]() {
+        for ( std::size_t node = 0; node < hierarchy.size(); node++ )
+            require_near_mat(hierarchy.world(node), expected[node]);
+    };
+
+    SECTION("levels")
+    {
+        std::size_t total = 0;
+        for ( std::size_t l = 0; l < hierarchy.levels(); l++ )
+        {
+            for ( std::uint32_t node : hierarchy.level(l) )
+            {
+                if ( l == 0 )
+                    REQUIRE( hierarchy.parent(node) == hierarchy.no_parent );
+                else
+                    REQUIRE( std::ranges::count(hierarchy.level(l - 1), hierarchy.parent(node)) == 1 );
+            }
+            total += hierarchy.level(l).size();
+        }
+        REQUIRE( total == hierarchy.size() );
+        REQUIRE( hierarchy.level(0).size() == 3 );
+    }
+
+    SECTION("update")
+    {
+        hierarchy.update();
+        require_worlds();
+    }
+
+    SECTION("parallel update")
+    {
+        sqg::parallel::thread_pool pool(4);
+        hierarchy.update(pool, { .tile_bytes = 4096, .cutover = 0 });
+        require_worlds();
+    }
+
+    SECTION("policy update")
+    {
+        hierarchy.update(std::execution::par, { .cutover = 0 });
+        require_worlds();
+    }
+
+    SECTION("local changes")
+    {
+        hierarchy.update();
+        hierarchy.local(0).a[0][3] += T{1};
+        hierarchy.update();
+        REQUIRE_THAT( hierarchy.world(0).a[0][3], WithinAbsMatcher( expected[0].a[0][3] + T{1}, sqg_test::tolerance<T>() ) );
+    }
+
+    SECTION("dirty updates")
+    {
+        hierarchy.update();
+        REQUIRE( hierarchy.changed().size() == hierarchy.size() );
+        REQUIRE( !hierarchy.is_dirty(0) );
+
+        sqg::parallel::thread_pool pool(4);
+        for ( int frame = 0; frame < 4; frame++ )
+        {
+            // a few percent of the nodes move, some of them below another moving node. The first frames only
+            // move a few late nodes, which have small subtrees that are walked rather than scanned.
+            const bool few = frame < 2;
+            std::vector<std::uint8_t> moved(hierarchy.size(), 0);
+            for ( int i = 0; i < ( few ? 3 : 100 ); i++ )
+            {
+                const std::size_t node = std::uniform_int_distribution<std::size_t>{ few ? hierarchy.size() - 100 : 0, hierarchy.size() - 1 }(generator);
+                sqg::quat<T> q;
+                sqg::set_rot(q, sqg::normalized(sqg::vec3<T>{ distribution(generator), distribution(generator), distribution(generator) }), distribution(generator));
+                hierarchy.set_local(node, sqg::vec3<T>{ distribution(generator), distribution(generator), distribution(generator) }, q);
+                REQUIRE( hierarchy.is_dirty(node) );
+                moved[node] = 1;
+            }
+
+            // a node changes when it or any ancestor moved
+            std::vector<std::uint8_t> changed(hierarchy.size(), 0);
+            for ( std::size_t node = 0; node < hierarchy.size(); node++ )
+            {
+                const std::uint32_t parent = hierarchy.parent(node);
+                changed[node] = moved[node] || ( parent != hierarchy.no_parent && changed[parent] );
+                expected[node] = parent == hierarchy.no_parent ? hierarchy.local(node) : expected[parent] * hierarchy.local(node);
+            }
+
+            if ( frame % 2 == 0 )
+                hierarchy.update_dirty();
+            else
+                hierarchy.update_dirty(pool, { .tile_bytes = 4096, .cutover = 0 });
+            require_worlds();
+
+            REQUIRE( hierarchy.changed().size() == static_cast<std::size_t>(std::ranges::count(changed, std::uint8_t{1})) );
+            std::vector<std::uint8_t> seen(hierarchy.size(), 0);
+            for ( std::uint32_t node : hierarchy.changed() )
+            {
+                REQUIRE( changed[node] );
+                REQUIRE( !seen[node] );
+                REQUIRE( !hierarchy.is_dirty(node) );
+                const std::uint32_t parent = hierarchy.parent(node);
+                if ( parent != hierarchy.no_parent && changed[parent] )
+                    REQUIRE( seen[parent] );
+                seen[node] = 1;
+            }
+        }
+
+        hierarchy.update_dirty();
+        REQUIRE( hierarchy.changed().empty() );
+    }
+
+    SECTION("mark dirty")
+    {
+        hierarchy.update();
+        const std::uint32_t node = hierarchy.level(1)[0];
+        hierarchy.local(node).a[1][3] += T{1};
+        hierarchy.mark_dirty(node);
+        hierarchy.mark_dirty(node);
+        hierarchy.update_dirty();
+
+        std::size_t count = 1;
+        std::vector<std::uint32_t> pending{ node };
+        while ( !pending.empty() )
+        {
+            const std::uint32_t n = pending.back();
+            pending.pop_back();
+            for ( std::uint32_t child : hierarchy.children(n) )
+            {
+                REQUIRE( hierarchy.parent(child) == n );
+                pending.push_back(child);
+                count++;
+            }
+        }
+        REQUIRE( hierarchy.changed().size() == count );
+        REQUIRE( hierarchy.changed()[0] == node );
+        REQUIRE_THAT( hierarchy.world(node).a[1][3], WithinAbsMatcher( expected[node].a[1][3] + hierarchy.world(hierarchy.parent(node)).a[1][1], sqg_test::tolerance<T>() ) );
+    }
+}
+
+TEST_CASE("transform hierarchy")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("float") { test_hierarchy<float>(generator); }
+    SECTION("double") { test_hierarchy<double>(generator); }
+
+    SECTION("empty")
+    {
+        sqg::transform_hierarchy<float> hierarchy;
+        REQUIRE( hierarchy.empty() );
+        REQUIRE( hierarchy.levels() == 0 );
+        hierarchy.update();
+
+        sqg::transform_hierarchy<float> none(std::span<const std::uint32_t>{});
+        REQUIRE( none.levels() == 0 );
+        none.update(sqg::parallel::default_pool());
+        none.update_dirty();
+        REQUIRE( none.changed().empty() );
+    }
+}
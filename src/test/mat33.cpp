@@ -5,6 +5,8 @@
 #include <catch2/catch_get_random_seed.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include <numbers>
+#include <span>
+#include <vector>
 
 #include <sqg_mat.h>
 #include <sqg_mat_view.h>
@@ -142,4 +144,73 @@ TEST_CASE("Rotation")
 
     test_rot<double>(generator);
     test_rot<float>(generator);
-}
\ No newline at end of file
+}
+static_assert( [] {
+    constexpr sqg::mat33<double> m = {{ { 2.0, 0.0, 0.0 }, { 0.0, 4.0, 0.0 }, { 0.0, 0.0, 8.0 } }};
+    constexpr sqg::mat33<double> expected = {{ { 0.5, 0.0, 0.0 }, { 0.0, 0.25, 0.0 }, { 0.0, 0.0, 0.125 } }};
+    return sqg::inverse(m) == expected;
+}() );
+
+template<typename T>
+sqg::mat33<T> random_invertible( std::mt19937& generator )
+{
+    // diagonally dominant so it is well conditioned
+    std::uniform_real_distribution<T> distribution{ T{-1}, T{1} };
+    sqg::mat33<T> m;
+    for ( int row = 0; row < 3; row++ )
+    {
+        for ( int col = 0; col < 3; col++ )
+            m.a[row][col] = distribution(generator) + ( row == col ? T{4} : T{0} );
+    }
+    return m;
+}
+
+template<typename T>
+void require_identity( const sqg::mat33<T>& m, T tolerance )
+{
+    for ( int row = 0; row < 3; row++ )
+    {
+        for ( int col = 0; col < 3; col++ )
+        {
+            CAPTURE(row, col);
+            REQUIRE_THAT( m.a[row][col], Catch::Matchers::WithinAbsMatcher( row == col ? T{1} : T{0}, tolerance ) );
+        }
+    }
+}
+
+template<typename T>
+void test_inverse( std::mt19937& generator, T tolerance )
+{
+    SECTION("Randomised Test")
+    {
+        for ( int i = 0; i < 100; i++ )
+        {
+            const sqg::mat33<T> m = random_invertible<T>(generator);
+            const sqg::mat33<T> inv = sqg::inverse(m);
+            require_identity<T>(m * inv, tolerance);
+            require_identity<T>(inv * m, tolerance);
+        }
+    }
+
+    SECTION("Batch")
+    {
+        std::vector<sqg::mat33<T>> matrices(19);
+        for ( auto& m : matrices )
+            m = random_invertible<T>(generator);
+
+        std::vector<sqg::mat33<T>> inverses(matrices.size());
+        sqg::inverse(std::span<const sqg::mat33<T>>{ matrices }, std::span<sqg::mat33<T>>{ inverses });
+        for ( std::size_t i = 0; i < matrices.size(); i++ )
+        {
+            CAPTURE(i);
+            require_identity<T>(matrices[i] * inverses[i], tolerance);
+        }
+    }
+}
+
+TEST_CASE("Inverse")
+{
+    std::mt19937 generator(Catch::getSeed());
+    test_inverse<double>(generator, 1.0e-12);
+    test_inverse<float>(generator, 1.0e-5f);
+}
@@ -0,0 +1,162 @@
+#include <sqg.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <vector>
+
+using Catch::Matchers::WithinAbsMatcher;
+
+static_assert( sizeof(sqg::mat34f) == 12 * sizeof(float) );
+static_assert( sqg::concepts::mat34_type<sqg::mat34d> && sqg::concepts::simd_mat34_type<sqg::mat34d> );
+static_assert( !sqg::concepts::mat_type<sqg::mat34d> && !sqg::concepts::mat34_type<sqg::mat44d> );
+
+static_assert( [] {
+    constexpr sqg::mat34<double> m = {{ { 2.0, 0.0, 0.0, 1.0 }, { 0.0, 4.0, 0.0, 2.0 }, { 0.0, 0.0, 8.0, 3.0 } }};
+    constexpr sqg::mat34<double> expected = {{ { 0.5, 0.0, 0.0, -0.5 }, { 0.0, 0.25, 0.0, -0.5 }, { 0.0, 0.0, 0.125, -0.375 } }};
+    return sqg::inverse(m) == expected && m * expected == sqg::identity_mat34<double>() &&
+        sqg::transform_point(m, sqg::vec3d{ 1, 1, 1 }) == sqg::vec3d{ 3, 6, 11 };
+}() );
+
+template<typename T>
+sqg::mat44<T> random_affine( std::mt19937& generator )
+{
+    // diagonally dominant orientation so it is well conditioned
+    std::uniform_real_distribution<T> distribution{ T{-1}, T{1} };
+    sqg::mat44<T> m = sqg::identity_mat<T,4>();
+    for ( int row = 0; row < 3; row++ )
+    {
+        for ( int col = 0; col < 4; col++ )
+            m.a[row][col] = distribution(generator) + ( row == col ? T{4} : T{0} );
+    }
+    return m;
+}
+
+template<typename T>
+sqg::mat44<T> random_rigid( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+
+    sqg::mat44<T> m = sqg::identity_mat<T,4>();
+    sqg::orientation(m) = sqg::rot_quat(sqg::normalized(sqg_test::random_vec3(distribution, generator)), distribution(generator));
+    sqg::position(m) = sqg_test::random_vec3(distribution, generator);
+    return m;
+}
+
+template<typename T>
+void require_near( const sqg::mat34<T>& a, const sqg::mat44<T>& b )
+{
+    for ( int row = 0; row < 3; row++ )
+    {
+        for ( int col = 0; col < 4; col++ )
+            REQUIRE_THAT( a.a[row][col], WithinAbsMatcher( b.a[row][col], sqg_test::tolerance<T>() ) );
+    }
+}
+
+template<typename T>
+void require_near( const sqg::vec3<T>& a, const sqg::vec3<T>& b )
+{
+    REQUIRE_THAT( a.x, WithinAbsMatcher( b.x, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( a.y, WithinAbsMatcher( b.y, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( a.z, WithinAbsMatcher( b.z, sqg_test::tolerance<T>() ) );
+}
+
+template<typename T>
+void test_mat34( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> distribution{ T{-10}, T{10} };
+
+    SECTION("conversion")
+    {
+        const sqg::mat44<T> m44 = random_affine<T>(generator);
+        const sqg::mat34<T> m34 = sqg::mat34<T>(m44);
+        for ( int row = 0; row < 3; row++ )
+        {
+            for ( int col = 0; col < 4; col++ )
+                REQUIRE( m34.a[row][col] == m44.a[row][col] );
+        }
+        REQUIRE( sqg::mat44<T>(m34) == m44 );
+
+        sqg::mat34<T> copy;
+        sqg::assign(copy, m34);
+        REQUIRE( copy == m34 );
+        copy.a[2][3] += T{1};
+        REQUIRE( copy != m34 );
+    }
+
+    SECTION("views")
+    {
+        sqg::mat34<T> m = sqg::identity_mat34<T>();
+        const sqg::quat<T> q = sqg::rot_quat(sqg::normalized(sqg_test::random_vec3(distribution, generator)), T{1});
+        const sqg::vec3<T> t = sqg_test::random_vec3(distribution, generator);
+        sqg::orientation(m) = q;
+        sqg::position(m) = t;
+
+        REQUIRE( sqg::vec3<T>(sqg::position(m)) == t );
+        const sqg::mat33<T> r = sqg::convert_to<sqg::mat33<T>>(q);
+        REQUIRE( sqg::mat33<T>(sqg::orientation(m)) == r );
+
+        const sqg::vec3<T> v = sqg_test::random_vec3(distribution, generator);
+        require_near(sqg::transform_point(m, v), q * v + t);
+        require_near(sqg::transform_dir(m, v), q * v);
+        require_near(m * v, q * v + t);
+    }
+
+    SECTION("matches mat44")
+    {
+        for ( int i = 0; i < 100; i++ )
+        {
+            const sqg::mat44<T> a = random_affine<T>(generator);
+            const sqg::mat44<T> b = random_affine<T>(generator);
+            const sqg::mat34<T> a34 = sqg::mat34<T>(a);
+            const sqg::mat34<T> b34 = sqg::mat34<T>(b);
+
+            require_near(a34 * b34, a * b);
+            require_near(sqg::inverse(a34), sqg::affine_inverse(a));
+            require_near(sqg::affine_inverse(a34), sqg::affine_inverse(a));
+
+            const sqg::mat44<T> rigid = random_rigid<T>(generator);
+            require_near(sqg::rigid_inverse(sqg::mat34<T>(rigid)), sqg::rigid_inverse(rigid));
+
+            const sqg::vec3<T> v = sqg_test::random_vec3(distribution, generator);
+            require_near(sqg::transform_point(a34, v), sqg::transform_point(a, v));
+            require_near(sqg::transform_dir(a34, v), sqg::transform_dir(a, v));
+        }
+    }
+
+    SECTION("inverse")
+    {
+        const sqg::mat34<T> m = sqg::mat34<T>(random_affine<T>(generator));
+        const sqg::mat34<T> identity = m * sqg::inverse(m);
+        require_near(identity, sqg::identity_mat<T,4>());
+    }
+
+    SECTION("batch")
+    {
+        const sqg::mat44<T> m44 = random_affine<T>(generator);
+        const sqg::mat34<T> m34 = sqg::mat34<T>(m44);
+
+        std::vector<sqg::vec3<T>> points(37);
+        for ( sqg::vec3<T>& p : points )
+            p = sqg_test::random_vec3(distribution, generator);
+
+        std::vector<sqg::vec3<T>> expected(points.size());
+        std::vector<sqg::vec3<T>> actual(points.size());
+        sqg::transform_points(std::span<const sqg::vec3<T>>{ points }, m44, std::span<sqg::vec3<T>>{ expected });
+        sqg::transform_points(std::span<const sqg::vec3<T>>{ points }, m34, std::span<sqg::vec3<T>>{ actual });
+        for ( std::size_t i = 0; i < points.size(); i++ )
+            REQUIRE( actual[i] == expected[i] );
+
+        sqg::transform_dirs(std::span<const sqg::vec3<T>>{ points }, m44, std::span<sqg::vec3<T>>{ expected });
+        sqg::transform_dirs(std::span<const sqg::vec3<T>>{ points }, m34, std::span<sqg::vec3<T>>{ actual });
+        for ( std::size_t i = 0; i < points.size(); i++ )
+            REQUIRE( actual[i] == expected[i] );
+    }
+}
+
+TEST_CASE("mat34")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("float") { test_mat34<float>(generator); }
+    SECTION("double") { test_mat34<double>(generator); }
+}
@@ -0,0 +1,133 @@
+#include <sqg.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+using Catch::Matchers::WithinAbsMatcher;
+
+static_assert( [] {
+    constexpr sqg::mat44<double> m = {{ { 2.0, 0.0, 0.0, 1.0 }, { 0.0, 4.0, 0.0, 2.0 }, { 0.0, 0.0, 8.0, 3.0 }, { 0.0, 0.0, 0.0, 1.0 } }};
+    constexpr sqg::mat44<double> expected = {{ { 0.5, 0.0, 0.0, -0.5 }, { 0.0, 0.25, 0.0, -0.5 }, { 0.0, 0.0, 0.125, -0.375 }, { 0.0, 0.0, 0.0, 1.0 } }};
+    return sqg::determinant(m) == 64.0 && sqg::inverse(m) == expected && sqg::affine_inverse(m) == expected;
+}() );
+
+// affine_inverse and rigid_inverse only read the matrix, so read only views work too
+static_assert( [] {
+    constexpr sqg::mat44<double> column_major = {{ { 1.0, 0.0, 0.0, 0.0 }, { 0.0, 0.0, 1.0, 0.0 }, { 0.0, -1.0, 0.0, 0.0 }, { 1.0, 2.0, 3.0, 1.0 } }};
+    constexpr sqg::mat44<double> expected = {{ { 1.0, 0.0, 0.0, -1.0 }, { 0.0, 0.0, 1.0, -3.0 }, { 0.0, -1.0, 0.0, 2.0 }, { 0.0, 0.0, 0.0, 1.0 } }};
+    return sqg::rigid_inverse(sqg::transposed(column_major)) == expected && sqg::affine_inverse(sqg::transposed(column_major)) == expected;
+}() );
+
+// sqg matrices hold a, the user matrix is a nested std::array
+template<typename M>
+auto& element( M& m, int row, int col )
+{
+    if constexpr ( requires { m.a; } )
+        return m.a[row][col];
+    else
+        return m[row][col];
+}
+
+template<typename M>
+M random_invertible( std::mt19937& generator )
+{
+    // diagonally dominant so it is well conditioned
+    using T = sqg::mat_scalar<M>;
+    std::uniform_real_distribution<T> distribution{ T{-1}, T{1} };
+    M m;
+    for ( int row = 0; row < 4; row++ )
+    {
+        for ( int col = 0; col < 4; col++ )
+            element(m, row, col) = distribution(generator) + ( row == col ? T{4} : T{0} );
+    }
+    return m;
+}
+
+template<typename M>
+M random_rigid( std::mt19937& generator )
+{
+    using T = sqg::mat_scalar<M>;
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+
+    sqg::mat33<T> rotation;
+    sqg::set_rot(rotation, sqg::normalized(sqg::vec3<T>{ distribution(generator), distribution(generator), distribution(generator) }), distribution(generator));
+
+    M m;
+    sqg::set_identity(m);
+    sqg::orientation(m) = rotation;
+    sqg::position(m) = sqg::vec3<T>{ distribution(generator), distribution(generator), distribution(generator) };
+    return m;
+}
+
+template<typename M>
+void require_near( const M& a, const M& b, sqg::mat_scalar<M> tolerance )
+{
+    for ( int row = 0; row < 4; row++ )
+    {
+        for ( int col = 0; col < 4; col++ )
+        {
+            CAPTURE(row, col);
+            REQUIRE_THAT( element(a, row, col), WithinAbsMatcher( element(b, row, col), tolerance ) );
+        }
+    }
+}
+
+template<typename M>
+void test_inverse( std::mt19937& generator, sqg::mat_scalar<M> tolerance )
+{
+    using T = sqg::mat_scalar<M>;
+    using sqg::operator*;
+    M identity;
+    sqg::set_identity(identity);
+
+    SECTION("General")
+    {
+        for ( int i = 0; i < 100; i++ )
+        {
+            const M m = random_invertible<M>(generator);
+            const M inv = sqg::inverse(m);
+            require_near<M>(m * inv, identity, tolerance);
+            require_near<M>(inv * m, identity, tolerance);
+            REQUIRE_THAT( sqg::determinant(m) * sqg::determinant(inv), WithinAbsMatcher( T{1}, tolerance ) );
+        }
+    }
+
+    SECTION("Affine")
+    {
+        for ( int i = 0; i < 100; i++ )
+        {
+            M m = random_invertible<M>(generator);
+            sqg::A<3,0>(m, T{0});
+            sqg::A<3,1>(m, T{0});
+            sqg::A<3,2>(m, T{0});
+            sqg::A<3,3>(m, T{1});
+
+            const M inv = sqg::affine_inverse(m);
+            require_near<M>(m * inv, identity, tolerance);
+            require_near<M>(inv, sqg::inverse(m), tolerance);
+        }
+    }
+
+    SECTION("Rigid")
+    {
+        for ( int i = 0; i < 100; i++ )
+        {
+            const M m = random_rigid<M>(generator);
+            const M inv = sqg::rigid_inverse(m);
+            require_near<M>(m * inv, identity, tolerance);
+            require_near<M>(inv, sqg::affine_inverse(m), tolerance);
+            REQUIRE_THAT( sqg::determinant(m), WithinAbsMatcher( T{1}, tolerance ) );
+        }
+    }
+}
+
+TEST_CASE("mat44 Inverse")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("double") { test_inverse<sqg::mat44<double>>(generator, 1.0e-12); }
+    SECTION("float") { test_inverse<sqg::mat44<float>>(generator, 1.0e-5f); }
+    SECTION("aligned double") { test_inverse<sqg::mat44ad>(generator, 1.0e-12); }
+    SECTION("aligned float") { test_inverse<sqg::mat44af>(generator, 1.0e-5f); }
+    SECTION("user") { test_inverse<sqg_test::matrix<double,4,4>>(generator, 1.0e-12); }
+}
@@ -0,0 +1,260 @@
+#include <sqg.h>
+#include <sqg_parallel.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <atomic>
+#include <execution>
+#include <span>
+#include <vector>
+
+namespace
+{
+    // small tiles and no cutover so a few thousand elements are split across every thread
+    constexpr sqg::parallel::options small_tiles{ .tile_bytes = 1024, .cutover = 0 };
+
+    // Runs bulk inline and records how many tiles it was given
+    struct counting_executor
+    {
+        std::size_t threads = 1;
+        std::size_t tiles = 0;
+
+        std::size_t concurrency() const { return threads; }
+
+        template<typename F>
+        void bulk( std::size_t count, F&& f )
+        {
+            tiles += count;
+            for ( std::size_t i = 0; i < count; i++ )
+                f(i);
+        }
+    };
+
+    template<typename T>
+    std::vector<sqg::vec3<T>> random_points( std::mt19937& generator, std::size_t count )
+    {
+        std::uniform_real_distribution<T> distribution{ T{-10}, T{10} };
+        std::vector<sqg::vec3<T>> points(count);
+        for ( auto& p : points )
+            p = { distribution(generator), distribution(generator), distribution(generator) };
+        return points;
+    }
+
+    template<typename T>
+    sqg::quat<T> random_quat( std::mt19937& generator )
+    {
+        std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+        sqg::quat<T> q;
+        sqg::set_rot(q, sqg::normalized(sqg::vec3<T>{ distribution(generator), distribution(generator), distribution(generator) }), distribution(generator));
+        return q;
+    }
+
+    template<typename T>
+    void require_equal( std::span<const sqg::vec3<T>> a, std::span<const sqg::vec3<T>> b )
+    {
+        REQUIRE( a.size() == b.size() );
+        for ( std::size_t i = 0; i < a.size(); i++ )
+            REQUIRE( a[i] == b[i] );
+    }
+
+    // tiles are whole multiples of the kernel width so the results match the serial functions exactly
+    template<typename T, typename E>
+    void test_parallel( std::mt19937& generator, E&& executor )
+    {
+        const std::size_t count = 5000;
+        const std::vector<sqg::vec3<T>> points = random_points<T>(generator, count);
+        std::vector<sqg::vec3<T>> expected(count), actual(count);
+
+        sqg::mat44<T> transform;
+        sqg::set_identity(transform);
+        sqg::orientation(transform) = random_quat<T>(generator);
+        transform.a[0][3] = T{1};
+        transform.a[1][3] = T{2};
+        transform.a[2][3] = T{3};
+        const sqg::quat<T> q = random_quat<T>(generator);
+
+        SECTION("transform")
+        {
+            sqg::transform_points(std::span{ points }, transform, std::span{ expected });
+            sqg::parallel::transform_points(executor, std::span{ points }, transform, std::span{ actual }, small_tiles);
+            require_equal<T>(actual, expected);
+
+            sqg::transform_dirs(std::span{ points }, q, std::span{ expected });
+            sqg::parallel::transform_dirs(executor, std::span{ points }, q, std::span{ actual }, small_tiles);
+            require_equal<T>(actual, expected);
+
+            expected = points;
+            actual = points;
+            sqg::rotate_many(q, std::span{ expected });
+            sqg::parallel::rotate_many(executor, q, std::span{ actual }, small_tiles);
+            require_equal<T>(actual, expected);
+        }
+
+        SECTION("per element")
+        {
+            expected = points;
+            actual = points;
+            sqg::normalize_all(std::span{ expected });
+            sqg::parallel::normalize_all(executor, std::span{ actual }, small_tiles);
+            require_equal<T>(actual, expected);
+
+            std::vector<T> serial(count), parallel(count);
+            sqg::mag_all(std::span{ points }, std::span{ serial });
+            sqg::parallel::mag_all(executor, std::span{ points }, std::span{ parallel }, small_tiles);
+            REQUIRE( serial == parallel );
+
+            sqg::mag2_all(std::span{ points }, std::span{ serial });
+            sqg::parallel::mag2_all(executor, std::span{ points }, std::span{ parallel }, small_tiles);
+            REQUIRE( serial == parallel );
+
+            sqg::dot_all(std::span{ points }, std::span<const sqg::vec3<T>>{ expected }, std::span{ serial });
+            sqg::parallel::dot_all(executor, std::span{ points }, std::span<const sqg::vec3<T>>{ expected }, std::span{ parallel }, small_tiles);
+            REQUIRE( serial == parallel );
+        }
+
+        SECTION("quaternions")
+        {
+            std::vector<sqg::quat<T>> a(count), b(count), serial(count), parallel(count);
+            for ( std::size_t i = 0; i < count; i++ )
+            {
+                a[i] = random_quat<T>(generator);
+                b[i] = random_quat<T>(generator);
+            }
+            auto require_same = [&]() {
+                for ( std::size_t i = 0; i < count; i++ )
+                    REQUIRE( sqg::vec4<T>(serial[i]) == sqg::vec4<T>(parallel[i]) );
+            };
+
+            sqg::compose_all(std::span<const sqg::quat<T>>{ a }, std::span<const sqg::quat<T>>{ b }, std::span{ serial });
+            sqg::parallel::compose_all(executor, std::span<const sqg::quat<T>>{ a }, std::span<const sqg::quat<T>>{ b }, std::span{ parallel }, small_tiles);
+            require_same();
+
+            serial = b;
+            parallel = b;
+            sqg::premultiply_all(q, std::span{ serial });
+            sqg::parallel::premultiply_all(executor, q, std::span{ parallel }, small_tiles);
+            require_same();
+
+            std::vector<sqg::mat44<T>> matrices(count, transform), parallel_matrices(count, transform);
+            sqg::convert_all(std::span<const sqg::quat<T>>{ a }, std::span{ matrices });
+            sqg::parallel::convert_all(executor, std::span<const sqg::quat<T>>{ a }, std::span{ parallel_matrices }, small_tiles);
+            for ( std::size_t i = 0; i < count; i++ )
+                REQUIRE( matrices[i] == parallel_matrices[i] );
+
+            sqg::convert_all(std::span<const sqg::mat44<T>>{ matrices }, std::span{ serial });
+            sqg::parallel::convert_all(executor, std::span<const sqg::mat44<T>>{ matrices }, std::span{ parallel }, small_tiles);
+            require_same();
+        }
+
+        SECTION("dual quaternions")
+        {
+            std::vector<sqg::dualquat<T>> a(count), b(count), serial(count), parallel(count);
+            for ( std::size_t i = 0; i < count; i++ )
+            {
+                a[i] = sqg::rigid_dualquat(random_quat<T>(generator), points[i]);
+                b[i] = sqg::rigid_dualquat(random_quat<T>(generator), points[count - 1 - i]);
+            }
+            const std::span<const sqg::dualquat<T>> ca{ a }, cb{ b };
+            auto require_same = [&]() {
+                for ( std::size_t i = 0; i < count; i++ )
+                    REQUIRE( serial[i] == parallel[i] );
+            };
+
+            sqg::compose_all(ca, cb, std::span{ serial });
+            sqg::parallel::compose_all(executor, ca, cb, std::span{ parallel }, small_tiles);
+            require_same();
+
+            sqg::dlb_all(ca, cb, T{0.25}, std::span{ serial });
+            sqg::parallel::dlb_all(executor, ca, cb, T{0.25}, std::span{ parallel }, small_tiles);
+            require_same();
+
+            sqg::normalize_all(std::span{ serial });
+            sqg::parallel::normalize_all(executor, std::span{ parallel }, small_tiles);
+            require_same();
+
+            std::vector<sqg::mat34<T>> matrices(count), parallel_matrices(count);
+            sqg::convert_all(ca, std::span{ matrices });
+            sqg::parallel::convert_all(executor, ca, std::span{ parallel_matrices }, small_tiles);
+            for ( std::size_t i = 0; i < count; i++ )
+                REQUIRE( matrices[i] == parallel_matrices[i] );
+
+            sqg::transform_points(std::span{ points }, a[0], std::span{ expected });
+            sqg::parallel::transform_points(executor, std::span{ points }, a[0], std::span{ actual }, small_tiles);
+            require_equal<T>(actual, expected);
+        }
+
+        SECTION("short spans")
+        {
+            sqg::parallel::transform_points(executor, std::span<const sqg::vec3<T>>{}, transform, std::span<sqg::vec3<T>>{});
+
+            // below the default cutover, runs on the calling thread
+            sqg::transform_points(std::span{ points }.first(100), transform, std::span{ expected }.first(100));
+            sqg::parallel::transform_points(executor, std::span{ points }.first(100), transform, std::span{ actual }.first(100));
+            require_equal<T>(std::span{ actual }.first(100), std::span{ expected }.first(100));
+        }
+    }
+}
+
+TEST_CASE("thread pool")
+{
+    sqg::parallel::thread_pool pool(4);
+    REQUIRE( pool.concurrency() == 4 );
+
+    SECTION("every index once")
+    {
+        std::vector<std::atomic<int>> calls(1000);
+        for ( int repeat = 0; repeat < 20; repeat++ )
+            pool.bulk(calls.size(), [&]( std::size_t i ) { calls[i]++; });
+        for ( const auto& c : calls )
+            REQUIRE( c.load() == 20 );
+
+        pool.bulk(0, [&]( std::size_t ) { FAIL(); });
+    }
+
+    SECTION("nested bulk runs inline")
+    {
+        std::atomic<int> calls{ 0 };
+        pool.bulk(8, [&]( std::size_t ) {
+            pool.bulk(8, [&]( std::size_t ) { calls++; });
+        });
+        REQUIRE( calls.load() == 64 );
+    }
+
+    SECTION("single thread")
+    {
+        sqg::parallel::thread_pool inline_pool(1);
+        REQUIRE( inline_pool.concurrency() == 1 );
+        std::size_t total = 0;
+        inline_pool.bulk(10, [&]( std::size_t i ) { total += i; });
+        REQUIRE( total == 45 );
+    }
+
+    SECTION("tiles cover every thread")
+    {
+        // 4096 float vec3 fit in one default tile, they are still split across the threads
+        std::vector<sqg::vec3<float>> vectors(4096, sqg::vec3<float>{ 1.0f, 2.0f, 2.0f });
+        counting_executor executor{ 8 };
+        sqg::parallel::normalize_all(executor, std::span{ vectors }, { .cutover = 0 });
+        REQUIRE( executor.tiles == 8 );
+
+        counting_executor single{ 1 };
+        sqg::parallel::normalize_all(single, std::span{ vectors }, { .cutover = 0 });
+        REQUIRE( single.tiles == 0 );
+    }
+
+    STATIC_REQUIRE( sqg::concepts::executor<sqg::parallel::thread_pool> );
+    STATIC_REQUIRE( sqg::concepts::executor<sqg::parallel::policy_executor<std::execution::parallel_policy>> );
+}
+
+TEST_CASE("parallel batch")
+{
+    std::mt19937 generator(Catch::getSeed());
+    sqg::parallel::thread_pool pool(4);
+
+    SECTION("pool float") { test_parallel<float>(generator, pool); }
+    SECTION("pool double") { test_parallel<double>(generator, pool); }
+    SECTION("default pool") { test_parallel<float>(generator, sqg::parallel::default_pool()); }
+    SECTION("policy") { test_parallel<float>(generator, std::execution::par); }
+    SECTION("sequenced policy") { test_parallel<double>(generator, std::execution::seq); }
+}
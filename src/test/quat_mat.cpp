@@ -0,0 +1,139 @@
+#include <sqg.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cmath>
+#include <numbers>
+
+using Catch::Matchers::WithinAbsMatcher;
+
+namespace
+{
+    constexpr double constexpr_abs( double s ) { return s < 0 ? -s : s; }
+
+    // 90 degrees about z, x goes to y
+    constexpr sqg::mat33d rotz_90 = {{
+        { 0, -1, 0 },
+        { 1,  0, 0 },
+        { 0,  0, 1 },
+    }};
+
+    constexpr sqg::quatd rotz_90_quat = sqg::convert_to<sqg::quatd>(rotz_90);
+    static_assert( constexpr_abs(rotz_90_quat.w - std::numbers::sqrt2 / 2) < 1.0e-15 && constexpr_abs(rotz_90_quat.z - std::numbers::sqrt2 / 2) < 1.0e-15 );
+    static_assert( rotz_90_quat.x == 0 && rotz_90_quat.y == 0 );
+
+    constexpr sqg::mat33d rotz_90_back = sqg::convert_to<sqg::mat33d>(rotz_90_quat);
+    static_assert( constexpr_abs(rotz_90_back.a[1][0] - 1) < 1.0e-15 && constexpr_abs(rotz_90_back.a[0][0]) < 1.0e-15 );
+}
+
+// q and -q are the same rotation
+template<typename T>
+void require_same_rotation( const sqg::quat<T>& a, const sqg::quat<T>& b )
+{
+    const T sign = sqg::dot(a, b) < 0 ? T{-1} : T{1};
+    REQUIRE_THAT( a.w, WithinAbsMatcher( sign * b.w, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( a.x, WithinAbsMatcher( sign * b.x, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( a.y, WithinAbsMatcher( sign * b.y, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( a.z, WithinAbsMatcher( sign * b.z, sqg_test::tolerance<T>() ) );
+}
+
+template<typename T>
+void test_quat_mat( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> distribution{ T{-1}, T{1} };
+    std::uniform_real_distribution<T> angles{ T(-std::numbers::pi), T(std::numbers::pi) };
+    auto random_axis = [&]() { return sqg::normalized(sqg::vec3<T>{ distribution(generator), distribution(generator), distribution(generator) }); };
+
+    SECTION("matrix rotates as the quaternion")
+    {
+        for ( int i = 0; i < 100; i++ )
+        {
+            const sqg::quat<T> q = sqg::rot_quat(random_axis(), angles(generator));
+            const sqg::mat33<T> m = sqg::convert_to<sqg::mat33<T>>(q);
+            const sqg::vec3<T> v{ distribution(generator), distribution(generator), distribution(generator) };
+            const sqg::vec3<T> expected = q * v;
+            const sqg::vec3<T> actual = m * v;
+            REQUIRE_THAT( actual.x, WithinAbsMatcher( expected.x, sqg_test::tolerance<T>() ) );
+            REQUIRE_THAT( actual.y, WithinAbsMatcher( expected.y, sqg_test::tolerance<T>() ) );
+            REQUIRE_THAT( actual.z, WithinAbsMatcher( expected.z, sqg_test::tolerance<T>() ) );
+        }
+    }
+
+    SECTION("round trip")
+    {
+        for ( int i = 0; i < 100; i++ )
+        {
+            const sqg::quat<T> q = sqg::rot_quat(random_axis(), angles(generator));
+            const sqg::quat<T> back = sqg::convert_to<sqg::quat<T>>(sqg::convert_to<sqg::mat33<T>>(q));
+            require_same_rotation(back, q);
+        }
+    }
+
+    SECTION("matches the axis angle matrices")
+    {
+        const T angle = angles(generator);
+        require_same_rotation(sqg::convert_to<sqg::quat<T>>(sqg::rotx_mat(angle)), sqg::rotx_quat(angle));
+        require_same_rotation(sqg::convert_to<sqg::quat<T>>(sqg::roty_mat(angle)), sqg::roty_quat(angle));
+        require_same_rotation(sqg::convert_to<sqg::quat<T>>(sqg::rotz_mat(angle)), sqg::rotz_quat(angle));
+    }
+
+    SECTION("half turns")
+    {
+        // w is zero, each of x, y and z in turn is the largest component
+        for ( int i = 0; i < 100; i++ )
+        {
+            const sqg::quat<T> q = sqg::rot_quat(random_axis(), T(std::numbers::pi));
+            const sqg::quat<T> back = sqg::convert_to<sqg::quat<T>>(sqg::convert_to<sqg::mat33<T>>(q));
+            require_same_rotation(back, q);
+            REQUIRE_THAT( sqg::mag(back), WithinAbsMatcher( T{1}, sqg_test::tolerance<T>() ) );
+        }
+    }
+
+    SECTION("largest component is positive")
+    {
+        const sqg::quat<T> q = sqg::rot_quat(sqg::vec3<T>{ 0, 1, 0 }, T{3});
+        const sqg::quat<T> back = sqg::convert_to<sqg::quat<T>>(sqg::convert_to<sqg::mat33<T>>(sqg::quat<T>{ -q.w, -q.x, -q.y, -q.z }));
+        REQUIRE( back.y > 0 );
+        require_same_rotation(back, q);
+
+        const sqg::quat<T> identity = sqg::convert_to<sqg::quat<T>>(sqg::identity_mat<T,3>());
+        REQUIRE( identity.w == T{1} );
+        REQUIRE( identity.x == T{0} );
+        REQUIRE( identity.y == T{0} );
+        REQUIRE( identity.z == T{0} );
+    }
+
+    SECTION("orientation of a 4x4 matrix")
+    {
+        const sqg::quat<T> q = sqg::rot_quat(random_axis(), angles(generator));
+        sqg::mat44<T> m = sqg::identity_mat<T,4>();
+        m.a[0][3] = T{1};
+        m.a[1][3] = T{2};
+        m.a[2][3] = T{3};
+
+        sqg::orientation(m) = q;
+        REQUIRE( m.a[0][3] == T{1} );
+        REQUIRE( m.a[1][3] == T{2} );
+        REQUIRE( m.a[2][3] == T{3} );
+        REQUIRE( m.a[3][3] == T{1} );
+
+        const sqg::mat33<T> expected = sqg::convert_to<sqg::mat33<T>>(q);
+        for ( int row = 0; row < 3; row++ )
+        {
+            for ( int col = 0; col < 3; col++ )
+                REQUIRE( m.a[row][col] == expected.a[row][col] );
+        }
+
+        const sqg::mat44<T>& cm = m;
+        const sqg::quat<T> back = sqg::convert_to<sqg::quat<T>>(sqg::orientation(cm));
+        require_same_rotation(back, q);
+    }
+}
+
+TEST_CASE("quaternion matrix conversion")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("float") { test_quat_mat<float>(generator); }
+    SECTION("double") { test_quat_mat<double>(generator); }
+}
@@ -0,0 +1,151 @@
+#include <sqg.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using Catch::Matchers::WithinAbsMatcher;
+
+// documented max error in ulp of math::rsqrt_fast, a negative value is a relative error instead
+template<typename T>
+double rsqrt_bound( int refinements );
+
+template<> double rsqrt_bound<float>( int refinements )
+{
+    constexpr double bound[] = { 6144.0, 4.0, 2.0, 2.0 };
+    return bound[refinements];
+}
+
+template<> double rsqrt_bound<double>( int refinements )
+{
+    constexpr double bound[] = { -0x1.0p-12 * 1.5, -0x1.0p-21, 256.0, 2.0 };
+    return bound[refinements];
+}
+
+template<typename T>
+void require_rsqrt_error( T s, T result, int refinements )
+{
+    const long double exact = 1.0L / std::sqrt(static_cast<long double>(s));
+    const long double error = std::fabs(static_cast<long double>(result) - exact);
+    const double bound = rsqrt_bound<T>(refinements);
+
+    CAPTURE(s, result, refinements);
+    if ( bound < 0.0 )
+    {
+        REQUIRE( error <= -bound * exact );
+    }
+    else
+    {
+        const long double ulp = std::ldexp(1.0L, std::ilogb(static_cast<T>(exact)) - std::numeric_limits<T>::digits + 1);
+        REQUIRE( error <= bound * ulp );
+    }
+}
+
+template<typename T>
+void test_rsqrt( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> mantissa{ T{1}, T{4} };
+    std::uniform_int_distribution<int> exponent{ -60, 60 };
+
+    for ( int i = 0; i < 10000; i++ )
+    {
+        const T s = std::ldexp(mantissa(generator), exponent(generator));
+        require_rsqrt_error(s, sqg::math::rsqrt_fast<0>(s), 0);
+        require_rsqrt_error(s, sqg::math::rsqrt_fast<1>(s), 1);
+        require_rsqrt_error(s, sqg::math::rsqrt_fast<2>(s), 2);
+        require_rsqrt_error(s, sqg::math::rsqrt_fast<3>(s), 3);
+    }
+}
+
+// components of a unit vector, so the error is measured in ulp of 1 with one more rounding for mag2 and the multiply
+template<typename T>
+T normalize_tolerance( int refinements )
+{
+    const double bound = rsqrt_bound<T>(refinements);
+    const double epsilon = std::numeric_limits<T>::epsilon();
+    return static_cast<T>(bound < 0.0 ? -bound + 2.0 * epsilon : ( bound + 2.0 ) * epsilon);
+}
+
+template<int refinements, typename V>
+void require_normalized_fast( const V& vector )
+{
+    using T = sqg::vec_scalar<V>;
+    const V fast = sqg::normalized_fast<refinements>(vector);
+    const V exact = sqg::normalized(vector);
+    const T tolerance = normalize_tolerance<T>(refinements);
+
+    CAPTURE(refinements);
+    REQUIRE_THAT( sqg::X(fast), WithinAbsMatcher( sqg::X(exact), tolerance ) );
+    REQUIRE_THAT( sqg::Y(fast), WithinAbsMatcher( sqg::Y(exact), tolerance ) );
+    if constexpr ( sqg::vec_traits<V>::n_dims > 2 )
+        REQUIRE_THAT( sqg::Z(fast), WithinAbsMatcher( sqg::Z(exact), tolerance ) );
+    if constexpr ( sqg::vec_traits<V>::n_dims > 3 )
+        REQUIRE_THAT( sqg::W(fast), WithinAbsMatcher( sqg::W(exact), tolerance ) );
+}
+
+template<typename V>
+void test_normalize_fast( std::mt19937& generator )
+{
+    using T = sqg::vec_scalar<V>;
+    std::uniform_real_distribution<T> distribution{ T{-10}, T{10} };
+
+    std::vector<V> vectors(29);
+    for ( V& v : vectors )
+    {
+        sqg::X(v, distribution(generator));
+        sqg::Y(v, distribution(generator));
+        if constexpr ( sqg::vec_traits<V>::n_dims > 2 )
+            sqg::Z(v, distribution(generator));
+        if constexpr ( sqg::vec_traits<V>::n_dims > 3 )
+            sqg::W(v, distribution(generator));
+    }
+
+    SECTION("single")
+    {
+        for ( const V& v : vectors )
+        {
+            require_normalized_fast<0>(v);
+            require_normalized_fast<1>(v);
+            require_normalized_fast<2>(v);
+            require_normalized_fast<3>(v);
+        }
+    }
+
+    SECTION("batch")
+    {
+        std::vector<V> batch = vectors;
+        sqg::normalize_fast<3>(std::span{ batch });
+
+        const T tolerance = normalize_tolerance<T>(3);
+        for ( std::size_t i = 0; i < vectors.size(); i++ )
+        {
+            const V exact = sqg::normalized(vectors[i]);
+            REQUIRE_THAT( sqg::X(batch[i]), WithinAbsMatcher( sqg::X(exact), tolerance ) );
+            REQUIRE_THAT( sqg::Y(batch[i]), WithinAbsMatcher( sqg::Y(exact), tolerance ) );
+        }
+    }
+}
+
+TEST_CASE("rsqrt fast")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("float") { test_rsqrt<float>(generator); }
+    SECTION("double") { test_rsqrt<double>(generator); }
+}
+
+TEST_CASE("normalize fast")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("vec2") { test_normalize_fast<sqg::vec2f>(generator); }
+    SECTION("vec3") { test_normalize_fast<sqg::vec3f>(generator); }
+    SECTION("vec3 double") { test_normalize_fast<sqg::vec3d>(generator); }
+    SECTION("vec4") { test_normalize_fast<sqg::vec4f>(generator); }
+    SECTION("vec4a double") { test_normalize_fast<sqg::vec4ad>(generator); }
+    SECTION("vec3a") { test_normalize_fast<sqg::vec3af>(generator); }
+    SECTION("quat") { test_normalize_fast<sqg::quatf>(generator); }
+    SECTION("quat double") { test_normalize_fast<sqg::quatd>(generator); }
+    SECTION("user") { test_normalize_fast<sqg_test::vector<float,3>>(generator); }
+}
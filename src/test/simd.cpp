@@ -0,0 +1,234 @@
+#include <sqg.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+using Catch::Matchers::WithinAbsMatcher;
+
+static_assert( sqg::concepts::vec4_type<sqg::vec4af> );
+static_assert( sqg::concepts::quat_type<sqg::quataf> );
+static_assert( sqg::concepts::simd_vec4_type<sqg::vec4ad> );
+static_assert( sqg::concepts::simd_quat_type<sqg::quatad> );
+static_assert( ! sqg::concepts::simd_vec4_type<sqg::vec4f> );
+static_assert( alignof(sqg::vec4af) == 16 && sizeof(sqg::vec4af) == 16 );
+static_assert( alignof(sqg::quatad) == 32 && sizeof(sqg::quatad) == 32 );
+
+// constexpr still goes through the scalar path
+static_assert( sqg::dot(sqg::vec4af{ 1.0f, 2.0f, 3.0f, 4.0f }, sqg::vec4af{ 1.0f, 1.0f, 1.0f, 1.0f }) == 10.0f );
+static_assert( ( sqg::quatad{} * sqg::quatad{ 0.0, 1.0, 0.0, 0.0 } ).x == 1.0 );
+
+template<typename T>
+T abs_tolerance();
+
+template<> float abs_tolerance<float>() { return 1.0e-4f; }
+template<> double abs_tolerance<double>() { return 1.0e-10; }
+
+template<typename A, typename B>
+void require_vec4_near( const A& a, const B& b )
+{
+    using scalar = sqg::vec_scalar<A>;
+    REQUIRE_THAT( sqg::W(a), WithinAbsMatcher( sqg::W(b), abs_tolerance<scalar>() ) );
+    REQUIRE_THAT( sqg::X(a), WithinAbsMatcher( sqg::X(b), abs_tolerance<scalar>() ) );
+    REQUIRE_THAT( sqg::Y(a), WithinAbsMatcher( sqg::Y(b), abs_tolerance<scalar>() ) );
+    REQUIRE_THAT( sqg::Z(a), WithinAbsMatcher( sqg::Z(b), abs_tolerance<scalar>() ) );
+}
+
+template<typename T>
+void test_aligned( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> distribution{ T{-10}, T{10} };
+
+    for ( int i = 0; i < 100; i++ )
+    {
+        const sqg::vec4<T> a = { distribution(generator), distribution(generator), distribution(generator), distribution(generator) };
+        const sqg::vec4<T> b = { distribution(generator), distribution(generator), distribution(generator), distribution(generator) };
+        const T s = distribution(generator);
+
+        const sqg::vec4a<T> aa = { a.x, a.y, a.z, a.w };
+        const sqg::vec4a<T> ab = { b.x, b.y, b.z, b.w };
+
+        SECTION("vec4a")
+        {
+            require_vec4_near( aa + ab, a + b );
+            require_vec4_near( aa - ab, a - b );
+            require_vec4_near( s * aa, s * a );
+            require_vec4_near( aa * s, a * s );
+            REQUIRE_THAT( sqg::dot(aa, ab), WithinAbsMatcher( sqg::dot(a, b), abs_tolerance<T>() * T{100} ) );
+
+            // x,y,z,w lanes used as a quaternion
+            const sqg::quat<T> qa = { a.w, a.x, a.y, a.z };
+            const sqg::quat<T> qb = { b.w, b.x, b.y, b.z };
+            require_vec4_near( aa * ab, qa * qb );
+        }
+
+        SECTION("quata")
+        {
+            const sqg::quat<T> qa = { a.w, a.x, a.y, a.z };
+            const sqg::quat<T> qb = { b.w, b.x, b.y, b.z };
+            const sqg::quata<T> qaa = { a.w, a.x, a.y, a.z };
+            const sqg::quata<T> qab = { b.w, b.x, b.y, b.z };
+
+            require_vec4_near( qaa * qab, qa * qb );
+            require_vec4_near( qaa + qab, qa + qb );
+            require_vec4_near( sqg::conjugate(qaa), sqg::conjugate(qa) );
+        }
+    }
+}
+
+TEST_CASE("simd aligned types")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("float") { test_aligned<float>(generator); }
+    SECTION("double") { test_aligned<double>(generator); }
+}
+
+static_assert( sqg::concepts::simd_mat44_type<sqg::mat44f> );
+static_assert( sqg::concepts::simd_mat44_type<sqg::mat44ad> );
+static_assert( ! sqg::concepts::simd_mat44_type<sqg::mat44i> );
+static_assert( ! sqg::concepts::simd_mat44_type<sqg_test::matrix<float,4,4>> );
+static_assert( ( sqg::identity_mat<double,4>() * sqg::identity_mat<double,4>() ).a[3][3] == 1.0 );
+
+template<typename A, typename B>
+void require_mat44_near( const A& a, const B& b )
+{
+    using scalar = sqg::mat_scalar<A>;
+    for ( int row = 0; row < 4; row++ )
+    {
+        for ( int col = 0; col < 4; col++ )
+        {
+            CAPTURE(row, col);
+            REQUIRE_THAT( a.a[row][col], WithinAbsMatcher( b[row][col], abs_tolerance<scalar>() * scalar{100} ) );
+        }
+    }
+}
+
+template<typename T, typename M>
+void test_mat44_multiply( std::mt19937& generator )
+{
+    for ( int i = 0; i < 100; i++ )
+    {
+        sqg_test::matrix<T,4,4> a;
+        sqg_test::matrix<T,4,4> b;
+        sqg_test::set_random_matrix<T,4,4>(generator, a, T{-10}, T{10});
+        sqg_test::set_random_matrix<T,4,4>(generator, b, T{-10}, T{10});
+
+        // user trait types take the generic path
+        const sqg_test::matrix<T,4,4> expected = sqg::operator*(a, b);
+
+        M sa;
+        M sb;
+        sqg::assign(sa, a);
+        sqg::assign(sb, b);
+
+        const M result = sa * sb;
+        require_mat44_near(result, expected);
+    }
+}
+
+TEST_CASE("simd mat44 multiply")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("mat44f") { test_mat44_multiply<float, sqg::mat44f>(generator); }
+    SECTION("mat44d") { test_mat44_multiply<double, sqg::mat44d>(generator); }
+    SECTION("mat44af") { test_mat44_multiply<float, sqg::mat44af>(generator); }
+    SECTION("mat44ad") { test_mat44_multiply<double, sqg::mat44ad>(generator); }
+}
+
+static_assert( sqg::transform_point(sqg::mat44ad{ { {1,0,0,1}, {0,1,0,2}, {0,0,1,3}, {0,0,0,1} } }, sqg::vec3d{}).z == 3.0 );
+static_assert( sqg::transform_dir(sqg::mat44ad{ { {1,0,0,1}, {0,1,0,2}, {0,0,1,3}, {0,0,0,1} } }, sqg::vec3d{ 1.0, 0.0, 0.0 }).x == 1.0 );
+
+template<typename T, typename M>
+void test_mat44_vec( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> distribution{ T{-10}, T{10} };
+
+    for ( int i = 0; i < 100; i++ )
+    {
+        sqg_test::matrix<T,4,4> a;
+        sqg_test::set_random_matrix<T,4,4>(generator, a, T{-10}, T{10});
+
+        const sqg::vec3<T> p = { distribution(generator), distribution(generator), distribution(generator) };
+        const sqg::vec4<T> v = { distribution(generator), distribution(generator), distribution(generator), distribution(generator) };
+
+        M sa;
+        sqg::assign(sa, a);
+
+        // user trait types take the generic path
+        const sqg::vec4<T> expected4 = sqg::operator*(a, v);
+        const sqg::vec3<T> expected_point = sqg::transform_point(a, p);
+        const sqg::vec3<T> expected_dir = sqg::transform_dir(a, p);
+
+        require_vec4_near( sa * v, expected4 );
+
+        const sqg::vec3<T> point = sqg::transform_point(sa, p);
+        const sqg::vec3<T> dir = sqg::transform_dir(sa, p);
+        const sqg::vec3<T> product = sa * p;
+        const T tolerance = abs_tolerance<T>() * T{100};
+        for ( int d = 0; d < 3; d++ )
+        {
+            CAPTURE(i, d);
+            REQUIRE_THAT( (&point.x)[d], WithinAbsMatcher( (&expected_point.x)[d], tolerance ) );
+            REQUIRE_THAT( (&dir.x)[d], WithinAbsMatcher( (&expected_dir.x)[d], tolerance ) );
+            REQUIRE_THAT( (&product.x)[d], WithinAbsMatcher( (&expected_point.x)[d], tolerance ) );
+        }
+    }
+}
+
+TEST_CASE("simd mat44 vector")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("mat44f") { test_mat44_vec<float, sqg::mat44f>(generator); }
+    SECTION("mat44d") { test_mat44_vec<double, sqg::mat44d>(generator); }
+    SECTION("mat44af") { test_mat44_vec<float, sqg::mat44af>(generator); }
+    SECTION("mat44ad") { test_mat44_vec<double, sqg::mat44ad>(generator); }
+}
+
+static_assert( sqg::concepts::vec3_type<sqg::vec3af> );
+static_assert( sqg::concepts::simd_vec3_type<sqg::vec3ad> );
+static_assert( ! sqg::concepts::simd_vec3_type<sqg::vec3f> );
+static_assert( ! sqg::concepts::read_vec4_type<sqg::vec3af> );
+static_assert( alignof(sqg::vec3af) == 16 && sizeof(sqg::vec3af) == 16 );
+static_assert( sqg::cross(sqg::vec3ad{ 1.0, 0.0, 0.0 }, sqg::vec3ad{ 0.0, 1.0, 0.0 }).z == 1.0 );
+
+template<typename T>
+void test_padded( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> distribution{ T{-10}, T{10} };
+
+    for ( int i = 0; i < 100; i++ )
+    {
+        const sqg::vec3<T> a = { distribution(generator), distribution(generator), distribution(generator) };
+        const sqg::vec3<T> b = { distribution(generator), distribution(generator), distribution(generator) };
+
+        const sqg::vec3a<T> pa = { a.x, a.y, a.z };
+        const sqg::vec3a<T> pb = { b.x, b.y, b.z };
+
+        // the compiler may contract the scalar cross and dot into fused multiply adds, so these are not bit exact
+        const sqg::vec3a<T> c = sqg::cross(pa, pb);
+        const sqg::vec3<T> expected_cross = sqg::cross(a, b);
+        REQUIRE_THAT( c.x, WithinAbsMatcher( expected_cross.x, abs_tolerance<T>() ) );
+        REQUIRE_THAT( c.y, WithinAbsMatcher( expected_cross.y, abs_tolerance<T>() ) );
+        REQUIRE_THAT( c.z, WithinAbsMatcher( expected_cross.z, abs_tolerance<T>() ) );
+        REQUIRE( sqg::vec3<T>(pa + pb) == a + b );
+        REQUIRE( sqg::vec3<T>(pa - pb) == a - b );
+        REQUIRE_THAT( sqg::dot(pa, pb), WithinAbsMatcher( sqg::dot(a, b), abs_tolerance<T>() ) );
+        REQUIRE( c.pad == T{0} );
+        REQUIRE( ( pa + pb ).pad == T{0} );
+
+        sqg::vec3a<T> n = pa;
+        sqg::normalize(n);
+        const sqg::vec3<T> expected = sqg::normalized(a);
+        REQUIRE_THAT( n.x, WithinAbsMatcher( expected.x, abs_tolerance<T>() ) );
+        REQUIRE_THAT( n.y, WithinAbsMatcher( expected.y, abs_tolerance<T>() ) );
+        REQUIRE_THAT( n.z, WithinAbsMatcher( expected.z, abs_tolerance<T>() ) );
+        REQUIRE( n.pad == T{0} );
+    }
+}
+
+TEST_CASE("simd padded vec3")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("float") { test_padded<float>(generator); }
+    SECTION("double") { test_padded<double>(generator); }
+}
@@ -0,0 +1,181 @@
+#include <sqg.h>
+#include <sqg_skin.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cstdint>
+#include <execution>
+#include <span>
+#include <vector>
+
+using Catch::Matchers::WithinAbsMatcher;
+
+template<typename T>
+void require_near( const sqg::vec3<T>& a, const sqg::vec3<T>& b )
+{
+    REQUIRE_THAT( a.x, WithinAbsMatcher( b.x, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( a.y, WithinAbsMatcher( b.y, sqg_test::tolerance<T>() ) );
+    REQUIRE_THAT( a.z, WithinAbsMatcher( b.z, sqg_test::tolerance<T>() ) );
+}
+
+template<typename T>
+void require_equal( const sqg::vec3_soa<T>& a, const sqg::vec3_soa<T>& b )
+{
+    REQUIRE( a.size() == b.size() );
+    for ( std::size_t i = 0; i < a.size(); i++ )
+        REQUIRE( sqg::vec3<T>(a[i]) == sqg::vec3<T>(b[i]) );
+}
+
+template<typename T>
+void test_skin( std::mt19937& generator, sqg::dispatch::level l )
+{
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+
+    REQUIRE( sqg::dispatch::force_level(l) == l );
+
+    // not a multiple of any level width so the kernel runs its tail
+    constexpr std::size_t bone_count = 20;
+    constexpr std::size_t count = 37;
+    constexpr int influences = 4;
+
+    std::vector<sqg::mat44<T>> bones(bone_count);
+    std::vector<sqg::mat34<T>> bones34(bone_count);
+    std::vector<sqg::mat44a<T>> bones44a(bone_count);
+    for ( std::size_t b = 0; b < bone_count; b++ )
+    {
+        sqg::quat<T> q;
+        sqg::set_rot(q, sqg::normalized(sqg_test::random_vec3(distribution, generator)), distribution(generator));
+        sqg::set_identity(bones[b]);
+        sqg::orientation(bones[b]) = q;
+        sqg::position(bones[b]) = sqg_test::random_vec3(distribution, generator);
+        sqg::assign(bones34[b], bones[b]);
+        sqg::assign(bones44a[b], bones[b]);
+    }
+
+    // the last vertices have a single bone, the rest up to four with some left unused
+    sqg::skin_weights<T> weights(count, influences);
+    std::uniform_int_distribution<std::uint32_t> bone_distribution{ 0, bone_count - 1 };
+    std::uniform_real_distribution<T> weight_distribution{ T{0.1}, T{1} };
+    for ( std::size_t i = 0; i < count; i++ )
+    {
+        const int used = i + 3 >= count ? 1 : 1 + static_cast<int>(i % influences);
+        for ( int k = 0; k < used; k++ )
+            weights.set(i, k, bone_distribution(generator), weight_distribution(generator));
+    }
+    weights.normalize();
+
+    sqg::vec3_soa<T> positions(count), normals(count);
+    for ( std::size_t i = 0; i < count; i++ )
+    {
+        positions[i] = sqg_test::random_vec3(distribution, generator);
+        normals[i] = sqg::normalized(sqg_test::random_vec3(distribution, generator));
+    }
+
+    // the scalar loop the kernel replaces, a weighted sum of 4x4 matrices per vertex
+    std::vector<sqg::vec3<T>> expected_positions(count), expected_normals(count);
+    for ( std::size_t i = 0; i < count; i++ )
+    {
+        sqg::mat44<T> m;
+        for ( int k = 0; k < influences; k++ )
+        {
+            for ( int row = 0; row < 4; row++ )
+            {
+                for ( int col = 0; col < 4; col++ )
+                    m.a[row][col] += weights.weight(i, k) * bones[weights.bone(i, k)].a[row][col];
+            }
+        }
+        expected_positions[i] = sqg::transform_point(m, sqg::vec3<T>(positions[i]));
+        expected_normals[i] = sqg::normalized(sqg::transform_dir(m, sqg::vec3<T>(normals[i])));
+    }
+
+    auto require_skinned = [&]( const sqg::vec3_soa<T>& out_positions, const sqg::vec3_soa<T>* out_normals ) {
+        for ( std::size_t i = 0; i < count; i++ )
+        {
+            require_near(sqg::vec3<T>(out_positions[i]), expected_positions[i]);
+            if ( out_normals )
+                require_near(sqg::vec3<T>(( *out_normals )[i]), expected_normals[i]);
+        }
+    };
+
+    sqg::vec3_soa<T> out_positions(count), out_normals(count);
+
+    SECTION("mat44")
+    {
+        sqg::skin_vertices(std::span<const sqg::mat44<T>>{ bones }, weights, positions, normals, out_positions, out_normals);
+        require_skinned(out_positions, &out_normals);
+    }
+
+    SECTION("mat34")
+    {
+        sqg::skin_vertices(std::span<const sqg::mat34<T>>{ bones34 }, weights, positions, normals, out_positions, out_normals);
+        require_skinned(out_positions, &out_normals);
+    }
+
+    SECTION("unpacked bones")
+    {
+        sqg::skin_vertices(std::span<const sqg::mat44a<T>>{ bones44a }, weights, positions, normals, out_positions, out_normals);
+        require_skinned(out_positions, &out_normals);
+    }
+
+    SECTION("positions only")
+    {
+        sqg::skin_vertices(std::span<const sqg::mat34<T>>{ bones34 }, weights, positions, out_positions);
+        require_skinned(out_positions, nullptr);
+    }
+
+    SECTION("in place")
+    {
+        sqg::skin_vertices(std::span<const sqg::mat44<T>>{ bones }, weights, positions, normals, positions, normals);
+        require_skinned(positions, &normals);
+    }
+
+    SECTION("parallel")
+    {
+        sqg::skin_vertices(std::span<const sqg::mat44<T>>{ bones }, weights, positions, normals, out_positions, out_normals);
+
+        sqg::vec3_soa<T> parallel_positions(count), parallel_normals(count);
+        sqg::parallel::thread_pool pool(4);
+        sqg::parallel::skin_vertices(pool, std::span<const sqg::mat44<T>>{ bones }, weights, positions, normals, parallel_positions, parallel_normals,
+                                     { .tile_bytes = 64, .cutover = 0 });
+        require_equal(parallel_positions, out_positions);
+        require_equal(parallel_normals, out_normals);
+
+        sqg::parallel::skin_vertices(std::execution::par, std::span<const sqg::mat44<T>>{ bones }, weights, positions, parallel_positions, { .cutover = 0 });
+        require_equal(parallel_positions, out_positions);
+    }
+
+    sqg::dispatch::reset_level();
+}
+
+TEST_CASE("skin")
+{
+    std::mt19937 generator(Catch::getSeed());
+
+    const auto detected = sqg::dispatch::detected_level();
+    for ( int i = 0; i <= static_cast<int>(detected); i++ )
+    {
+        const auto l = static_cast<sqg::dispatch::level>(i);
+        DYNAMIC_SECTION(sqg::dispatch::level_name(l) << " float") { test_skin<float>(generator, l); }
+        DYNAMIC_SECTION(sqg::dispatch::level_name(l) << " double") { test_skin<double>(generator, l); }
+    }
+
+    SECTION("weights")
+    {
+        sqg::skin_weights<float> weights(3, 2);
+        REQUIRE( weights.size() == 3 );
+        REQUIRE( weights.influences() == 2 );
+        REQUIRE( weights.bone(2, 1) == 0 );
+        REQUIRE( weights.weight(2, 1) == 0.0f );
+
+        weights.set(1, 0, 4, 1.0f);
+        weights.set(1, 1, 7, 3.0f);
+        REQUIRE( weights.bones(1)[1] == 7 );
+        REQUIRE( weights.weights(0)[1] == 1.0f );
+
+        weights.normalize();
+        REQUIRE( weights.weight(1, 0) == 0.25f );
+        REQUIRE( weights.weight(1, 1) == 0.75f );
+        REQUIRE( weights.weight(0, 0) == 0.0f );
+    }
+}
@@ -0,0 +1,121 @@
+#include <sqg.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+using Catch::Matchers::WithinAbsMatcher;
+
+static_assert( sqg::concepts::vec3_type<sqg::soa_view<sqg::vec3_soa<float>>> );
+static_assert( sqg::concepts::read_vec3_type<sqg::read_soa_view<sqg::vec3_soa<float>>> );
+static_assert( !sqg::concepts::vec3_type<sqg::read_soa_view<sqg::vec3_soa<float>>> );
+static_assert( sqg::concepts::vec4_type<sqg::soa_view<sqg::vec4_soa<double>>> );
+static_assert( sqg::concepts::quat_type<sqg::soa_view<sqg::quat_soa<float>>> );
+static_assert( sqg::concepts::read_quat_type<sqg::read_soa_view<sqg::quat_soa<double>>> );
+static_assert( std::same_as<sqg::vec_value<sqg::soa_view<sqg::quat_soa<float>>>, sqg::quat<float>> );
+static_assert( std::random_access_iterator<sqg::vec3_soa<float>::iterator> );
+
+template<typename T>
+void test_soa( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+
+    std::vector<sqg::vec3<T>> aos(21);
+    sqg::vec3_soa<T> vectors;
+    for ( auto& v : aos )
+    {
+        v = sqg_test::random_vec3(distribution, generator);
+        vectors.push_back(v);
+    }
+    REQUIRE( vectors.size() == aos.size() );
+
+    SECTION("components")
+    {
+        for ( std::size_t i = 0; i < aos.size(); i++ )
+        {
+            REQUIRE( vectors.x()[i] == aos[i].x );
+            REQUIRE( vectors.y()[i] == aos[i].y );
+            REQUIRE( vectors.z()[i] == aos[i].z );
+            REQUIRE( sqg::vec3<T>(vectors[i]) == aos[i] );
+        }
+    }
+
+    SECTION("free functions")
+    {
+        const sqg::vec3_soa<T>& read = vectors;
+        for ( std::size_t i = 0; i + 1 < aos.size(); i++ )
+        {
+            REQUIRE( sqg::dot(read[i], vectors[i + 1]) == sqg::dot(aos[i], aos[i + 1]) );
+            REQUIRE( sqg::cross(vectors[i], read[i + 1]) == sqg::cross(aos[i], aos[i + 1]) );
+            REQUIRE( sqg::normalized(read[i]) == sqg::normalized(aos[i]) );
+        }
+    }
+
+    SECTION("write through")
+    {
+        auto element = vectors[3];
+        sqg::normalize(element);
+        REQUIRE( sqg::vec3<T>(vectors[3]) == sqg::normalized(aos[3]) );
+
+        vectors[4] = vectors[5];
+        REQUIRE( sqg::vec3<T>(vectors[4]) == aos[5] );
+
+        vectors[6] = sqg::vec3<T>{ T{1}, T{2}, T{3} };
+        REQUIRE( vectors.y()[6] == T{2} );
+    }
+
+    SECTION("iterators")
+    {
+        std::size_t i = 0;
+        for ( auto v : vectors )
+        {
+            v = v * T{2};
+            REQUIRE( sqg::vec3<T>(v) == aos[i] * T{2} );
+            i++;
+        }
+        REQUIRE( i == aos.size() );
+        REQUIRE( std::distance(vectors.begin(), vectors.end()) == static_cast<std::ptrdiff_t>(aos.size()) );
+        REQUIRE( sqg::vec3<T>(vectors.begin()[7]) == aos[7] * T{2} );
+    }
+
+    SECTION("wide")
+    {
+        const auto block = vectors.template load<8>(8);
+        for ( int j = 0; j < 8; j++ )
+            REQUIRE( block.x[j] == aos[8 + j].x );
+
+        vectors.template store<8>(0, sqg::normalized(block));
+        for ( std::size_t j = 0; j < 8; j++ )
+        {
+            const auto expected = sqg::normalized(aos[8 + j]);
+            REQUIRE_THAT( vectors.x()[j], WithinAbsMatcher( expected.x, 4 * std::numeric_limits<T>::epsilon() ) );
+            REQUIRE_THAT( vectors.y()[j], WithinAbsMatcher( expected.y, 4 * std::numeric_limits<T>::epsilon() ) );
+            REQUIRE_THAT( vectors.z()[j], WithinAbsMatcher( expected.z, 4 * std::numeric_limits<T>::epsilon() ) );
+        }
+    }
+
+    SECTION("quaternions")
+    {
+        sqg::quat_soa<T> rotations(aos.size());
+        REQUIRE( sqg::quat<T>(rotations[0]) == sqg::quat<T>{} );
+
+        for ( std::size_t i = 0; i < aos.size(); i++ )
+        {
+            auto rotation = rotations[i];
+            sqg::set_rot(rotation, sqg::normalized(aos[i]), distribution(generator));
+            const sqg::quat<T> q = rotations[i];
+            REQUIRE( rotations[i] * aos[i] == q * aos[i] );
+            REQUIRE( sqg::W(rotations[i]) == rotations.w()[i] );
+        }
+    }
+}
+
+TEST_CASE("soa")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("float") { test_soa<float>(generator); }
+    SECTION("double") { test_soa<double>(generator); }
+}
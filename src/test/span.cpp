@@ -0,0 +1,99 @@
+#include <sqg.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <span>
+
+using Catch::Matchers::WithinAbsMatcher;
+
+static_assert( sqg::concepts::vec3_type<sqg::span_vec<float,3>> );
+static_assert( sqg::concepts::read_vec3_type<sqg::span_vec<const float,3>> );
+static_assert( !sqg::concepts::vec3_type<sqg::span_vec<const float,3>> );
+static_assert( sqg::concepts::vec2_type<sqg::span_vec<double,2>> );
+static_assert( sqg::concepts::vec4_type<sqg::span_vec<float,4>> );
+
+#if defined(__cpp_lib_mdspan)
+static_assert( sqg::concepts::mat44_type<sqg::span_mat<float,4>> );
+static_assert( sqg::concepts::read_mat44_type<sqg::span_mat<const float,4>> );
+static_assert( !sqg::concepts::mat44_type<sqg::span_mat<const float,4>> );
+static_assert( sqg::concepts::mat33_type<sqg::span_mat<double,3,std::layout_left>> );
+static_assert( sqg::concepts::read_mat22_type<sqg::span_mat<const float,2,std::layout_stride>> );
+#endif
+
+template<typename T>
+void test_span( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+
+    // a packet of two vec3 and a 4x4 matrix
+    T buffer[22];
+    for ( T& s : buffer )
+        s = distribution(generator);
+
+    const sqg::vec3<T> a{ buffer[0], buffer[1], buffer[2] };
+    const sqg::vec3<T> b{ buffer[3], buffer[4], buffer[5] };
+
+    SECTION("vectors")
+    {
+        const sqg::span_vec va{ std::span<T,3>(buffer, 3) };
+        const sqg::span_vec<const T,3> vb{ std::span<const T,3>(buffer + 3, 3) };
+        REQUIRE( sqg::dot(va, vb) == sqg::dot(a, b) );
+        REQUIRE( sqg::vec3<T>(sqg::cross(va, vb)) == sqg::cross(a, b) );
+
+        auto write = va;
+        sqg::normalize(write);
+        REQUIRE( sqg::vec3<T>{ buffer[0], buffer[1], buffer[2] } == sqg::normalized(a) );
+
+        write = vb;
+        REQUIRE( buffer[2] == b.z );
+    }
+
+#if defined(__cpp_lib_mdspan)
+    sqg::mat44<T> m;
+    for ( int row = 0; row < 4; row++ )
+    {
+        for ( int col = 0; col < 4; col++ )
+            m.a[row][col] = buffer[6 + 4 * row + col];
+    }
+
+    SECTION("row major")
+    {
+        const sqg::span_mat<const T,4> view(buffer + 6);
+        REQUIRE( sqg::transform_point(view, a) == sqg::transform_point(m, a) );
+
+        sqg::mat44<T> copy;
+        sqg::assign(copy, view);
+        REQUIRE( copy == m );
+    }
+
+    SECTION("column major")
+    {
+        // the same memory read column major is the transpose
+        const sqg::span_mat<const T,4,std::layout_left> view(buffer + 6);
+        REQUIRE( sqg::A<1,2>(view) == m.a[2][1] );
+        REQUIRE( sqg::A<3,0>(view) == m.a[0][3] );
+    }
+
+    SECTION("strided")
+    {
+        // the top left 3x3 of the row major 4x4
+        using mapping = std::layout_stride::mapping<std::extents<std::size_t,3,3>>;
+        const sqg::span_mat<T,3,std::layout_stride> view(buffer + 6, mapping({}, std::array<std::size_t,2>{ 4, 1 }));
+        REQUIRE( sqg::determinant(view) == sqg::determinant(sqg::orientation(m)) );
+
+        auto write = view;
+        sqg::set_identity(write);
+        REQUIRE( buffer[6] == T{1} );
+        REQUIRE( buffer[7] == T{0} );
+        REQUIRE( buffer[9] == m.a[0][3] );
+    }
+#endif
+}
+
+TEST_CASE("span")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("float") { test_span<float>(generator); }
+    SECTION("double") { test_span<double>(generator); }
+}
@@ -0,0 +1,114 @@
+#include <sqg.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <vector>
+
+static_assert( sqg::concepts::vec3_type<sqg::strided_element<float,3>> );
+static_assert( sqg::concepts::read_vec3_type<sqg::strided_element<const float,3>> );
+static_assert( !sqg::concepts::vec3_type<sqg::strided_element<const float,3>> );
+static_assert( sqg::concepts::vec2_type<sqg::strided_element<double,2>> );
+static_assert( sqg::concepts::vec4_type<sqg::strided_element<float,4>> );
+static_assert( std::same_as<sqg::vec_value<sqg::strided_element<const float,2>>, sqg::vec2<float>> );
+static_assert( std::random_access_iterator<sqg::strided_vec_view<float,3>::iterator> );
+
+template<typename T>
+struct vertex
+{
+    sqg::vec3<T> position;
+    sqg::vec3<T> normal;
+    sqg::vec2<T> uv;
+    int material;
+};
+
+template<typename T>
+void test_strided( std::mt19937& generator )
+{
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+
+    std::vector<vertex<T>> vertices(13);
+    for ( auto& v : vertices )
+    {
+        v.position = sqg_test::random_vec3(distribution, generator);
+        v.normal = sqg_test::random_vec3(distribution, generator);
+        v.uv = { distribution(generator), distribution(generator) };
+        v.material = 7;
+    }
+    const std::vector<vertex<T>> original = vertices;
+
+    const sqg::strided_vec_view<T,3> positions(std::span{ vertices }, offsetof(vertex<T>, position));
+    const sqg::strided_vec_view<T,3> normals(vertices.data(), vertices.size(), sizeof(vertex<T>), offsetof(vertex<T>, normal));
+    const sqg::strided_vec_view<const T,2> uvs(std::span<const vertex<T>>{ vertices }, offsetof(vertex<T>, uv));
+    REQUIRE( positions.size() == vertices.size() );
+    REQUIRE( positions.stride() == sizeof(vertex<T>) );
+
+    SECTION("read")
+    {
+        for ( std::size_t i = 0; i < vertices.size(); i++ )
+        {
+            REQUIRE( sqg::vec3<T>(positions[i]) == vertices[i].position );
+            REQUIRE( sqg::dot(positions[i], normals[i]) == sqg::dot(vertices[i].position, vertices[i].normal) );
+            REQUIRE( sqg::vec2<T>(uvs[i]) == vertices[i].uv );
+        }
+    }
+
+    SECTION("write through")
+    {
+        for ( auto n : normals )
+            sqg::normalize(n);
+
+        positions[2] = positions[5];
+        positions[3] = sqg::vec3<T>{ T{1}, T{2}, T{3} };
+
+        for ( std::size_t i = 0; i < vertices.size(); i++ )
+        {
+            REQUIRE( vertices[i].normal == sqg::normalized(original[i].normal) );
+            REQUIRE( vertices[i].uv == original[i].uv );
+            REQUIRE( vertices[i].material == 7 );
+        }
+        REQUIRE( vertices[2].position == original[5].position );
+        REQUIRE( vertices[3].position == sqg::vec3<T>{ T{1}, T{2}, T{3} } );
+    }
+
+    SECTION("iterators")
+    {
+        REQUIRE( std::distance(positions.begin(), positions.end()) == static_cast<std::ptrdiff_t>(vertices.size()) );
+        REQUIRE( sqg::vec3<T>(positions.begin()[4]) == vertices[4].position );
+        REQUIRE( sqg::vec3<T>(*( positions.end() - 1 )) == vertices.back().position );
+
+        std::size_t i = 0;
+        for ( auto p : positions )
+        {
+            p = p * T{2};
+            i++;
+        }
+        REQUIRE( i == vertices.size() );
+        REQUIRE( vertices[6].position == original[6].position * T{2} );
+    }
+
+    SECTION("empty")
+    {
+        const sqg::strided_vec_view<T,3> none;
+        REQUIRE( none.empty() );
+        REQUIRE( none.begin() == none.end() );
+        REQUIRE( none.end() - none.begin() == 0 );
+        REQUIRE( std::ranges::distance(none) == 0 );
+
+        // a single element needs no stride
+        sqg::vec3<T> one = sqg_test::random_vec3(distribution, generator);
+        const sqg::strided_vec_view<T,3> single( &one, 1, 0 );
+        REQUIRE( single.end() - single.begin() == 1 );
+        REQUIRE( sqg::vec3<T>(*single.begin()) == one );
+    }
+}
+
+TEST_CASE("strided")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("float") { test_strided<float>(generator); }
+    SECTION("double") { test_strided<double>(generator); }
+}
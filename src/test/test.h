@@ -128,6 +128,27 @@ namespace sqg_test
         set_random_vector<decltype(distribution), T,n_dims>(distribution, generator, A);
     }
 
+    // A vec3 with each component drawn from distribution
+    template<std::floating_point T>
+    [[nodiscard]] inline sqg::vec3<T> random_vec3( std::uniform_real_distribution<T>& distribution, std::mt19937& generator )
+    {
+        const T x = distribution(generator);
+        const T y = distribution(generator);
+        const T z = distribution(generator);
+        return { x, y, z };
+    }
+
+    // Absolute tolerance for batch and SIMD results checked against the scalar functions,
+    // which may differ by fused multiply adds and summation order
+    template<std::floating_point T>
+    [[nodiscard]] inline constexpr T tolerance()
+    {
+        if constexpr ( std::same_as<T, float> )
+            return 1.0e-5f;
+        else
+            return 1.0e-12;
+    }
+
     template<typename T, typename M>
     [[nodiscard]] bool vec_equal( const T& sqg_vector, const M& test_vector )
     {
@@ -0,0 +1,97 @@
+#include <sqg.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using Catch::Matchers::WithinAbsMatcher;
+
+static_assert( sqg::trig::polynomial::sin(0.0f) == 0.0f );
+static_assert( sqg::trig::polynomial::cos(0.0) == 1.0 );
+static_assert( sqg::trig::polynomial::sincos(-3.0).sin < 0.0 );
+
+// error of a result against the exact value in ulp of that value
+template<typename T>
+long double ulp_error( T result, long double exact )
+{
+    const long double ulp = std::ldexp(1.0L, std::ilogb(static_cast<T>(exact)) - std::numeric_limits<T>::digits + 1);
+    return std::fabs(static_cast<long double>(result) - exact) / ulp;
+}
+
+template<typename T>
+void test_trig( std::mt19937& generator )
+{
+    SECTION("standard")
+    {
+        // the default backend must match the standard library exactly since rotations are compared exactly
+        std::uniform_real_distribution<T> distribution{ T{-10}, T{10} };
+        for ( int i = 0; i < 1000; i++ )
+        {
+            const T angle = distribution(generator);
+            const auto [s, c] = sqg::math::sincos(angle);
+            REQUIRE( s == std::sin(angle) );
+            REQUIRE( c == std::cos(angle) );
+        }
+    }
+
+    SECTION("polynomial within pi")
+    {
+        std::uniform_real_distribution<T> distribution{ -T{3.14159265358979}, T{3.14159265358979} };
+        for ( int i = 0; i < 10000; i++ )
+        {
+            const T angle = distribution(generator);
+            const auto [s, c] = sqg::trig::polynomial::sincos(angle);
+            CAPTURE(angle);
+            REQUIRE( ulp_error(s, std::sin(static_cast<long double>(angle))) <= 2.0L );
+            REQUIRE( ulp_error(c, std::cos(static_cast<long double>(angle))) <= 2.0L );
+        }
+    }
+
+    SECTION("polynomial large angles")
+    {
+        std::uniform_real_distribution<T> distribution{ T{-8000}, T{8000} };
+        const T tolerance = std::numeric_limits<T>::epsilon();
+        for ( int i = 0; i < 10000; i++ )
+        {
+            const T angle = distribution(generator);
+            const auto [s, c] = sqg::trig::polynomial::sincos(angle);
+            CAPTURE(angle);
+            REQUIRE_THAT( s, WithinAbsMatcher( static_cast<T>(std::sin(static_cast<long double>(angle))), tolerance ) );
+            REQUIRE_THAT( c, WithinAbsMatcher( static_cast<T>(std::cos(static_cast<long double>(angle))), tolerance ) );
+        }
+    }
+
+    SECTION("batch")
+    {
+        std::uniform_real_distribution<T> distribution{ T{-4}, T{4} };
+        std::vector<T> angles(41);
+        for ( T& angle : angles )
+            angle = distribution(generator);
+
+        std::vector<T> sines(angles.size());
+        std::vector<T> cosines(angles.size());
+        sqg::math::sincos(std::span<const T>{ angles }, std::span<T>{ sines }, std::span<T>{ cosines });
+        for ( std::size_t i = 0; i < angles.size(); i++ )
+        {
+            REQUIRE( sines[i] == std::sin(angles[i]) );
+            REQUIRE( cosines[i] == std::cos(angles[i]) );
+        }
+
+        sqg::math::sincos<sqg::trig::polynomial>(std::span<const T>{ angles }, std::span<T>{ sines }, std::span<T>{ cosines });
+        for ( std::size_t i = 0; i < angles.size(); i++ )
+        {
+            REQUIRE( sines[i] == sqg::trig::polynomial::sin(angles[i]) );
+            REQUIRE( cosines[i] == sqg::trig::polynomial::cos(angles[i]) );
+        }
+    }
+}
+
+TEST_CASE("trig")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("float") { test_trig<float>(generator); }
+    SECTION("double") { test_trig<double>(generator); }
+}
@@ -0,0 +1,153 @@
+#include <sqg.h>
+#include "test.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_get_random_seed.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+using Catch::Matchers::WithinAbsMatcher;
+
+static_assert( sqg::concepts::real_scalar<float> );
+static_assert( sqg::concepts::real_scalar<sqg::wide8f> );
+static_assert( ! sqg::concepts::real_scalar<int> );
+static_assert( sqg::concepts::vec3_type<sqg::vec3<sqg::wide8f>> );
+static_assert( sqg::concepts::quat_type<sqg::quat<sqg::wide4d>> );
+static_assert( sqg::concepts::mat33_type<sqg::mat33<sqg::wide16f>> );
+static_assert( alignof(sqg::wide8f) == 16 );
+static_assert( ( sqg::wide4f{ 2.0f } * sqg::wide4f{ 3.0f } )[3] == 6.0f );
+
+template<typename T>
+T wide_tolerance();
+
+template<> float wide_tolerance<float>() { return 1.0e-4f; }
+template<> double wide_tolerance<double>() { return 1.0e-12; }
+
+// each lane of a wide result must match the scalar algorithm run on that lane alone
+template<typename T, int N>
+void require_lane( const sqg::wide<T,N>& a, int lane, T expected )
+{
+    CAPTURE(lane);
+    REQUIRE_THAT( a[lane], WithinAbsMatcher( expected, wide_tolerance<T>() ) );
+}
+
+template<typename T, int N>
+void require_lanes( const sqg::vec3<sqg::wide<T,N>>& a, int lane, const sqg::vec3<T>& expected )
+{
+    require_lane(a.x, lane, expected.x);
+    require_lane(a.y, lane, expected.y);
+    require_lane(a.z, lane, expected.z);
+}
+
+template<typename T, int N>
+void require_lanes( const sqg::quat<sqg::wide<T,N>>& a, int lane, const sqg::quat<T>& expected )
+{
+    require_lane(a.w, lane, expected.w);
+    require_lane(a.x, lane, expected.x);
+    require_lane(a.y, lane, expected.y);
+    require_lane(a.z, lane, expected.z);
+}
+
+template<typename T, int N>
+void require_lanes( const sqg::mat33<sqg::wide<T,N>>& a, int lane, const sqg::mat33<T>& expected )
+{
+    for ( int row = 0; row < 3; row++ )
+    {
+        for ( int col = 0; col < 3; col++ )
+        {
+            CAPTURE(row, col);
+            require_lane(a.a[row][col], lane, expected.a[row][col]);
+        }
+    }
+}
+
+template<typename T, int N>
+void test_wide( std::mt19937& generator )
+{
+    using wide = sqg::wide<T,N>;
+    std::uniform_real_distribution<T> distribution{ T{-2}, T{2} };
+
+    sqg::vec3<T> a[N];
+    sqg::vec3<T> b[N];
+    T angle[N][3];
+
+    sqg::vec3<wide> wa;
+    sqg::vec3<wide> wb;
+    wide wangle[3];
+
+    for ( int lane = 0; lane < N; lane++ )
+    {
+        a[lane] = { distribution(generator), distribution(generator), distribution(generator) };
+        b[lane] = { distribution(generator), distribution(generator), distribution(generator) };
+        wa.x[lane] = a[lane].x; wa.y[lane] = a[lane].y; wa.z[lane] = a[lane].z;
+        wb.x[lane] = b[lane].x; wb.y[lane] = b[lane].y; wb.z[lane] = b[lane].z;
+
+        for ( int i = 0; i < 3; i++ )
+        {
+            angle[lane][i] = distribution(generator);
+            wangle[i][lane] = angle[lane][i];
+        }
+    }
+
+    SECTION("vector")
+    {
+        const sqg::vec3<wide> c = sqg::cross(wa, wb);
+        const sqg::vec3<wide> n = sqg::normalized(wa);
+        const wide d = sqg::dot(wa, wb);
+        const wide m = sqg::mag(wb);
+        for ( int lane = 0; lane < N; lane++ )
+        {
+            require_lanes(c, lane, sqg::cross(a[lane], b[lane]));
+            require_lanes(n, lane, sqg::normalized(a[lane]));
+            require_lane(d, lane, sqg::dot(a[lane], b[lane]));
+            require_lane(m, lane, sqg::mag(b[lane]));
+        }
+    }
+
+    SECTION("quaternion")
+    {
+        sqg::quat<wide> q;
+        sqg::set_rot(q, sqg::normalized(wa), wangle[0]);
+        sqg::quat<wide> qx;
+        sqg::set_rotx(qx, wangle[1]);
+
+        const sqg::vec3<wide> rotated = ( qx * q ) * wb;
+        for ( int lane = 0; lane < N; lane++ )
+        {
+            sqg::quat<T> expected;
+            sqg::set_rot(expected, sqg::normalized(a[lane]), angle[lane][0]);
+            require_lanes(q, lane, expected);
+            require_lanes(rotated, lane, ( sqg::rotx_quat(angle[lane][1]) * expected ) * b[lane]);
+        }
+    }
+
+    SECTION("matrix")
+    {
+        sqg::mat33<wide> r;
+        sqg::set_rot(r, sqg::normalized(wa), wangle[0]);
+        sqg::mat33<wide> euler;
+        sqg::set_rotzyx(euler, wangle[0], wangle[1], wangle[2]);
+        sqg::mat33<wide> proper;
+        sqg::set_rotxzx(proper, wangle[0], wangle[1], wangle[2]);
+        for ( int lane = 0; lane < N; lane++ )
+        {
+            sqg::mat33<T> expected;
+            sqg::set_rot(expected, sqg::normalized(a[lane]), angle[lane][0]);
+            require_lanes(r, lane, expected);
+
+            sqg::set_rotzyx(expected, angle[lane][0], angle[lane][1], angle[lane][2]);
+            require_lanes(euler, lane, expected);
+
+            sqg::set_rotxzx(expected, angle[lane][0], angle[lane][1], angle[lane][2]);
+            require_lanes(proper, lane, expected);
+        }
+    }
+}
+
+TEST_CASE("wide scalar")
+{
+    std::mt19937 generator(Catch::getSeed());
+    SECTION("float 4") { test_wide<float, 4>(generator); }
+    SECTION("float 8") { test_wide<float, 8>(generator); }
+    SECTION("float 16") { test_wide<float, 16>(generator); }
+    SECTION("double 4") { test_wide<double, 4>(generator); }
+    SECTION("double 3") { test_wide<double, 3>(generator); }
+}